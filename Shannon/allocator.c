@@ -0,0 +1,247 @@
+#include "utilities.h"
+#include "allocator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/// HEADER OF THE BLOCKS OF THE TRACKING ALLOCATOR, KEEPS THE USER MEMORY ALIGNED
+union tracked_header
+{
+    struct
+    {
+        size_t size;
+        int stage;
+    } info;
+    max_align_t alignment;
+};
+
+static void * default_allocate(void * state, size_t size)
+{
+    (void)state;
+    return malloc(size);
+}
+
+static void * default_reallocate(void * state, void * memory, size_t size)
+{
+    (void)state;
+    return realloc(memory, size);
+}
+
+static void default_release(void * state, void * memory)
+{
+    (void)state;
+    free(memory);
+}
+
+static struct allocator installed_allocator = { default_allocate, default_reallocate, default_release, NULL };
+
+static _Thread_local int memory_stage = MEMORY_STAGE_OTHER;
+
+int set_allocator(const struct allocator * allocator)
+{
+    if (allocator == NULL)
+    {
+        installed_allocator.allocate = default_allocate;
+        installed_allocator.reallocate = default_reallocate;
+        installed_allocator.release = default_release;
+        installed_allocator.state = NULL;
+        return STATUS_SUCCESS;
+    }
+
+    if (allocator->allocate == NULL || allocator->reallocate == NULL || allocator->release == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    installed_allocator = *allocator;
+    return STATUS_SUCCESS;
+}
+
+void * memory_alloc(size_t size)
+{
+    return installed_allocator.allocate(installed_allocator.state, size);
+}
+
+void * memory_calloc(size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size)
+    {
+        return NULL;
+    }
+
+    void * memory = installed_allocator.allocate(installed_allocator.state, count * size);
+
+    if (memory != NULL)
+    {
+        memset(memory, 0, count * size);
+    }
+
+    return memory;
+}
+
+void * memory_realloc(void * memory, size_t size)
+{
+    return installed_allocator.reallocate(installed_allocator.state, memory, size);
+}
+
+void memory_free(void * memory)
+{
+    if (memory != NULL)
+    {
+        installed_allocator.release(installed_allocator.state, memory);
+    }
+}
+
+int set_memory_stage(const int stage)
+{
+    int previous = memory_stage;
+    memory_stage = stage < 0 || stage >= MEMORY_STAGE_COUNT ? MEMORY_STAGE_OTHER : stage;
+    return previous;
+}
+
+static void track_allocation(struct memory_usage * usage, const size_t size)
+{
+    usage->current += size;
+    ++usage->allocations;
+
+    if (usage->current > usage->peak)
+    {
+        usage->peak = usage->current;
+    }
+}
+
+static void track_release(struct memory_usage * usage, const size_t size)
+{
+    usage->current -= size;
+    ++usage->releases;
+}
+
+static void * tracking_allocate(void * state, size_t size)
+{
+    struct memory_tracker * tracker = (struct memory_tracker *)state;
+
+    if (size > SIZE_MAX - sizeof(union tracked_header))
+    {
+        return NULL;
+    }
+
+    union tracked_header * header = (union tracked_header *)malloc(sizeof(union tracked_header) + size);
+
+    if (header == NULL)
+    {
+        return NULL;
+    }
+
+    header->info.size = size;
+    header->info.stage = memory_stage;
+
+    pthread_mutex_lock(&tracker->lock);
+    track_allocation(&tracker->total, size);
+    track_allocation(tracker->stages + header->info.stage, size);
+    pthread_mutex_unlock(&tracker->lock);
+
+    return header + 1;
+}
+
+static void tracking_release(void * state, void * memory)
+{
+    struct memory_tracker * tracker = (struct memory_tracker *)state;
+    union tracked_header * header = (union tracked_header *)memory - 1;
+
+    pthread_mutex_lock(&tracker->lock);
+    track_release(&tracker->total, header->info.size);
+    track_release(tracker->stages + header->info.stage, header->info.size);
+    pthread_mutex_unlock(&tracker->lock);
+
+    free(header);
+}
+
+static void * tracking_reallocate(void * state, void * memory, size_t size)
+{
+    struct memory_tracker * tracker = (struct memory_tracker *)state;
+
+    if (memory == NULL)
+    {
+        return tracking_allocate(state, size);
+    }
+
+    if (size > SIZE_MAX - sizeof(union tracked_header))
+    {
+        return NULL;
+    }
+
+    union tracked_header * header = (union tracked_header *)memory - 1;
+    size_t old_size = header->info.size;
+    int old_stage = header->info.stage;
+
+    if ((header = (union tracked_header *)realloc(header, sizeof(union tracked_header) + size)) == NULL)
+    {
+        return NULL;
+    }
+
+    /// THE GROWN BLOCK IS CHARGED TO THE STAGE THAT GREW IT
+    header->info.size = size;
+    header->info.stage = memory_stage;
+
+    pthread_mutex_lock(&tracker->lock);
+    track_release(&tracker->total, old_size);
+    track_release(tracker->stages + old_stage, old_size);
+    track_allocation(&tracker->total, size);
+    track_allocation(tracker->stages + header->info.stage, size);
+    pthread_mutex_unlock(&tracker->lock);
+
+    return header + 1;
+}
+
+int create_tracking_allocator(struct allocator * allocator, struct memory_tracker * tracker)
+{
+    if (allocator == NULL || tracker == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memset(&tracker->total, 0, sizeof(struct memory_usage));
+    memset(tracker->stages, 0, sizeof(tracker->stages));
+    pthread_mutex_init(&tracker->lock, NULL);
+
+    allocator->allocate = tracking_allocate;
+    allocator->reallocate = tracking_reallocate;
+    allocator->release = tracking_release;
+    allocator->state = tracker;
+
+    return STATUS_SUCCESS;
+}
+
+int print_memory_tracker(FILE * stream, struct memory_tracker * tracker)
+{
+    if (stream == NULL || tracker == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    pthread_mutex_lock(&tracker->lock);
+
+    fprintf(stream, "%-16s %14s %14s %12s %12s\n", "stage", "current", "peak", "allocations", "releases");
+
+    for (unsigned int stage = 0; stage <= MEMORY_STAGE_COUNT; ++stage)
+    {
+        const struct memory_usage * usage = stage == MEMORY_STAGE_COUNT ? &tracker->total : tracker->stages + stage;
+        const char * name = stage == MEMORY_STAGE_COUNT ? "total" : stage == MEMORY_STAGE_OTHER ? "other" : stats_stage_names[stage];
+
+        fprintf(stream, "%-16s %14llu %14llu %12llu %12llu\n", name, usage->current, usage->peak, usage->allocations, usage->releases);
+    }
+
+    pthread_mutex_unlock(&tracker->lock);
+    return STATUS_SUCCESS;
+}
+
+int clean_memory_tracker(struct memory_tracker * tracker)
+{
+    if (tracker == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    pthread_mutex_destroy(&tracker->lock);
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#ifndef _ALLOCATOR_H_
+#define _ALLOCATOR_H_
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "stats.h"
+
+/// STAGE OF THE ALLOCATIONS MADE OUTSIDE OF THE STAGES OF stats.h
+#define MEMORY_STAGE_OTHER STATS_STAGE_COUNT
+#define MEMORY_STAGE_COUNT (STATS_STAGE_COUNT + 1)
+
+struct allocator
+{
+    /// SAME CONTRACT AS malloc / realloc / free, state IS PASSED BACK UNTOUCHED
+    void * (*allocate)(void * state, size_t size);
+    void * (*reallocate)(void * state, void * memory, size_t size);
+    void (*release)(void * state, void * memory);
+    void * state;
+};
+
+struct memory_usage
+{
+    /// BYTES STILL ALLOCATED AND THE HIGHEST VALUE THEY REACHED
+    unsigned long long current;
+    unsigned long long peak;
+
+    /// CALLS OF allocate / reallocate AND OF release
+    unsigned long long allocations;
+    unsigned long long releases;
+};
+
+struct memory_tracker
+{
+    /// WHOLE PROCESS, THEN EVERY STAGE (A BLOCK STAYS IN THE STAGE THAT ALLOCATED IT)
+    struct memory_usage total;
+    struct memory_usage stages[MEMORY_STAGE_COUNT];
+
+    pthread_mutex_t lock;
+};
+
+/**
+*   Every allocation of the library goes through the installed allocator. It
+*   has to be installed before the first allocation and kept until the memory
+*   it gave is released.
+*
+*   @PARAMS
+*   allocator - Allocator to install, NULL installs malloc / realloc / free
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the functions of allocator is NULL
+*   STATUS_SUCCESS - Allocator was installed
+*/
+int set_allocator(const struct allocator * allocator);
+
+void * memory_alloc(size_t size);
+
+/**
+*   @RETURN
+*    NULL - count * size overflows or memory could not be allocated
+*   !NULL - count * size zeroed bytes
+*/
+void * memory_calloc(size_t count, size_t size);
+
+void * memory_realloc(void * memory, size_t size);
+
+void memory_free(void * memory);
+
+/**
+*   Sets the stage the allocations of this thread are charged to.
+*
+*   @PARAMS
+*   stage - One of enum stats_stage or MEMORY_STAGE_OTHER
+*
+*   @RETURN
+*   The stage set before
+*/
+int set_memory_stage(const int stage);
+
+/**
+*   Fills allocator with the tracking allocator, which counts the bytes of
+*   every stage in tracker and gets the memory from malloc.
+*
+*   @PARAMS
+*   allocator - Receives the functions of the tracking allocator
+*   tracker   - Counters of the allocator, must outlive it
+*
+*   @RETURN
+*   NULL_ARGUMENT  - allocator or tracker is NULL
+*   STATUS_SUCCESS - Allocator can be installed with set_allocator
+*/
+int create_tracking_allocator(struct allocator * allocator, struct memory_tracker * tracker);
+
+/**
+*   @PARAMS
+*   stream  - Output stream
+*   tracker - Counters of a tracking allocator
+*
+*   @RETURN
+*   NULL_ARGUMENT  - stream or tracker is NULL
+*   STATUS_SUCCESS - Current / peak bytes and counts of every stage were printed
+*/
+int print_memory_tracker(FILE * stream, struct memory_tracker * tracker);
+
+int clean_memory_tracker(struct memory_tracker * tracker);
+
+#endif // _ALLOCATOR_H_
@@ -1,9 +1,11 @@
 #include "utilities.h"
+#include "allocator.h"
 #include "avl_tree.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include "heap.h"
+#include "stats.h"
 
 struct node * const find_by_value(const struct avl_tree * const tree, const void * const element, const unsigned int length, int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
 {
@@ -20,6 +22,7 @@ struct node * const find_element(struct node * const node, const void * const el
     if (node != NULL && element != NULL)
     {
         int cmp = compare(element, length, node->info.sequence, node->info.length);
+        STATS_ADD(avl_compares, 1);
 
         if (cmp == 0)
         {
@@ -62,6 +65,7 @@ int update_tree(struct node * node)
 void rotate_right_to_left(struct node ** node)
 {
         struct node * auxiliary = (*node)->right_child;
+        STATS_ADD(avl_rotations, 1);
         (*node)->right_child = auxiliary->left_child;
 
         auxiliary->left_child = *node;
@@ -75,6 +79,7 @@ void rotate_right_to_left(struct node ** node)
 void rotate_left_to_right(struct node ** node)
 {
         struct node * auxiliary = (*node)->left_child;
+        STATS_ADD(avl_rotations, 1);
         (*node)->left_child = auxiliary->right_child;
 
         auxiliary->right_child = *node;
@@ -94,7 +99,7 @@ int add_node(struct node ** node, const void * const element, const unsigned int
 
     if (*node == NULL)
     {
-        *node = (struct node *)malloc(sizeof(struct node));
+        *node = (struct node *)memory_alloc(sizeof(struct node));
 
         if (*node == NULL)
         {
@@ -111,12 +116,13 @@ int add_node(struct node ** node, const void * const element, const unsigned int
 
         /// COPY DATA
         (*node)->info.length = length;
-        (*node)->info.sequence = (void *)malloc(length);
+        (*node)->info.sequence = (void *)memory_alloc(length);
         (*node)->info.sequence = (void *)memcpy((*node)->info.sequence, element, length);
     }
     else
     {
         int cmp = compare(element, length, (*node)->info.sequence, (*node)->info.length);
+        STATS_ADD(avl_compares, 1);
 
         if (cmp == 0)
         {
@@ -102,6 +102,24 @@ int clean_tree(struct avl_tree* tree);
 */
 int clean_nodes(struct node ** node);
 
+/**
+*   In-order traversal (left, node, right).
+*
+*   @PARAMS
+*   node     - Memory address of the node/root
+*   executer - Pointer to function called for every node
+*/
+void srd(const struct node * const node, void (*executer)(const struct node * const));
+
+/**
+*   Preorder traversal (node, left, right).
+*
+*   @PARAMS
+*   node     - Memory address of the node/root
+*   executer - Pointer to function called for every node
+*/
+void rsd(const struct node * const node, void (*executer)(const struct node * const));
+
 /**
 *   @PARAMS
 *   node    - Memory address of the node/root
@@ -0,0 +1,479 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "utilities.h"
+#include "container.h"
+#include "shannon.h"
+#include "huffman.h"
+#include "context.h"
+#include "heap.h"
+#include "allocator.h"
+#include "kernels.h"
+
+#define BENCH_SEED        0x9E3779B97F4A7C15ULL
+#define BENCH_REPETITIONS 3
+#define BENCH_MAX_SIZES   16
+
+enum bench_stage
+{
+    STAGE_HISTOGRAM = 0,
+    STAGE_TREE      = 1,
+    STAGE_CODES     = 2,
+    STAGE_ENCODE    = 3,
+    STAGE_DECODE    = 4,
+    STAGE_COUNT     = 5
+};
+
+static const char * stage_names[STAGE_COUNT] = { "histogram", "tree", "code_table", "encode", "decode" };
+
+/// TRAINING TEXT OF THE ORDER-2 MARKOV GENERATOR
+static const char * markov_seed =
+    "the old man sat by the river every morning and watched the boats go down to the sea "
+    "he had worked on those boats when he was young and he still knew every one of them by the sound "
+    "of its engine the children of the village came to listen to his stories about storms and islands "
+    "and about the long nights when the lights of the harbour were the only thing that kept them going "
+    "some of the stories were true and some of them were not but nobody in the village cared about that "
+    "because the way he told them made the river and the sea feel closer than they really were "
+    "when the winter came he stayed in his small house near the bridge and wrote letters to his friends "
+    "who had left the village a long time ago most of them never wrote back but he kept writing anyway ";
+
+struct corpus
+{
+    const char * name;
+    void (*generate)(unsigned char * data, const unsigned int length);
+};
+
+static unsigned long long random_state;
+
+static unsigned long long next_random(void)
+{
+    /// SPLITMIX64, THE CORPORA ONLY DEPEND ON BENCH_SEED
+    unsigned long long value = (random_state += 0x9E3779B97F4A7C15ULL);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+static double next_uniform(void)
+{
+    return (next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void generate_uniform(unsigned char * data, const unsigned int length)
+{
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        data[i] = (unsigned char)next_random();
+    }
+}
+
+static void generate_zipf(unsigned char * data, const unsigned int length)
+{
+    double cumulative[256];
+    unsigned char symbols[256];
+    double sum = 0.0;
+
+    /// P(RANK k) ~ 1 / (k + 1) ^ 1.1, THE RANKS ARE MAPPED TO SHUFFLED BYTE VALUES
+    for (unsigned int k = 0; k < 256; ++k)
+    {
+        sum += 1.0 / pow(k + 1.0, 1.1);
+        cumulative[k] = sum;
+        symbols[k] = (unsigned char)k;
+    }
+
+    for (unsigned int k = 255; k > 0; --k)
+    {
+        unsigned int other = (unsigned int)(next_random() % (k + 1));
+        unsigned char swap = symbols[k];
+        symbols[k] = symbols[other];
+        symbols[other] = swap;
+    }
+
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        double target = next_uniform() * sum;
+        unsigned int low = 0, high = 255;
+
+        while (low < high)
+        {
+            unsigned int middle = (low + high) / 2;
+
+            if (cumulative[middle] < target)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        data[i] = symbols[low];
+    }
+}
+
+static void generate_markov(unsigned char * data, const unsigned int length)
+{
+    const unsigned char * seed = (const unsigned char *)markov_seed;
+    const unsigned int seed_length = (unsigned int)strlen(markov_seed);
+    unsigned int * offsets = (unsigned int *)calloc(65536 + 1, sizeof(unsigned int));
+    unsigned char * followers = (unsigned char *)malloc(seed_length);
+
+    if (offsets == NULL || followers == NULL)
+    {
+        free(offsets);
+        free(followers);
+        generate_uniform(data, length);
+        return;
+    }
+
+    /// FOR EVERY PAIR OF BYTES, THE LIST OF BYTES THAT FOLLOW IT IN THE SEED
+    for (unsigned int i = 2; i < seed_length; ++i)
+    {
+        ++offsets[(seed[i - 2] << 8 | seed[i - 1]) + 1];
+    }
+
+    for (unsigned int pair = 0; pair < 65536; ++pair)
+    {
+        offsets[pair + 1] += offsets[pair];
+    }
+
+    {
+        unsigned int * filled = (unsigned int *)calloc(65536, sizeof(unsigned int));
+
+        for (unsigned int i = 2; i < seed_length && filled != NULL; ++i)
+        {
+            unsigned int pair = seed[i - 2] << 8 | seed[i - 1];
+            followers[offsets[pair] + filled[pair]++] = seed[i];
+        }
+
+        free(filled);
+    }
+
+    unsigned int previous = seed[0] << 8 | seed[1];
+
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        unsigned int count = offsets[previous + 1] - offsets[previous];
+
+        if (count == 0)
+        {
+            /// END OF THE SEED: RESTART FROM A RANDOM PLACE
+            unsigned int start = (unsigned int)(next_random() % (seed_length - 2));
+            previous = seed[start] << 8 | seed[start + 1];
+            count = offsets[previous + 1] - offsets[previous];
+        }
+
+        data[i] = followers[offsets[previous] + next_random() % count];
+        previous = (previous << 8 | data[i]) & 0xFFFF;
+    }
+
+    free(offsets);
+    free(followers);
+}
+
+static void generate_runs(unsigned char * data, const unsigned int length)
+{
+    static const unsigned char alphabet[4] = { 'A', 'C', 'G', 'T' };
+
+    /// FEW SYMBOLS IN LONG RUNS (MEAN LENGTH ~ 64)
+    for (unsigned int i = 0; i < length;)
+    {
+        unsigned char symbol = alphabet[next_random() % 4];
+        unsigned int run = 1 + (unsigned int)(-64.0 * log(1.0 - next_uniform()));
+
+        for (; run != 0 && i < length; --run)
+        {
+            data[i++] = symbol;
+        }
+    }
+}
+
+static void generate_records(unsigned char * data, const unsigned int length)
+{
+    /// 32 BYTE TELEMETRY RECORDS: SEQUENCE, TIMESTAMP, SENSOR, FLAGS, READING, ZERO PADDING
+    unsigned int timestamp = 1600000000;
+    unsigned char record[32];
+
+    for (unsigned int i = 0, sequence = 0; i < length; ++sequence)
+    {
+        memset(record, 0, sizeof(record));
+        timestamp += 1 + (unsigned int)(next_random() % 3);
+
+        store_u32(record, sequence);
+        store_u32(record + 4, timestamp);
+        record[8] = (unsigned char)(next_random() % 16);
+        record[10] = next_uniform() < 0.95 ? 0 : (unsigned char)(1 << (next_random() % 8));
+        store_u32(record + 12, 20000 + (unsigned int)(next_random() % 512));
+
+        for (unsigned int byte = 0; byte < sizeof(record) && i < length; ++byte)
+        {
+            data[i++] = record[byte];
+        }
+    }
+}
+
+static const struct corpus corpora[] =
+{
+    { "uniform", generate_uniform },
+    { "zipf", generate_zipf },
+    { "markov_text", generate_markov },
+    { "low_entropy_runs", generate_runs },
+    { "binary_records", generate_records }
+};
+
+/// FNV-1a OF THE ENCODED PAYLOAD, EQUAL FOR EVERY CPU VARIANT
+static unsigned long long payload_digest(const unsigned char * data, const unsigned int length)
+{
+    unsigned long long digest = 0xCBF29CE484222325ULL;
+
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        digest = (digest ^ data[i]) * 0x100000001B3ULL;
+    }
+
+    return digest;
+}
+
+static int run_once(struct coding_context * context, const unsigned char * data, const unsigned int length, double * seconds, unsigned int * compressed_size, unsigned long long * digest, bool * verified)
+{
+    int result;
+    double start, stop;
+    struct hash_table * table;
+    struct node * root;
+    struct hash_table * codes;
+    void * encoded;
+    unsigned int encoded_length;
+    void * decoded;
+    unsigned int decoded_length;
+    void * tree;
+    unsigned int tree_length;
+
+    start = monotonic_seconds();
+    table = frequency_hash_table(data, length, 1, context->table_size, &parse_sequences);
+    stop = monotonic_seconds();
+    seconds[STAGE_HISTOGRAM] = stop - start;
+
+    if (table == NULL)
+    {
+        return NULL_RESULT;
+    }
+
+    start = monotonic_seconds();
+    root = table_huffman_tree(table, WEAK_COLLECTION);
+    stop = monotonic_seconds();
+    seconds[STAGE_TREE] = stop - start;
+
+    clean_table(table);
+    memory_free(table);
+
+    start = monotonic_seconds();
+    codes = huffman_code_table(root, context->table_size, &huffman_hash);
+    stop = monotonic_seconds();
+    seconds[STAGE_CODES] = stop - start;
+
+    if (codes == NULL)
+    {
+        clean_nodes(&root);
+        return NULL_RESULT;
+    }
+
+    start = monotonic_seconds();
+    result = huffman_encode_table(context, codes, data, length, &encoded, &encoded_length);
+    stop = monotonic_seconds();
+    seconds[STAGE_ENCODE] = stop - start;
+
+    if (result == STATUS_SUCCESS)
+    {
+        start = monotonic_seconds();
+        result = huffman_decrypt_data(context, encoded, encoded_length, &decoded, &decoded_length, root, length);
+        stop = monotonic_seconds();
+        seconds[STAGE_DECODE] = stop - start;
+
+        if (result == STATUS_SUCCESS)
+        {
+            *verified = decoded_length == length && memcmp(decoded, data, decoded_length) == 0;
+            memory_free(decoded);
+        }
+
+        *digest = payload_digest((const unsigned char *)encoded, encoded_length);
+
+        if (serialize_huffman_tree(root, &tree, &tree_length) == STATUS_SUCCESS)
+        {
+            *compressed_size = CONTAINER_HEADER_SIZE + tree_length + encoded_length;
+            memory_free(tree);
+        }
+
+        memory_free(encoded);
+    }
+
+    clean_huffman_table(codes);
+    memory_free(codes);
+    clean_nodes(&root);
+    return result;
+}
+
+static void print_result(FILE * output, const char * corpus, const unsigned int size, const double * seconds, const unsigned int compressed_size, const unsigned long long digest, const bool verified, const bool last)
+{
+    fprintf(output, "    {\"corpus\": \"%s\", \"size\": %u, \"cpu_variant\": \"%s\", \"compressed_size\": %u, \"ratio\": %.6f, \"digest\": \"%016llx\", \"verified\": %s,\n",
+            corpus, size, cpu_variant_name(cpu_kernels()->variant), compressed_size, size == 0 ? 0.0 : (double)compressed_size / size, digest, verified ? "true" : "false");
+    fprintf(output, "     \"stages\": {");
+
+    double total = 0.0;
+    for (unsigned int stage = 0; stage < STAGE_COUNT; ++stage)
+    {
+        total += seconds[stage];
+        fprintf(output, "%s\n       \"%s\": {\"seconds\": %.9f, \"mb_per_s\": %.3f, \"ns_per_symbol\": %.3f}",
+                stage == 0 ? "" : ",", stage_names[stage], seconds[stage],
+                seconds[stage] > 0 ? size / seconds[stage] / 1e6 : 0.0, size == 0 ? 0.0 : seconds[stage] * 1e9 / size);
+    }
+
+    fprintf(output, ",\n       \"total\": {\"seconds\": %.9f, \"mb_per_s\": %.3f, \"ns_per_symbol\": %.3f}}}%s\n",
+            total, total > 0 ? size / total / 1e6 : 0.0, size == 0 ? 0.0 : total * 1e9 / size, last ? "" : ",");
+}
+
+int main(int argc, char ** argv)
+{
+    unsigned int sizes[BENCH_MAX_SIZES] = { 64 << 10, 1 << 20, 4 << 20 };
+    unsigned int size_count = 3;
+    unsigned int repetitions = BENCH_REPETITIONS;
+    bool custom_sizes = false;
+    enum cpu_variant variants[CPU_VARIANT_COUNT] = { cpu_kernels()->variant };
+    unsigned int variant_count = 1;
+    FILE * output = stdout;
+    int status = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            if (!custom_sizes)
+            {
+                custom_sizes = true;
+                size_count = 0;
+            }
+
+            if (size_count < BENCH_MAX_SIZES)
+            {
+                sizes[size_count++] = (unsigned int)strtoul(argv[++i], NULL, 10) << 10;
+            }
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            repetitions = (unsigned int)strtoul(argv[++i], NULL, 10);
+            repetitions = repetitions == 0 ? 1 : repetitions;
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            /// EVERY VARIANT THE CPU SUPPORTS, OR ONLY THE NAMED ONE
+            if (strcmp(argv[++i], "all") == 0)
+            {
+                for (variant_count = 0; variant_count <= (unsigned int)detect_cpu_variant(); ++variant_count)
+                {
+                    variants[variant_count] = (enum cpu_variant)variant_count;
+                }
+            }
+            else if ((variants[0] = parse_cpu_variant(argv[i])) == CPU_VARIANT_COUNT || variants[0] > detect_cpu_variant())
+            {
+                fprintf(stderr, "Unknown or unsupported CPU variant: %s\n", argv[i]);
+                return 1;
+            }
+            else
+            {
+                variant_count = 1;
+            }
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            if ((output = fopen(argv[++i], "w")) == NULL)
+            {
+                perror("Could not open the output file");
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-s KiB]... [-r repetitions] [-c variant|all] [-o output.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct coding_context context;
+    create_context(&context);
+
+    fprintf(output, "{\n  \"benchmark\": \"huffman_pipeline\",\n  \"seed\": %llu,\n  \"repetitions\": %u,\n  \"results\": [\n", BENCH_SEED, repetitions);
+
+    const unsigned int corpus_count = sizeof(corpora) / sizeof(corpora[0]);
+
+    for (unsigned int c = 0; c < corpus_count; ++c)
+    {
+        for (unsigned int s = 0; s < size_count; ++s)
+        {
+            unsigned char * data = (unsigned char *)malloc(sizes[s] == 0 ? 1 : sizes[s]);
+
+            if (data == NULL)
+            {
+                status = 1;
+                continue;
+            }
+
+            random_state = BENCH_SEED + c;
+            corpora[c].generate(data, sizes[s]);
+
+            unsigned long long first_digest = 0;
+
+            for (unsigned int v = 0; v < variant_count; ++v)
+            {
+                double best[STAGE_COUNT];
+                unsigned int compressed_size = 0;
+                unsigned long long digest = 0;
+                bool verified = false;
+
+                force_cpu_variant(variants[v]);
+
+                for (unsigned int r = 0; r < repetitions; ++r)
+                {
+                    double seconds[STAGE_COUNT] = { 0 };
+
+                    if (run_once(&context, data, sizes[s], seconds, &compressed_size, &digest, &verified) != STATUS_SUCCESS)
+                    {
+                        status = 1;
+                    }
+
+                    /// KEEP THE FASTEST REPETITION OF EVERY STAGE
+                    for (unsigned int stage = 0; stage < STAGE_COUNT; ++stage)
+                    {
+                        best[stage] = r == 0 || seconds[stage] < best[stage] ? seconds[stage] : best[stage];
+                    }
+                }
+
+                /// EVERY VARIANT MUST PRODUCE THE SAME BITS
+                first_digest = v == 0 ? digest : first_digest;
+
+                if (!verified || digest != first_digest)
+                {
+                    fprintf(stderr, "%s, %u bytes: variant %s does not match\n", corpora[c].name, sizes[s], cpu_variant_name(variants[v]));
+                    status = 1;
+                }
+
+                print_result(output, corpora[c].name, sizes[s], best, compressed_size, digest, verified,
+                             c == corpus_count - 1 && s == size_count - 1 && v == variant_count - 1);
+            }
+
+            fflush(output);
+            free(data);
+        }
+    }
+
+    fprintf(output, "  ]\n}\n");
+
+    clean_context(&context);
+
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+
+    return status;
+}
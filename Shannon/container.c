@@ -0,0 +1,863 @@
+#include "container.h"
+#include "utilities.h"
+#include "allocator.h"
+#include "huffman.h"
+#include "kernels.h"
+#include "tables.h"
+#include "transform.h"
+#include "lz77.h"
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+static unsigned int serialized_size(const struct node * const node)
+{
+    if (node == NULL)
+    {
+        return 0;
+    }
+
+    if (node->left_child == NULL && node->right_child == NULL)
+    {
+        return TREE_LEAF_SIZE(node->info.length);
+    }
+
+    return TREE_PARENT_SIZE + serialized_size(node->left_child) + serialized_size(node->right_child);
+}
+
+static unsigned char * serialize_nodes(const struct node * const node, unsigned char * buffer)
+{
+    if (node->left_child == NULL && node->right_child == NULL)
+    {
+        *buffer++ = 1;
+        store_u32(buffer, node->info.length);
+        memcpy(buffer + 4, node->info.sequence, node->info.length);
+        return buffer + 4 + node->info.length;
+    }
+
+    *buffer++ = 0;
+    buffer = serialize_nodes(node->left_child, buffer);
+    return serialize_nodes(node->right_child, buffer);
+}
+
+int serialize_huffman_tree(const struct node * const huffman_root, void ** buffer, unsigned int * length)
+{
+    if (huffman_root == NULL || buffer == NULL || length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    *length = serialized_size(huffman_root);
+
+    if ((*buffer = (void *)memory_alloc(*length)) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    serialize_nodes(huffman_root, (unsigned char *)*buffer);
+    return STATUS_SUCCESS;
+}
+
+static int deserialize_nodes(const unsigned char * const buffer, const unsigned int length, unsigned int * offset, struct node ** node, const unsigned int depth)
+{
+    /// A TREE OF 32-BIT TOTALS IS NEVER THAT DEEP, STOP CORRUPT INPUT FROM RECURSING FOREVER
+    if (*offset >= length || depth > 64)
+    {
+        return CORRUPT_DATA;
+    }
+
+    if ((*node = (struct node *)memory_calloc(1, sizeof(struct node))) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    if (buffer[(*offset)++] == 1)
+    {
+        if (length - *offset < 4 || length - *offset - 4 < load_u32(buffer + *offset))
+        {
+            return CORRUPT_DATA;
+        }
+
+        (*node)->info.length = load_u32(buffer + *offset);
+        *offset += 4;
+
+        if (((*node)->info.sequence = (void *)memory_calloc((*node)->info.length + 1, sizeof(unsigned char))) == NULL)
+        {
+            return BAD_MEMORY_ALLOC;
+        }
+
+        memcpy((*node)->info.sequence, buffer + *offset, (*node)->info.length);
+        *offset += (*node)->info.length;
+        return STATUS_SUCCESS;
+    }
+
+    int result;
+    if ((result = deserialize_nodes(buffer, length, offset, &(*node)->left_child, depth + 1)) != STATUS_SUCCESS
+            || (result = deserialize_nodes(buffer, length, offset, &(*node)->right_child, depth + 1)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    /// SAME NODE COUNT AS huffman_tree KEEPS IN bal
+    (*node)->bal = (*node)->left_child->bal + (*node)->right_child->bal + 2;
+    return STATUS_SUCCESS;
+}
+
+int deserialize_huffman_tree(const void * const buffer, const unsigned int length, struct node ** huffman_root, unsigned int * used)
+{
+    if (buffer == NULL || huffman_root == NULL || used == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    *huffman_root = NULL;
+    *used = 0;
+
+    int result = deserialize_nodes((const unsigned char *)buffer, length, used, huffman_root, 0);
+
+    if (result != STATUS_SUCCESS)
+    {
+        clean_nodes(huffman_root);
+        return result;
+    }
+
+    /// Add the root too !
+    ++(*huffman_root)->bal;
+    return STATUS_SUCCESS;
+}
+
+struct container_layout
+{
+    unsigned int version;
+    unsigned int symbol_count;
+
+    const unsigned char * tree;
+    unsigned int tree_length;
+
+    /// SEEK INDEX (VERSION 3 ONLY): interval == 0 WHEN THERE IS NONE
+    const unsigned char * index;
+    unsigned int interval;
+    unsigned int index_count;
+
+    const unsigned char * payload;
+    unsigned int payload_length;
+};
+
+static int read_container(const unsigned char * input, const unsigned int length, struct container_layout * layout)
+{
+    memset(layout, 0, sizeof(struct container_layout));
+
+    if (length < CONTAINER_HEADER_SIZE || memcmp(input, CONTAINER_MAGIC, 3) != 0
+            || input[3] < CONTAINER_VERSION || input[3] > CONTAINER_LZ_VERSION)
+    {
+        return CORRUPT_DATA;
+    }
+
+    layout->version = input[3];
+
+    const unsigned int header_size = input[3] == CONTAINER_INDEX_VERSION ? CONTAINER_INDEX_HEADER_SIZE : CONTAINER_HEADER_SIZE;
+    const unsigned int index_length = header_size == CONTAINER_INDEX_HEADER_SIZE && length >= header_size ? load_u32(input + 12) : 0;
+
+    layout->tree_length = load_u32(input + 4);
+    layout->symbol_count = load_u32(input + 8);
+
+    if (length < header_size || (unsigned long long)layout->tree_length + index_length > length - header_size)
+    {
+        return CORRUPT_DATA;
+    }
+
+    layout->tree = input + header_size;
+    layout->index = layout->tree + layout->tree_length;
+    layout->payload = layout->index + index_length;
+    layout->payload_length = length - header_size - layout->tree_length - index_length;
+
+    /// EMPTY DATA HAS NO TREE AND NEITHER HAS DATA CODED WITH THE TREE OF THE CONTAINER BEFORE;
+    /// STORED BYTES HAVE NONE, A RUN HOLDS ITS VALUE THERE, TRANSFORMED BLOCKS THEIR TABLE AND
+    /// LZ TOKENS THEIR CODE LENGTHS (A BIT OF THEM DECODES TO AT MOST LZ_MAX_MATCH BYTES)
+    if (layout->version == CONTAINER_STORED_VERSION
+            ? layout->tree_length != 0 || layout->payload_length != layout->symbol_count
+            : layout->version == CONTAINER_RUN_VERSION
+            ? layout->tree_length != 1 || layout->symbol_count == 0 || layout->payload_length != 0
+            : layout->version == CONTAINER_TRANSFORM_VERSION
+            ? layout->tree_length == 0 || layout->symbol_count == 0 || layout->payload_length < CONTAINER_HEADER_SIZE
+            : layout->version == CONTAINER_LZ_VERSION
+            ? layout->tree_length != LZ_TABLE_SIZE || layout->symbol_count == 0
+              || (unsigned long long)layout->payload_length * 8 * LZ_MAX_MATCH < layout->symbol_count
+            : layout->tree_length != 0 && layout->symbol_count == 0)
+    {
+        return CORRUPT_DATA;
+    }
+
+    if (header_size == CONTAINER_INDEX_HEADER_SIZE)
+    {
+        /// INTERVAL (4) + NUMBER OF CHECKPOINTS (4) + 8 BYTES PER CHECKPOINT
+        if (index_length < 8 || (layout->interval = load_u32(layout->index)) == 0
+                || (unsigned long long)(layout->index_count = load_u32(layout->index + 4)) * 8 != index_length - 8)
+        {
+            return CORRUPT_DATA;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+static int write_container(const struct coding_context * context, const void * tree, const unsigned int tree_length, const void * encoded, const unsigned int encoded_length,
+                           const unsigned int symbol_count, void ** compressed, unsigned int * compressed_length)
+{
+    /// A SEEK INDEX WITHOUT CHECKPOINTS (DATA SHORTER THAN THE INTERVAL) IS NOT WRITTEN
+    const struct seek_index * index = &context->index;
+    const bool indexed = context->index_interval != 0 && index->count != 0;
+    const unsigned int header_size = indexed ? CONTAINER_INDEX_HEADER_SIZE : CONTAINER_HEADER_SIZE;
+    const unsigned long long index_length = indexed ? 8 + (unsigned long long)index->count * 8 : 0;
+    const unsigned long long total = header_size + (unsigned long long)tree_length + index_length + encoded_length;
+
+    if (total > 0xFFFFFFFFULL || (*compressed = (void *)memory_alloc((size_t)total)) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    unsigned char * output = (unsigned char *)*compressed;
+
+    memcpy(output, CONTAINER_MAGIC, 3);
+    output[3] = indexed ? CONTAINER_INDEX_VERSION : CONTAINER_VERSION;
+    store_u32(output + 4, tree_length);
+    store_u32(output + 8, symbol_count);
+
+    if (indexed)
+    {
+        store_u32(output + 12, (unsigned int)index_length);
+    }
+
+    output += header_size;
+
+    if (tree_length != 0)
+    {
+        memcpy(output, tree, tree_length);
+        output += tree_length;
+    }
+
+    if (indexed)
+    {
+        store_u32(output, context->index_interval);
+        store_u32(output + 4, index->count);
+        output += 8;
+
+        for (unsigned int i = 0; i < index->count; ++i, output += 8)
+        {
+            store_u32(output, (unsigned int)index->offsets[i]);
+            store_u32(output + 4, (unsigned int)(index->offsets[i] >> 32));
+        }
+    }
+
+    if (encoded_length != 0)
+    {
+        memcpy(output, encoded, encoded_length);
+    }
+
+    *compressed_length = (unsigned int)total;
+    return STATUS_SUCCESS;
+}
+
+static int write_plain_container(struct coding_context * context, const unsigned char version, const unsigned char * data, const unsigned int length,
+                                 void ** compressed, unsigned int * compressed_length)
+{
+    /// THE BYTES / THE VALUE OF THE RUN TAKE THE PLACE OF THE BITS / THE TREE
+    const unsigned long long total = CONTAINER_HEADER_SIZE + (version == CONTAINER_RUN_VERSION ? 1ULL : length);
+
+    if (total > 0xFFFFFFFFULL || (*compressed = (void *)memory_alloc((size_t)total)) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    unsigned char * output = (unsigned char *)*compressed;
+
+    memcpy(output, CONTAINER_MAGIC, 3);
+    output[3] = version;
+    store_u32(output + 4, version == CONTAINER_RUN_VERSION ? 1 : 0);
+    store_u32(output + 8, length);
+    memcpy(output + CONTAINER_HEADER_SIZE, data, (size_t)(total - CONTAINER_HEADER_SIZE));
+
+    *compressed_length = (unsigned int)total;
+    context->sample_count = length;
+    context->index.count = 0;
+    return STATUS_SUCCESS;
+}
+
+static unsigned char choose_container(const unsigned char * data, const unsigned int length, unsigned int counts[256], unsigned int * distinct)
+{
+    double bits = 0;
+
+    memset(counts, 0, 256 * sizeof(unsigned int));
+    cpu_kernels()->histogram(data, length, counts);
+    *distinct = 0;
+
+    for (unsigned int value = 0; value < 256; ++value)
+    {
+        if (counts[value] != 0)
+        {
+            ++*distinct;
+            bits -= counts[value] * log2((double)counts[value] / length);
+        }
+    }
+
+    if (*distinct == 1)
+    {
+        return CONTAINER_RUN_VERSION;
+    }
+
+    /// THE CODES TAKE AT LEAST THE ENTROPY, THE SERIALIZED TREE 7 BYTES PER VALUE (LEAF AND PARENT)
+    const double estimate = bits / 8 + *distinct * 7.0;
+
+    return estimate + (double)length / STORED_MIN_SAVING >= length ? CONTAINER_STORED_VERSION : CONTAINER_VERSION;
+}
+
+static int keep_smaller(struct coding_context * context, const void * data, const unsigned int length, void ** compressed, unsigned int * compressed_length)
+{
+    /// THE ESTIMATE WAS TOO HOPEFUL: THE STORED BYTES ARE SMALLER THAN THE CODES
+    if (*compressed_length <= CONTAINER_HEADER_SIZE + (unsigned long long)length)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    memory_free(*compressed);
+    *compressed = NULL;
+    return write_plain_container(context, CONTAINER_STORED_VERSION, (const unsigned char *)data, length, compressed, compressed_length);
+}
+
+static bool reuse_pays(const struct huffman_codebook * book, const unsigned int counts[256])
+{
+    unsigned long long reused;
+    unsigned long long fresh;
+    unsigned int tree_length;
+
+    /// THE OLD CODES STAY UNLESS A NEW TREE SAVES MORE BITS THAN IT TAKES ITSELF
+    return huffman_encoded_bits(book, counts, &reused) == STATUS_SUCCESS
+           && huffman_fresh_cost(counts, &fresh, &tree_length) == STATUS_SUCCESS
+           && reused <= fresh + tree_length * 8ULL;
+}
+
+static int keep_tables(struct coding_context * context, const struct node * root)
+{
+    struct huffman_tables * tables = (struct huffman_tables *)memory_alloc(sizeof(struct huffman_tables));
+    int result = tables == NULL ? BAD_MEMORY_ALLOC : create_huffman_tables(root, tables);
+
+    if (context->previous != NULL)
+    {
+        unmap_huffman_tables(context->previous);
+        memory_free(context->previous);
+        context->previous = NULL;
+    }
+
+    if (result == STATUS_SUCCESS)
+    {
+        context->previous = tables;
+        return STATUS_SUCCESS;
+    }
+
+    /// CODES TOO LONG FOR A CODEBOOK: NOTHING IS KEPT AND THE NEXT CONTAINER HAS A TREE OF ITS OWN
+    memory_free(tables);
+    return result == NULL_RESULT ? STATUS_SUCCESS : result;
+}
+
+static int compress_with_tables(struct coding_context * context, const struct huffman_tables * tables, const bool with_tree,
+                                const void * data, const unsigned int length, void ** compressed, unsigned int * compressed_length)
+{
+    struct output_sink sink;
+    void * encoded;
+    unsigned int encoded_length;
+    int result;
+
+    /// THE TREE OF THE TABLES GOES TO THE CONTAINER, THE BITS COME FROM THEIR CODEBOOK
+    if ((result = create_buffer_sink(&sink, length / 2 + 16)) == STATUS_SUCCESS
+            && (result = huffman_encode_codebook_sink(context, tables->codebook, data, length, &sink)) == STATUS_SUCCESS
+            && (result = sink_release(&sink, &encoded, &encoded_length)) == STATUS_SUCCESS)
+    {
+        result = write_container(context, tables->tree, with_tree ? tables->tree_length : 0, encoded, encoded_length, length, compressed, compressed_length);
+        memory_free(encoded);
+    }
+
+    clean_sink(&sink);
+
+    if (result == STATUS_SUCCESS)
+    {
+        context->sample_count = length;
+    }
+
+    return result;
+}
+
+struct inner_settings
+{
+    const struct huffman_tables * tables;
+    bool reuse_tables;
+    unsigned int index_interval;
+    unsigned int transform_block;
+    unsigned int lz_level;
+};
+
+/// THE CODED BYTES OF TRANSFORMED BLOCKS GET A CONTAINER WITH A TREE OF ITS OWN: THE PRECOMPILED / KEPT
+/// TABLES DESCRIBE OTHER DATA, THE OFFSETS OF A SEEK INDEX WOULD NOT BE THOSE OF THE DATA
+static void enter_inner(struct coding_context * context, struct inner_settings * saved)
+{
+    saved->tables = context->tables;
+    saved->reuse_tables = context->reuse_tables;
+    saved->index_interval = context->index_interval;
+    saved->transform_block = context->transform_block;
+    saved->lz_level = context->lz_level;
+
+    context->tables = NULL;
+    context->reuse_tables = false;
+    context->index_interval = 0;
+    context->transform_block = 0;
+    context->lz_level = 0;
+}
+
+static void leave_inner(struct coding_context * context, const struct inner_settings * saved)
+{
+    context->tables = saved->tables;
+    context->reuse_tables = saved->reuse_tables;
+    context->index_interval = saved->index_interval;
+    context->transform_block = saved->transform_block;
+    context->lz_level = saved->lz_level;
+}
+
+static int compress_transformed(struct coding_context * context, const void * data, const unsigned int length, void ** compressed, unsigned int * compressed_length)
+{
+    struct inner_settings saved;
+    void * image;
+    unsigned int image_length;
+    void * inner;
+    unsigned int inner_length;
+    int result;
+
+    if ((result = block_transform(data, length, context->transform_block, context->thread_count, &image, &image_length)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    const unsigned int table_length = (unsigned int)TRANSFORM_TABLE_SIZE(load_u32(image));
+
+    enter_inner(context, &saved);
+    result = huffman_compress(context, (const unsigned char *)image + table_length, image_length - table_length, &inner, &inner_length, NULL, NULL);
+    leave_inner(context, &saved);
+
+    if (result == STATUS_SUCCESS)
+    {
+        const unsigned long long total = CONTAINER_HEADER_SIZE + (unsigned long long)table_length + inner_length;
+
+        if (total > 0xFFFFFFFFULL || (*compressed = (void *)memory_alloc((size_t)total)) == NULL)
+        {
+            result = BAD_MEMORY_ALLOC;
+        }
+        else
+        {
+            unsigned char * output = (unsigned char *)*compressed;
+
+            memcpy(output, CONTAINER_MAGIC, 3);
+            output[3] = CONTAINER_TRANSFORM_VERSION;
+            store_u32(output + 4, table_length);
+            store_u32(output + 8, length);
+            memcpy(output + CONTAINER_HEADER_SIZE, image, table_length);
+            memcpy(output + CONTAINER_HEADER_SIZE + table_length, inner, inner_length);
+
+            *compressed_length = (unsigned int)total;
+            context->sample_count = length;
+            context->index.count = 0;
+        }
+
+        memory_free(inner);
+    }
+
+    memory_free(image);
+    return result;
+}
+
+static int compress_lz(struct coding_context * context, const void * data, const unsigned int length, void ** compressed, unsigned int * compressed_length)
+{
+    void * coded;
+    unsigned int coded_length;
+    int result;
+
+    if ((result = lz_compress(data, length, context->lz_level, &coded, &coded_length)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    const unsigned long long total = CONTAINER_HEADER_SIZE + (unsigned long long)coded_length;
+
+    if (total > 0xFFFFFFFFULL || (*compressed = (void *)memory_alloc((size_t)total)) == NULL)
+    {
+        result = BAD_MEMORY_ALLOC;
+    }
+    else
+    {
+        unsigned char * output = (unsigned char *)*compressed;
+
+        /// THE CODE LENGTHS LEAD THE CODED DATA, THEY TAKE THE PLACE OF THE TREE
+        memcpy(output, CONTAINER_MAGIC, 3);
+        output[3] = CONTAINER_LZ_VERSION;
+        store_u32(output + 4, LZ_TABLE_SIZE);
+        store_u32(output + 8, length);
+        memcpy(output + CONTAINER_HEADER_SIZE, coded, coded_length);
+
+        *compressed_length = (unsigned int)total;
+        context->sample_count = length;
+        context->index.count = 0;
+    }
+
+    memory_free(coded);
+    return result;
+}
+
+int huffman_compress(struct coding_context * context, const void * data, const unsigned int length, void ** compressed, unsigned int * compressed_length, struct node ** huffman_root, struct hash_table ** huffman_table)
+{
+    if (context == NULL || data == NULL || compressed == NULL || compressed_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (huffman_root != NULL)
+    {
+        *huffman_root = NULL;
+    }
+
+    if (huffman_table != NULL)
+    {
+        *huffman_table = NULL;
+    }
+
+    if (length == 0)
+    {
+        context->sample_count = 0;
+        context->distinct_count = 0;
+        context->index.count = 0;
+        return write_container(context, NULL, 0, NULL, 0, 0, compressed, compressed_length);
+    }
+
+    int result;
+    unsigned int counts[256];
+    unsigned int distinct;
+    const unsigned char version = choose_container((const unsigned char *)data, length, counts, &distinct);
+
+    context->distinct_count = distinct;
+
+    /// THE HISTOGRAM OF THE DATA SAYS NOTHING ABOUT ITS REPEATS, ONLY A RUN SKIPS THE TRANSFORM
+    if (context->transform_block != 0 && version != CONTAINER_RUN_VERSION)
+    {
+        result = compress_transformed(context, data, length, compressed, compressed_length);
+        context->distinct_count = distinct;
+        return result == STATUS_SUCCESS ? keep_smaller(context, data, length, compressed, compressed_length) : result;
+    }
+
+    if (context->lz_level != 0 && version != CONTAINER_RUN_VERSION)
+    {
+        result = compress_lz(context, data, length, compressed, compressed_length);
+        context->distinct_count = distinct;
+        return result == STATUS_SUCCESS ? keep_smaller(context, data, length, compressed, compressed_length) : result;
+    }
+
+    if (version != CONTAINER_VERSION)
+    {
+        return write_plain_container(context, version, (const unsigned char *)data, length, compressed, compressed_length);
+    }
+
+    /// A BYTE THE PRECOMPILED TABLES HAVE NO CODE FOR FALLS BACK TO A TREE OF ITS OWN
+    if (context->tables != NULL && (result = compress_with_tables(context, context->tables, true, data, length, compressed, compressed_length)) != NULL_RESULT)
+    {
+        return result == STATUS_SUCCESS ? keep_smaller(context, data, length, compressed, compressed_length) : result;
+    }
+
+    /// THE TREE OF THE CONTAINER BEFORE IS NOT WRITTEN AGAIN
+    if (context->reuse_tables && context->tables == NULL && context->previous != NULL && reuse_pays(context->previous->codebook, counts)
+            && (result = compress_with_tables(context, context->previous, false, data, length, compressed, compressed_length)) != NULL_RESULT)
+    {
+        return result == STATUS_SUCCESS ? keep_smaller(context, data, length, compressed, compressed_length) : result;
+    }
+
+    struct node * root;
+    struct hash_table * table;
+    void * encoded;
+    unsigned int encoded_length;
+    void * tree;
+    unsigned int tree_length;
+
+    if ((result = huffman_encrypt_data(context, data, length, &encoded, &encoded_length, &root, &table)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    if ((result = serialize_huffman_tree(root, &tree, &tree_length)) == STATUS_SUCCESS)
+    {
+        result = write_container(context, tree, tree_length, encoded, encoded_length, length, compressed, compressed_length);
+        memory_free(tree);
+    }
+
+    memory_free(encoded);
+
+    if (result == STATUS_SUCCESS)
+    {
+        result = keep_smaller(context, data, length, compressed, compressed_length);
+    }
+
+    /// STORED BYTES HAVE NO TREE TO HAND OUT
+    const bool coded = result == STATUS_SUCCESS && ((const unsigned char *)*compressed)[3] != CONTAINER_STORED_VERSION;
+
+    /// THE DECODER KEEPS THE SAME TABLES; WITHOUT MEMORY FOR THEM THE NEXT CONTAINER GETS A TREE OF ITS OWN
+    if (coded && context->reuse_tables && context->tables == NULL)
+    {
+        keep_tables(context, root);
+    }
+
+    if (coded && huffman_root != NULL)
+    {
+        *huffman_root = root;
+    }
+    else
+    {
+        clean_nodes(&root);
+    }
+
+    if (coded && huffman_table != NULL)
+    {
+        *huffman_table = table;
+    }
+    else
+    {
+        clean_huffman_table(table);
+        memory_free(table);
+    }
+
+    return result;
+}
+
+static int decode_transformed(struct coding_context * context, const struct container_layout * layout, const unsigned int offset, const unsigned int count, struct output_sink * sink)
+{
+    struct inner_settings saved;
+    void * coded;
+    unsigned int coded_length;
+    unsigned int length;
+    unsigned char * data = NULL;
+    int result;
+
+    enter_inner(context, &saved);
+    result = huffman_decompress(context, layout->payload, layout->payload_length, &coded, &coded_length);
+    leave_inner(context, &saved);
+
+    if (result != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    if ((result = block_table_length(layout->tree, layout->tree_length, coded_length, &length)) == STATUS_SUCCESS && length != layout->symbol_count)
+    {
+        result = CORRUPT_DATA;
+    }
+
+    if (result == STATUS_SUCCESS && (data = (unsigned char *)memory_alloc(length)) == NULL)
+    {
+        result = BAD_MEMORY_ALLOC;
+    }
+
+    if (result == STATUS_SUCCESS
+            && (result = block_restore(layout->tree, layout->tree_length, coded, coded_length, context->thread_count, data)) == STATUS_SUCCESS
+            && (result = sink_write(sink, data + offset, count)) == STATUS_SUCCESS
+            && (result = sink_finish(sink)) == STATUS_SUCCESS)
+    {
+        context->sample_count = count;
+    }
+
+    memory_free(data);
+    memory_free(coded);
+    return result;
+}
+
+static int decode_lz(struct coding_context * context, const struct container_layout * layout, const unsigned int offset, const unsigned int count, struct output_sink * sink)
+{
+    unsigned char * data = (unsigned char *)memory_alloc(layout->symbol_count);
+    int result;
+
+    if (data == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    /// THE CODE LENGTHS FOLLOW THE HEADER DIRECTLY, lz_decompress READS THEM WITH THE BITS
+    if ((result = lz_decompress(layout->tree, layout->tree_length + layout->payload_length, data, layout->symbol_count)) == STATUS_SUCCESS
+            && (result = sink_write(sink, data + offset, count)) == STATUS_SUCCESS
+            && (result = sink_finish(sink)) == STATUS_SUCCESS)
+    {
+        context->sample_count = count;
+    }
+
+    memory_free(data);
+    return result;
+}
+
+static int decode_container(struct coding_context * context, const struct container_layout * layout, const unsigned int offset, const unsigned int count, struct output_sink * sink)
+{
+    const struct huffman_tables * tables = context->tables;
+    unsigned long long bit_offset = 0;
+    unsigned int skip = offset;
+    unsigned int checkpoint = layout->interval == 0 ? 0 : offset / layout->interval;
+
+    /// START AT THE LAST CHECKPOINT BEFORE THE RANGE, THE SYMBOLS BETWEEN ARE SKIPPED
+    if (checkpoint > layout->index_count)
+    {
+        checkpoint = layout->index_count;
+    }
+
+    if (checkpoint != 0)
+    {
+        const unsigned char * entry = layout->index + 8 + (checkpoint - 1) * 8;
+
+        bit_offset = load_u32(entry) | (unsigned long long)load_u32(entry + 4) << 32;
+        skip = offset - checkpoint * layout->interval;
+    }
+
+    if (count == 0)
+    {
+        context->sample_count = 0;
+        return sink_finish(sink);
+    }
+
+    /// TRANSFORMED BLOCKS ARE RESTORED WHOLE, THE RANGE IS CUT FROM THEM
+    if (layout->version == CONTAINER_TRANSFORM_VERSION)
+    {
+        return decode_transformed(context, layout, offset, count, sink);
+    }
+
+    /// SO ARE LZ TOKENS, A MATCH MAY REACH BACK TO ANY BYTE BEFORE IT
+    if (layout->version == CONTAINER_LZ_VERSION)
+    {
+        return decode_lz(context, layout, offset, count, sink);
+    }
+
+    /// STORED BYTES ARE COPIED, A RUN IS FILLED IN
+    if (layout->version == CONTAINER_STORED_VERSION || layout->version == CONTAINER_RUN_VERSION)
+    {
+        int result = layout->version == CONTAINER_STORED_VERSION ? sink_write(sink, layout->payload + offset, count) : sink_fill(sink, layout->tree[0], count);
+
+        if (result == STATUS_SUCCESS && (result = sink_finish(sink)) == STATUS_SUCCESS)
+        {
+            context->sample_count = count;
+        }
+
+        return result;
+    }
+
+    /// A CONTAINER WITHOUT A TREE IS CODED WITH THE TREE OF THE CONTAINER DECODED BEFORE IT
+    if (layout->tree_length == 0)
+    {
+        return context->previous == NULL ? CORRUPT_DATA
+               : huffman_decode_table_range(context, layout->payload, layout->payload_length, context->previous->decode, bit_offset, skip, count, sink);
+    }
+
+    /// A CONTAINER WRITTEN WITH THE PRECOMPILED TABLES IS DECODED WITHOUT REBUILDING ANYTHING
+    if (tables != NULL && !context->reuse_tables && tables->tree_length == layout->tree_length && memcmp(tables->tree, layout->tree, layout->tree_length) == 0)
+    {
+        return huffman_decode_table_range(context, layout->payload, layout->payload_length, tables->decode, bit_offset, skip, count, sink);
+    }
+
+    struct node * root;
+    struct decode_table * table = NULL;
+    unsigned int used;
+    int result;
+
+    if ((result = deserialize_huffman_tree(layout->tree, layout->tree_length, &root, &used)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    /// EVERY TREE IS KEPT FOR THE CONTAINERS AFTER IT, ITS DECODE TABLE IS BUILT ONCE THAT WAY
+    if (context->reuse_tables && (result = keep_tables(context, root)) == STATUS_SUCCESS && context->previous != NULL)
+    {
+        result = huffman_decode_table_range(context, layout->payload, layout->payload_length, context->previous->decode, bit_offset, skip, count, sink);
+    }
+    else if (result == STATUS_SUCCESS)
+    {
+        if ((table = (struct decode_table *)memory_alloc(sizeof(struct decode_table))) == NULL)
+        {
+            result = BAD_MEMORY_ALLOC;
+        }
+        else if ((result = build_decode_table(root, table)) == STATUS_SUCCESS)
+        {
+            result = huffman_decode_table_range(context, layout->payload, layout->payload_length, table, bit_offset, skip, count, sink);
+        }
+    }
+
+    memory_free(table);
+    clean_nodes(&root);
+    return result;
+}
+
+int huffman_decompress_sink(struct coding_context * context, const void * compressed, const unsigned int compressed_length, struct output_sink * sink)
+{
+    if (context == NULL || compressed == NULL || sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct container_layout layout;
+    int result;
+
+    if ((result = read_container((const unsigned char *)compressed, compressed_length, &layout)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    return decode_container(context, &layout, 0, layout.symbol_count, sink);
+}
+
+int huffman_decode_range(struct coding_context * context, const void * compressed, const unsigned int compressed_length, const unsigned int offset, const unsigned int length, struct output_sink * sink)
+{
+    if (context == NULL || compressed == NULL || sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct container_layout layout;
+    int result;
+
+    if ((result = read_container((const unsigned char *)compressed, compressed_length, &layout)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    if (offset > layout.symbol_count)
+    {
+        return INVALID_FORMAT;
+    }
+
+    /// A RANGE RUNNING PAST THE END OF THE DATA STOPS THERE
+    return decode_container(context, &layout, offset, layout.symbol_count - offset < length ? layout.symbol_count - offset : length, sink);
+}
+
+int huffman_decompress(struct coding_context * context, const void * compressed, const unsigned int compressed_length, void ** data, unsigned int * length)
+{
+    if (context == NULL || compressed == NULL || data == NULL || length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct container_layout layout;
+    int result;
+
+    if ((result = read_container((const unsigned char *)compressed, compressed_length, &layout)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    /// THE OUTPUT IS ALLOCATED ONCE; A COUNT ABOVE WHAT THE BITS COULD HOLD (DATA OF ONE SYMBOL OR A CORRUPT HEADER) STARTS SMALLER AND GROWS
+    struct output_sink sink;
+    unsigned long long bound = (unsigned long long)compressed_length * 8;
+
+    if ((result = create_buffer_sink(&sink, layout.symbol_count < bound ? layout.symbol_count : (unsigned int)bound)) == STATUS_SUCCESS
+            && (result = decode_container(context, &layout, 0, layout.symbol_count, &sink)) == STATUS_SUCCESS)
+    {
+        result = sink_release(&sink, data, length);
+    }
+
+    clean_sink(&sink);
+    return result;
+}
@@ -0,0 +1,180 @@
+#ifndef _CONTAINER_H_
+#define _CONTAINER_H_
+#include "hash_table.h"
+#include "context.h"
+#include "sink.h"
+
+/// "HUF" FOLLOWED BY THE VERSION OF THE FORMAT
+#define CONTAINER_MAGIC       "HUF"
+#define CONTAINER_VERSION     2
+
+/// MAGIC (3) + VERSION (1) + SIZE OF THE TREE (4) + NUMBER OF SYMBOLS (4)
+#define CONTAINER_HEADER_SIZE 12
+
+/// A CONTAINER WITH A SEEK INDEX: THE HEADER ENDS WITH THE SIZE OF THE INDEX (4),
+/// WHICH LIES BETWEEN THE TREE AND THE BITS: INTERVAL (4), NUMBER OF CHECKPOINTS (4)
+/// AND THE BIT OFFSET (8) OF SYMBOL (i + 1) * INTERVAL FOR EVERY CHECKPOINT
+#define CONTAINER_INDEX_VERSION     3
+#define CONTAINER_INDEX_HEADER_SIZE 16
+
+/// DATA THAT HUFFMAN CODES CANNOT SHRINK IS STORED AS IT IS: HEADER (12, TREE SIZE 0) AND THE BYTES
+#define CONTAINER_STORED_VERSION 4
+
+/// DATA OF A SINGLE BYTE VALUE: HEADER (12, TREE SIZE 1) AND THE VALUE, THE NUMBER OF SYMBOLS IS THE RUN
+#define CONTAINER_RUN_VERSION 5
+
+/// DATA CODED AFTER block_transform (transform.h): HEADER (12, THE SIZE OF THE BLOCK TABLE IN PLACE OF
+/// THE SIZE OF THE TREE), THE BLOCK TABLE, THEN A CONTAINER OF ANOTHER VERSION WITH THE CODED BYTES
+#define CONTAINER_TRANSFORM_VERSION 6
+
+/// DATA CODED BY lz_compress (lz77.h): HEADER (12, LZ_TABLE_SIZE IN PLACE OF THE SIZE OF THE TREE),
+/// THE CODE LENGTHS OF BOTH ALPHABETS IN PLACE OF THE TREE, THEN THE BITS OF THE TOKENS
+#define CONTAINER_LZ_VERSION 7
+
+/// THE CODES MUST SAVE AT LEAST 1 / STORED_MIN_SAVING OF THE DATA, OTHERWISE IT IS STORED
+#define STORED_MIN_SAVING 64
+
+/// BYTES OF A SERIALIZED TREE: A PARENT IS ITS MARKER, A LEAF ITS MARKER, THE LENGTH (4) AND THE SEQUENCE
+#define TREE_PARENT_SIZE       1
+#define TREE_LEAF_SIZE(length) (1 + 4 + (length))
+
+/**
+*   Serializes the tree in preorder: 0 for an intermediary node, 1 for a leaf
+*   followed by the length of its sequence (4 bytes) and the sequence.
+*
+*   @PARAMS
+*   huffman_root - Root of the Huffman tree
+*   buffer       - Receives the serialized tree (allocated)
+*   length       - Receives the size of the serialized tree in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the buffer
+*   STATUS_SUCCESS   - Tree was serialized
+*/
+int serialize_huffman_tree(const struct node * const huffman_root, void ** buffer, unsigned int * length);
+
+/**
+*   @PARAMS
+*   buffer       - Memory address of a tree written by serialize_huffman_tree
+*   length       - Bytes available in the buffer
+*   huffman_root - Receives the rebuilt tree (totals are not stored, they are 0)
+*   used         - Receives the number of bytes the tree took
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   CORRUPT_DATA     - The buffer does not hold a valid tree
+*   BAD_MEMORY_ALLOC - Could not allocate the nodes
+*   STATUS_SUCCESS   - Tree was rebuilt
+*/
+int deserialize_huffman_tree(const void * const buffer, const unsigned int length, struct node ** huffman_root, unsigned int * used);
+
+/**
+*   Encodes the data and wraps it with everything the decoder needs:
+*   header, serialized tree, then the encoded bits. The header holds the exact
+*   number of symbols, so any byte (0 included) can be encoded. Empty data
+*   gets a header alone.
+*
+*   With context->tables set, the tree and the codes of the precompiled tables
+*   are used (huffman_root and huffman_table receive NULL); data holding a byte
+*   they have no code for gets a tree of its own.
+*
+*   With context->index_interval set, a seek index with a checkpoint every
+*   index_interval symbols is written too (version 3), see huffman_decode_range.
+*
+*   The histogram picks the kind of the container first: data of one byte value
+*   becomes a run (version 5) and data whose entropy leaves less than
+*   1 / STORED_MIN_SAVING to gain is stored (version 4), both without a tree
+*   (huffman_root and huffman_table receive NULL). Huffman codes that come out
+*   larger than the data are replaced by the stored bytes as well, so the
+*   container never grows by more than its header.
+*
+*   With context->transform_block set, data of more than one byte value goes
+*   through block_transform first (blocks of transform_block bytes,
+*   context->thread_count at a time) and the coded bytes of the blocks get a
+*   container of their own inside a version 6 container; it has no tree to
+*   hand out (huffman_root and huffman_table receive NULL) and no seek index,
+*   every block is restored to decode a range of it. The precompiled and the
+*   kept tables describe untransformed data, so they are not used for it.
+*
+*   With context->lz_level set instead, such data is parsed into literals and
+*   matches at that level and coded by lz_compress in a version 7 container,
+*   without a tree to hand out or a seek index either.
+*
+*   With context->reuse_tables set (and no precompiled tables), the tables of
+*   the last container with a tree of its own are kept in context->previous;
+*   when huffman_encoded_bits shows that their codes cost no more than a new
+*   tree with its bytes (huffman_fresh_cost), the data is coded with them and
+*   the container holds no tree. Such a container can only be decoded by a
+*   context with reuse_tables that decoded the containers before it in order.
+*
+*   @PARAMS
+*   context           - Configuration, scratch buffer and counts of the encode
+*   data              - Memory address of data
+*   length            - In bytes
+*   compressed        - Receives the container (allocated)
+*   compressed_length - Receives the size of the container in bytes
+*   huffman_root      - Receives the Huffman tree, may be NULL
+*   huffman_table     - Receives the table of key-code pairs, may be NULL
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   NULL_RESULT      - The Huffman tree / table could not be built
+*   BAD_MEMORY_ALLOC - Could not allocate the container
+*   STATUS_SUCCESS   - Data was compressed
+*/
+int huffman_compress(struct coding_context * context, const void * data, const unsigned int length, void ** compressed, unsigned int * compressed_length, struct node ** huffman_root, struct hash_table ** huffman_table);
+
+/**
+*   @PARAMS
+*   context           - Configuration and counts of the decode
+*   compressed        - Memory address of a container written by huffman_compress
+*   compressed_length - In bytes
+*   data              - Receives the decoded data (allocated)
+*   length            - Receives the size of the decoded data in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   CORRUPT_DATA     - Not a container of a supported version or truncated
+*   BAD_MEMORY_ALLOC - Could not allocate the decoded data
+*   STATUS_SUCCESS   - Data was decompressed
+*/
+int huffman_decompress(struct coding_context * context, const void * compressed, const unsigned int compressed_length, void ** data, unsigned int * length);
+
+/**
+*   Same as huffman_decompress, the decoded data is written to a sink. A
+*   container holding the tree of context->tables is decoded with their decode
+*   table, without rebuilding the tree. With context->reuse_tables the tables
+*   of every tree are kept for the containers without one that follow.
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   CORRUPT_DATA   - Not a container of a supported version
+*   STATUS_SUCCESS - Data was decompressed
+*   Any error of the sink
+*/
+int huffman_decompress_sink(struct coding_context * context, const void * compressed, const unsigned int compressed_length, struct output_sink * sink);
+
+/**
+*   Decodes length symbols starting at symbol offset. With a seek index the
+*   decode starts at the last checkpoint before offset, without one it starts
+*   at the beginning of the data; only the range is written to the sink.
+*
+*   @PARAMS
+*   context           - Configuration and counts of the decode
+*   compressed        - Memory address of a container written by huffman_compress
+*   compressed_length - In bytes
+*   offset            - First symbol of the range
+*   length            - Symbols in the range, a range past the end stops there
+*   sink              - Receives the decoded range, finished before returning
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   INVALID_FORMAT - offset is past the end of the data
+*   CORRUPT_DATA   - Not a container of a supported version or truncated
+*   STATUS_SUCCESS - Range was decoded
+*   Any error of the sink
+*/
+int huffman_decode_range(struct coding_context * context, const void * compressed, const unsigned int compressed_length, const unsigned int offset, const unsigned int length, struct output_sink * sink);
+
+#endif // _CONTAINER_H_
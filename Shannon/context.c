@@ -0,0 +1,89 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "context.h"
+#include "tables.h"
+#include <stdlib.h>
+#include <string.h>
+
+int create_context(struct coding_context * context)
+{
+    if (context == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memset(context, 0, sizeof(struct coding_context));
+
+    context->specifier = DEFAULT_SPECIFIER;
+    context->table_size = DEFAULT_TABLE_SIZE;
+    context->thread_count = DEFAULT_THREAD_COUNT;
+    context->print_flag = false;
+
+    return STATUS_SUCCESS;
+}
+
+void * context_scratch(struct coding_context * context, const unsigned int size)
+{
+    if (context == NULL)
+    {
+        return NULL;
+    }
+
+    if (context->scratch_size < size)
+    {
+        void * scratch = memory_realloc(context->scratch, size);
+
+        if (scratch == NULL)
+        {
+            return NULL;
+        }
+
+        context->scratch = scratch;
+        context->scratch_size = size;
+    }
+
+    return context->scratch;
+}
+
+int clean_context(struct coding_context * context)
+{
+    if (context == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memory_free(context->scratch);
+    context->scratch = NULL;
+    context->scratch_size = 0;
+
+    memory_free(context->index.offsets);
+    memset(&context->index, 0, sizeof(struct seek_index));
+
+    if (context->previous != NULL)
+    {
+        unmap_huffman_tables(context->previous);
+        memory_free(context->previous);
+        context->previous = NULL;
+    }
+
+    return clean_top(context);
+}
+
+int clean_top(struct coding_context * context)
+{
+    if (context == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    for (unsigned int i = 0; i < context->top_found; ++i)
+    {
+        memory_free(context->top[i].sequence);
+    }
+
+    memory_free(context->top);
+    context->top = NULL;
+    context->top_found = 0;
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#ifndef _CONTEXT_H_
+#define _CONTEXT_H_
+#include <stdbool.h>
+#include "stats.h"
+#include "weight_data.h"
+
+#define DEFAULT_SPECIFIER    1
+#define DEFAULT_TABLE_SIZE   128
+#define DEFAULT_THREAD_COUNT 1
+
+struct huffman_tables;
+
+struct seek_index
+{
+    /// BIT OFFSET IN THE ENCODED DATA OF SYMBOL (i + 1) * index_interval
+    unsigned long long * offsets;
+    unsigned int count;
+    unsigned int capacity;
+};
+
+struct coding_context
+{
+    /// CONFIGURATION
+    unsigned int specifier;
+    unsigned int table_size;
+    unsigned int thread_count;
+
+    /// WHEN NOT 0, words_entropy ONLY TRACKS THE word_capacity MOST FREQUENT WORDS (BOUNDED MEMORY)
+    unsigned int word_capacity;
+
+    /// WHEN NOT 0, THE ANALYSIS KEEPS ITS top_count MOST FREQUENT SEQUENCES / WORDS IN top
+    unsigned int top_count;
+
+    /// WHEN SET, TABLES / TREES / DATA ARE PRINTED TO STDOUT
+    bool print_flag;
+
+    /// WHEN NOT 0, THE ENCODER RECORDS A SEEK INDEX ENTRY EVERY index_interval SYMBOLS
+    unsigned int index_interval;
+
+    /// PRECOMPILED TABLES (tables.h) THE CONTAINER USES INSTEAD OF BUILDING ITS OWN, MAY BE NULL
+    const struct huffman_tables * tables;
+
+    /// WHEN SET, A CONTAINER MAY BE CODED WITH THE TREE OF THE CONTAINER BEFORE IT WHEN A NEW
+    /// TREE DOES NOT PAY FOR ITSELF; SUCH CONTAINERS ARE DECODED IN ORDER BY A CONTEXT WITH THE FLAG
+    bool reuse_tables;
+
+    /// WHEN NOT 0, huffman_compress RUNS THE BURROWS-WHEELER / MOVE-TO-FRONT TRANSFORM (transform.h) ON
+    /// BLOCKS OF transform_block BYTES BEFORE CODING, thread_count BLOCKS AT A TIME
+    unsigned int transform_block;
+
+    /// WHEN NOT 0 (AND NO transform_block), huffman_compress CODES LZ77 TOKENS (lz77.h) FOUND WITH
+    /// THE MATCH FINDER OF LEVEL lz_level INSTEAD OF THE BYTES
+    unsigned int lz_level;
+
+    /// COUNTS OF THE LAST ANALYSIS
+    unsigned int sample_count;
+    unsigned int distinct_count;
+
+    /// OCCURRENCES OF THE WORDS PRUNED BY THE BOUNDED MODE
+    unsigned int other_count;
+
+    /// MOST FREQUENT SEQUENCES / WORDS OF THE LAST ANALYSIS (ONLY WITH top_count), THE LARGEST
+    /// TOTAL FIRST; THE SEQUENCES ARE COPIES OWNED BY THE CONTEXT
+    struct weight_data * top;
+    unsigned int top_found;
+
+    /// STAGE TIMES AND OPERATION COUNTS, ADDED UP OVER THE CALLS (ONLY WITH SHANNON_STATS)
+    struct coding_stats stats;
+
+    /// SCRATCH BUFFER, GROWN ON DEMAND AND REUSED BY THE NEXT CALLS
+    void * scratch;
+    unsigned int scratch_size;
+
+    /// SEEK INDEX OF THE LAST ENCODE (ONLY WITH index_interval), GROWN LIKE THE SCRATCH BUFFER
+    struct seek_index index;
+
+    /// TABLES OF THE LAST CONTAINER WITH A TREE OF ITS OWN (ONLY WITH reuse_tables), MAY BE NULL
+    struct huffman_tables * previous;
+};
+
+/**
+*   Every analysis / encode that runs at the same time needs its own context,
+*   the functions of shannon.c and huffman.c keep no other state.
+*
+*   @PARAMS
+*   context - Memory address of the context
+*
+*   @RETURN
+*   NULL_ARGUMENT  - context is NULL
+*   STATUS_SUCCESS - Context was filled with the default configuration
+*/
+int create_context(struct coding_context * context);
+
+/**
+*   @PARAMS
+*   context - Memory address of the context
+*   size    - Minimum size of the scratch buffer in bytes
+*
+*   @RETURN
+*    NULL - context is NULL or memory could not be allocated
+*   !NULL - Scratch buffer of at least size bytes, valid until the next call
+*/
+void * context_scratch(struct coding_context * context, const unsigned int size);
+
+/**
+*   @PARAMS
+*   context - Memory address of the context
+*
+*   @RETURN
+*   NULL_ARGUMENT  - context is NULL
+*   STATUS_SUCCESS - Scratch buffers, the seek index, the previous tables and the top sequences were released
+*/
+int clean_context(struct coding_context * context);
+
+/**
+*   @PARAMS
+*   context - Memory address of the context
+*
+*   @RETURN
+*   NULL_ARGUMENT  - context is NULL
+*   STATUS_SUCCESS - The top sequences of the last analysis were released
+*/
+int clean_top(struct coding_context * context);
+
+#endif // _CONTEXT_H_
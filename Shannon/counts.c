@@ -0,0 +1,191 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "counts.h"
+#include <string.h>
+
+bool is_frequency_data(const void * const data, const unsigned int length)
+{
+    return data != NULL && length >= COUNTS_HEADER_SIZE && memcmp(data, COUNTS_MAGIC, 3) == 0;
+}
+
+static unsigned long long records_size(const struct node * const node)
+{
+    if (node == NULL)
+    {
+        return 0;
+    }
+
+    return COUNTS_RECORD_SIZE + node->info.length + records_size(node->left_child) + records_size(node->right_child);
+}
+
+static unsigned char * write_records(const struct node * const node, unsigned char * output)
+{
+    if (node != NULL)
+    {
+        store_u32(output, node->info.length);
+        store_u32(output + 4, node->info.total);
+        memcpy(output + COUNTS_RECORD_SIZE, node->info.sequence, node->info.length);
+
+        output = write_records(node->left_child, output + COUNTS_RECORD_SIZE + node->info.length);
+        output = write_records(node->right_child, output);
+    }
+    return output;
+}
+
+int encode_frequency_table(const struct hash_table * const table, void ** buffer, unsigned int * length)
+{
+    if (table == NULL || table->trees == NULL || buffer == NULL || length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned long long size = COUNTS_HEADER_SIZE;
+
+    for (unsigned int i = 0; i < table->table_size; ++i)
+    {
+        size += records_size((table->trees + i)->root);
+    }
+
+    unsigned char * output = size > 0xFFFFFFFFULL ? NULL : (unsigned char *)memory_alloc((unsigned int)size);
+
+    if (output == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    unsigned char * end = output + COUNTS_HEADER_SIZE;
+
+    for (unsigned int i = 0; i < table->table_size; ++i)
+    {
+        end = write_records((table->trees + i)->root, end);
+    }
+
+    memcpy(output, COUNTS_MAGIC, 3);
+    output[3] = COUNTS_VERSION;
+    store_u32(output + 4, table->element_count);
+    store_u32(output + 8, table->sample_count);
+    store_u32(output + 12, table->other_count);
+    store_u32(output + 16, table->error_bound);
+
+    *buffer = output;
+    *length = (unsigned int)size;
+    return STATUS_SUCCESS;
+}
+
+int save_frequency_table(const struct hash_table * const table, const char * const file_name)
+{
+    if (table == NULL || file_name == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    void * buffer;
+    unsigned int length;
+    int result = encode_frequency_table(table, &buffer, &length);
+
+    if (result == STATUS_SUCCESS)
+    {
+        result = write_data(file_name, buffer, length);
+        memory_free(buffer);
+    }
+
+    return result;
+}
+
+int merge_frequency_data(struct hash_table * table, const void * const data, const unsigned int length, int (*hash_fun)(const void * const, unsigned int), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
+{
+    if (table == NULL || table->trees == NULL || data == NULL || hash_fun == NULL || compare == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    const unsigned char * input = (const unsigned char *)data;
+
+    if (!is_frequency_data(data, length) || input[3] != COUNTS_VERSION)
+    {
+        return INVALID_FORMAT;
+    }
+
+    const unsigned int element_count = load_u32(input + 4);
+    const unsigned int sample_count = load_u32(input + 8);
+    const unsigned int other_count = load_u32(input + 12);
+
+    const unsigned int error_bound = load_u32(input + 16);
+
+    /// THE OCCURRENCES TAKEN FROM THE SURVIVORS ARE WHAT sample_count HAS MORE THAN THE TOTALS AND other_count
+    unsigned int deducted_count;
+
+    /// FIRST PASS: THE RECORDS FILL THE IMAGE EXACTLY AND THEIR TOTALS ADD UP TO sample_count, ONLY A BOUNDED
+    /// TABLE (error_bound != 0) HAS DEDUCTED OCCURRENCES
+    {
+        unsigned long long samples = other_count;
+        unsigned int offset = COUNTS_HEADER_SIZE;
+
+        for (unsigned int i = 0; i < element_count; ++i)
+        {
+            if (length - offset < COUNTS_RECORD_SIZE || load_u32(input + offset) == 0
+                    || length - offset - COUNTS_RECORD_SIZE < load_u32(input + offset))
+            {
+                return CORRUPT_DATA;
+            }
+
+            samples += load_u32(input + offset + 4);
+            offset += COUNTS_RECORD_SIZE + load_u32(input + offset);
+        }
+
+        if (offset != length || samples > sample_count || (samples != sample_count && error_bound == 0))
+        {
+            return CORRUPT_DATA;
+        }
+
+        deducted_count = sample_count - (unsigned int)samples;
+    }
+
+    int result;
+    unsigned int offset = COUNTS_HEADER_SIZE;
+
+    for (unsigned int i = 0; i < element_count; ++i)
+    {
+        const unsigned int key_length = load_u32(input + offset);
+
+        if ((result = add_counted_element(table, input + offset + COUNTS_RECORD_SIZE, key_length, load_u32(input + offset + 4), hash_fun, compare)) != STATUS_SUCCESS)
+        {
+            return result;
+        }
+
+        offset += COUNTS_RECORD_SIZE + key_length;
+    }
+
+    table->sample_count += other_count + deducted_count;
+    table->other_count += other_count;
+    table->deducted_count += deducted_count;
+    table->error_bound += error_bound;
+
+    return STATUS_SUCCESS;
+}
+
+int merge_frequency_file(struct hash_table * table, const char * const file_name, int (*hash_fun)(const void * const, unsigned int), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
+{
+    if (table == NULL || file_name == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    void * buffer;
+    unsigned int length;
+
+    if (read_data(file_name, &buffer, &length) != STATUS_SUCCESS)
+    {
+        return FILE_ERROR;
+    }
+
+    int result = merge_frequency_data(table, buffer, length, hash_fun, compare);
+    memory_free(buffer);
+    return result;
+}
+
+int parse_frequency_data(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier)
+{
+    (void)specifier;
+    return merge_frequency_data(table, data, length, hash_code, seq_cmp);
+}
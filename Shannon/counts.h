@@ -0,0 +1,104 @@
+#ifndef _COUNTS_H_
+#define _COUNTS_H_
+#include <stdbool.h>
+#include "hash_table.h"
+
+/// "HFC" FOLLOWED BY THE VERSION, THEN THE NUMBER OF ELEMENTS, sample_count, other_count AND error_bound (4 EACH);
+/// deducted_count IS NOT STORED, IT IS sample_count MINUS THE TOTALS AND other_count
+#define COUNTS_MAGIC       "HFC"
+#define COUNTS_VERSION     1
+#define COUNTS_HEADER_SIZE 20
+
+/// EVERY ELEMENT IS ITS LENGTH (4) AND ITS TOTAL (4) FOLLOWED BY ITS BYTES; ALL INTEGERS ARE LITTLE-ENDIAN,
+/// SO A FILE COUNTED ON ONE MACHINE IS MERGED ON ANY OTHER
+#define COUNTS_RECORD_SIZE 8
+
+/**
+*   @PARAMS
+*   data   - Memory address of data
+*   length - In bytes
+*
+*   @RETURN
+*   true  - data starts like a counts file
+*   false - Anything else
+*/
+bool is_frequency_data(const void * const data, const unsigned int length);
+
+/**
+*   Serializes the totals of a frequency table (frequency_hash_table,
+*   parallel_word_table or a merge of those), the bounded mode included.
+*
+*   @PARAMS
+*   table  - Frequency table
+*   buffer - Receives the image (allocated)
+*   length - Receives the size of the image in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the image
+*   STATUS_SUCCESS   - Image is ready
+*/
+int encode_frequency_table(const struct hash_table * const table, void ** buffer, unsigned int * length);
+
+/**
+*   @PARAMS
+*   table     - Frequency table
+*   file_name - Path of the counts file
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the image
+*   FILE_ERROR       - Could not write the file
+*   STATUS_SUCCESS   - File was written
+*/
+int save_frequency_table(const struct hash_table * const table, const char * const file_name);
+
+/**
+*   Adds the counts of an image to table like merge_table does: the totals of
+*   the elements present in both are summed, sample_count, other_count,
+*   deducted_count and error_bound are added. The image is checked before
+*   anything is added, so a corrupt one leaves the table unchanged. The keys
+*   are hashed again with hash_fun, the function the table was filled with.
+*
+*   @PARAMS
+*   table    - The table that receives the counts
+*   data     - Image written by encode_frequency_table / save_frequency_table
+*   length   - In bytes
+*   hash_fun - Hash function of the table
+*   compare  - Comparison function
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   INVALID_FORMAT   - Not a counts image or another version
+*   CORRUPT_DATA     - Truncated, trailing bytes or totals that do not add up
+*   BAD_MEMORY_ALLOC - Could not allocate memory for a new element
+*   STATUS_SUCCESS   - Counts were merged
+*/
+int merge_frequency_data(struct hash_table * table, const void * const data, const unsigned int length, int (*hash_fun)(const void * const seq, unsigned int sz), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int));
+
+/**
+*   Same as merge_frequency_data, with the image read from a file.
+*
+*   @RETURN
+*   FILE_ERROR - Could not read the file
+*   Any result of merge_frequency_data
+*/
+int merge_frequency_file(struct hash_table * table, const char * const file_name, int (*hash_fun)(const void * const seq, unsigned int sz), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int));
+
+/**
+*   merge_frequency_data with the signature of the parsers of shannon.h, so a
+*   counts image goes wherever data is parsed: frequency_hash_table,
+*   huffman_tree and the entropy functions. The keys are hashed with hash_code.
+*
+*   @PARAMS
+*   table     - The table that receives the counts
+*   data      - Counts image
+*   length    - In bytes
+*   specifier - Not used
+*
+*   @RETURN
+*   Any result of merge_frequency_data
+*/
+int parse_frequency_data(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier);
+
+#endif // _COUNTS_H_
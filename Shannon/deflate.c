@@ -0,0 +1,477 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "huffman.h"
+#include "lz77.h"
+#include "deflate.h"
+#include <string.h>
+
+/// ORDER IN WHICH THE HEADER OF A BLOCK SENDS THE CODE LENGTHS OF THE RUN-LENGTH SYMBOLS
+static const unsigned char length_order[DEFLATE_LENGTH_SYMBOLS] =
+{
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/// EXTRA BITS OF THE RUN-LENGTH SYMBOLS: 16 REPEATS 3 TO 6 TIMES, 17 IS 3 TO 10 ZEROS, 18 IS 11 TO 138 ZEROS
+static const unsigned char run_extra_bits[DEFLATE_LENGTH_SYMBOLS] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7
+};
+
+struct block_codes
+{
+    /// CODES OF THE LITERAL / LENGTH SYMBOLS, THEN OF THE DISTANCE SYMBOLS
+    unsigned char lengths[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    unsigned short codes[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+
+    /// SYMBOLS WHOSE LENGTHS ARE SENT, THE LAST ZEROS ARE LEFT OUT
+    unsigned int literal_count;
+    unsigned int distance_count;
+
+    /// THE SENT LENGTHS RUN-LENGTH CODED: SYMBOL AND VALUE OF ITS EXTRA BITS
+    unsigned char runs[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    unsigned char run_values[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    unsigned int run_count;
+
+    /// CODES OF THE RUN-LENGTH SYMBOLS AND HOW MANY OF THEIR LENGTHS (IN length_order) ARE SENT
+    unsigned char run_lengths[DEFLATE_LENGTH_SYMBOLS];
+    unsigned short run_codes[DEFLATE_LENGTH_SYMBOLS];
+    unsigned int run_length_count;
+};
+
+unsigned int gzip_crc32(const unsigned int crc, const void * data, const size_t length)
+{
+    const unsigned char * bytes = (const unsigned char *)data;
+    unsigned int table[256];
+    unsigned int value = ~crc;
+
+    /// THE TABLE IS CHEAP NEXT TO THE BYTES OF A FILE, IT IS BUILT FOR EVERY CALL
+    for (unsigned int i = 0; i < 256; ++i)
+    {
+        unsigned int entry = i;
+
+        for (unsigned int bit = 0; bit < 8; ++bit)
+        {
+            entry = entry & 1 ? 0xEDB88320U ^ entry >> 1 : entry >> 1;
+        }
+        table[i] = entry;
+    }
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        value = table[(value ^ bytes[i]) & 0xFF] ^ value >> 8;
+    }
+
+    return ~value;
+}
+
+static void add_run(struct block_codes * codes, const unsigned int symbol, const unsigned int value)
+{
+    codes->runs[codes->run_count] = (unsigned char)symbol;
+    codes->run_values[codes->run_count] = (unsigned char)value;
+    ++codes->run_count;
+}
+
+static void run_length_code(struct block_codes * codes, const unsigned char * lengths, const unsigned int count)
+{
+    codes->run_count = 0;
+
+    for (unsigned int i = 0; i < count; )
+    {
+        const unsigned char value = lengths[i];
+        unsigned int run = 1;
+
+        while (i + run < count && lengths[i + run] == value)
+        {
+            ++run;
+        }
+        i += run;
+
+        if (value == 0)
+        {
+            while (run >= 11)
+            {
+                const unsigned int part = run < 138 ? run : 138;
+
+                add_run(codes, 18, part - 11);
+                run -= part;
+            }
+
+            if (run >= 3)
+            {
+                add_run(codes, 17, run - 3);
+                run = 0;
+            }
+        }
+        else
+        {
+            /// A REPEAT NEEDS THE LENGTH SENT ONCE BEFORE IT
+            add_run(codes, value, 0);
+            --run;
+
+            while (run >= 3)
+            {
+                const unsigned int part = run < 6 ? run : 6;
+
+                add_run(codes, 16, part - 3);
+                run -= part;
+            }
+        }
+
+        for (; run > 0; --run)
+        {
+            add_run(codes, value, 0);
+        }
+    }
+}
+
+/// CODES OF A BLOCK WITH THE SYMBOL COUNTS counts, header_bits RECEIVES THE SIZE OF WHAT DESCRIBES THEM
+static int plan_block(const unsigned int * counts, struct block_codes * codes, unsigned long long * header_bits)
+{
+    unsigned char * distance_lengths = codes->lengths + LZ_LITERAL_SYMBOLS;
+    unsigned char sent[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    unsigned int run_counts[DEFLATE_LENGTH_SYMBOLS];
+    int result;
+
+    if ((result = huffman_code_lengths(counts, LZ_LITERAL_SYMBOLS, LZ_MAX_CODE_LENGTH, codes->lengths)) != STATUS_SUCCESS
+            || (result = huffman_code_lengths(counts + LZ_LITERAL_SYMBOLS, LZ_DISTANCE_SYMBOLS, LZ_MAX_CODE_LENGTH, distance_lengths)) != STATUS_SUCCESS
+            || (result = lz_canonical_codes(codes->lengths, LZ_LITERAL_SYMBOLS, codes->codes)) != STATUS_SUCCESS
+            || (result = lz_canonical_codes(distance_lengths, LZ_DISTANCE_SYMBOLS, codes->codes + LZ_LITERAL_SYMBOLS)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    /// AT LEAST 257 LITERAL / LENGTH AND 1 DISTANCE LENGTHS ARE SENT, ONE AFTER THE OTHER
+    for (codes->literal_count = LZ_LITERAL_SYMBOLS; codes->literal_count > LZ_END_OF_DATA + 1 && codes->lengths[codes->literal_count - 1] == 0; )
+    {
+        --codes->literal_count;
+    }
+
+    for (codes->distance_count = LZ_DISTANCE_SYMBOLS; codes->distance_count > 1 && distance_lengths[codes->distance_count - 1] == 0; )
+    {
+        --codes->distance_count;
+    }
+
+    memcpy(sent, codes->lengths, codes->literal_count);
+    memcpy(sent + codes->literal_count, distance_lengths, codes->distance_count);
+    run_length_code(codes, sent, codes->literal_count + codes->distance_count);
+
+    memset(run_counts, 0, sizeof(run_counts));
+
+    for (unsigned int i = 0; i < codes->run_count; ++i)
+    {
+        ++run_counts[codes->runs[i]];
+    }
+
+    if ((result = huffman_code_lengths(run_counts, DEFLATE_LENGTH_SYMBOLS, DEFLATE_MAX_LENGTH_CODE, codes->run_lengths)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    /// inflate TAKES NO INCOMPLETE CODE FOR THE LENGTHS: A SINGLE SYMBOL GETS AN UNUSED PARTNER
+    unsigned int used = 0;
+
+    for (unsigned int symbol = 0; symbol < DEFLATE_LENGTH_SYMBOLS; ++symbol)
+    {
+        used += codes->run_lengths[symbol] != 0;
+    }
+
+    if (used == 1)
+    {
+        codes->run_lengths[codes->run_lengths[0] == 0 ? 0 : 1] = 1;
+    }
+
+    if ((result = lz_canonical_codes(codes->run_lengths, DEFLATE_LENGTH_SYMBOLS, codes->run_codes)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    for (codes->run_length_count = DEFLATE_LENGTH_SYMBOLS; codes->run_length_count > 4 && codes->run_lengths[length_order[codes->run_length_count - 1]] == 0; )
+    {
+        --codes->run_length_count;
+    }
+
+    /// HLIT (5), HDIST (5), HCLEN (4), 3 BITS PER SENT LENGTH OF THE RUN-LENGTH CODE, THEN THE RUNS
+    *header_bits = 14 + 3 * codes->run_length_count;
+
+    for (unsigned int i = 0; i < codes->run_count; ++i)
+    {
+        *header_bits += codes->run_lengths[codes->runs[i]] + run_extra_bits[codes->runs[i]];
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/// SYMBOL COUNTS OF THE TOKENS first TO end (AND OF THE END OF THE BLOCK), bytes RECEIVES THE NUMBER OF
+/// BYTES THEY COVER; GIVES THE NUMBER OF EXTRA BITS OF THEIR LENGTHS AND DISTANCES
+static unsigned long long count_block(const struct lz_tokens * tokens, const unsigned int first, const unsigned int end, unsigned int * counts, unsigned int * bytes)
+{
+    unsigned long long extra_bits = 0;
+    unsigned int bits;
+    unsigned int extra;
+
+    memset(counts, 0, (LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS) * sizeof(unsigned int));
+    ++counts[LZ_END_OF_DATA];
+    *bytes = 0;
+
+    for (unsigned int i = first; i < end; ++i)
+    {
+        const struct lz_token * token = tokens->tokens + i;
+
+        if (token->length == 0)
+        {
+            ++counts[token->value];
+            ++*bytes;
+            continue;
+        }
+
+        ++counts[lz_length_symbol(token->length, &bits, &extra)];
+        extra_bits += bits;
+        ++counts[LZ_LITERAL_SYMBOLS + lz_distance_symbol(token->value, &bits, &extra)];
+        extra_bits += bits;
+        *bytes += token->length;
+    }
+
+    return extra_bits;
+}
+
+static void write_dynamic(struct lz_writer * writer, const struct block_codes * codes, const struct lz_tokens * tokens, const unsigned int first, const unsigned int end, const bool final)
+{
+    unsigned int bits;
+    unsigned int extra;
+
+    /// BFINAL, BTYPE 2 (DYNAMIC CODES)
+    lz_put_bits(writer, final ? 1 : 0, 1);
+    lz_put_bits(writer, 2, 2);
+    lz_put_bits(writer, codes->literal_count - (LZ_END_OF_DATA + 1), 5);
+    lz_put_bits(writer, codes->distance_count - 1, 5);
+    lz_put_bits(writer, codes->run_length_count - 4, 4);
+
+    for (unsigned int i = 0; i < codes->run_length_count; ++i)
+    {
+        lz_put_bits(writer, codes->run_lengths[length_order[i]], 3);
+    }
+
+    for (unsigned int i = 0; i < codes->run_count; ++i)
+    {
+        const unsigned int symbol = codes->runs[i];
+
+        lz_put_bits(writer, codes->run_codes[symbol], codes->run_lengths[symbol]);
+        lz_put_bits(writer, codes->run_values[i], run_extra_bits[symbol]);
+    }
+
+    for (unsigned int i = first; i < end; ++i)
+    {
+        const struct lz_token * token = tokens->tokens + i;
+
+        if (token->length == 0)
+        {
+            lz_put_bits(writer, codes->codes[token->value], codes->lengths[token->value]);
+            continue;
+        }
+
+        const unsigned int length_symbol = lz_length_symbol(token->length, &bits, &extra);
+
+        lz_put_bits(writer, codes->codes[length_symbol], codes->lengths[length_symbol]);
+        lz_put_bits(writer, extra, bits);
+
+        const unsigned int distance_symbol = LZ_LITERAL_SYMBOLS + lz_distance_symbol(token->value, &bits, &extra);
+
+        lz_put_bits(writer, codes->codes[distance_symbol], codes->lengths[distance_symbol]);
+        lz_put_bits(writer, extra, bits);
+    }
+
+    lz_put_bits(writer, codes->codes[LZ_END_OF_DATA], codes->lengths[LZ_END_OF_DATA]);
+}
+
+static void write_stored(struct lz_writer * writer, const unsigned char * data, unsigned int length, const bool final)
+{
+    /// AT LEAST ONE BLOCK, AN EMPTY ONE FOR NO DATA
+    do
+    {
+        const unsigned int part = length < DEFLATE_STORED_MAX ? length : DEFLATE_STORED_MAX;
+
+        /// BFINAL, BTYPE 0 (STORED), THE BYTES START ON A BYTE WITH THEIR LENGTH AND ITS COMPLEMENT
+        lz_put_bits(writer, final && part == length ? 1 : 0, 1);
+        lz_put_bits(writer, 0, 2);
+        lz_put_bits(writer, 0, (8 - writer->count) & 7);
+        lz_put_bits(writer, part, 16);
+        lz_put_bits(writer, ~part & 0xFFFF, 16);
+
+        memcpy(writer->output, data, part);
+        writer->output += part;
+        data += part;
+        length -= part;
+    }
+    while (length != 0);
+}
+
+/// WRITES THE BLOCKS TO output, WHICH HAS ROOM FOR DEFLATE_BOUND(length) BYTES
+static int deflate_into(const unsigned char * data, const unsigned int length, const unsigned int level, unsigned char * output, unsigned int * output_length)
+{
+    struct lz_tokens tokens;
+    struct block_codes codes;
+    unsigned int counts[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    struct lz_writer writer = { output, 0, 0 };
+    unsigned int position = 0;
+    int result;
+
+    if (level != 0)
+    {
+        if ((result = lz_parse(data, length, level, &tokens)) != STATUS_SUCCESS)
+        {
+            return result;
+        }
+    }
+    else if ((tokens.tokens = (struct lz_token *)memory_alloc((length == 0 ? 1 : (size_t)length) * sizeof(struct lz_token))) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+    else
+    {
+        for (unsigned int i = 0; i < length; ++i)
+        {
+            tokens.tokens[i].length = 0;
+            tokens.tokens[i].value = data[i];
+        }
+        tokens.count = length;
+        tokens.capacity = length;
+    }
+
+    for (unsigned int first = 0, end; ; first = end)
+    {
+        unsigned int bytes;
+        unsigned long long header_bits;
+
+        end = tokens.count - first < DEFLATE_BLOCK_TOKENS ? tokens.count : first + DEFLATE_BLOCK_TOKENS;
+
+        const unsigned long long extra_bits = count_block(&tokens, first, end, counts, &bytes);
+
+        if ((result = plan_block(counts, &codes, &header_bits)) != STATUS_SUCCESS)
+        {
+            break;
+        }
+
+        /// THE TYPE, THE HEADER, THE EXTRA BITS AND THE CODES OF THE SYMBOLS
+        unsigned long long bits = 3 + header_bits + extra_bits;
+
+        for (unsigned int symbol = 0; symbol < LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS; ++symbol)
+        {
+            bits += (unsigned long long)counts[symbol] * codes.lengths[symbol];
+        }
+
+        /// TYPE (3), PADDING (AT MOST 7) AND THE LENGTH AND ITS COMPLEMENT (32) FOR EVERY 65535 BYTES
+        if (bits <= (unsigned long long)(bytes / DEFLATE_STORED_MAX + 1) * 42 + 8ULL * bytes)
+        {
+            write_dynamic(&writer, &codes, &tokens, first, end, end == tokens.count);
+        }
+        else
+        {
+            write_stored(&writer, data + position, bytes, end == tokens.count);
+        }
+
+        position += bytes;
+
+        if (end == tokens.count)
+        {
+            break;
+        }
+    }
+
+    /// THE LAST BYTE IS PADDED WITH ZEROS
+    lz_put_bits(&writer, 0, (8 - writer.count) & 7);
+
+    *output_length = (unsigned int)(writer.output - output);
+    clean_lz_tokens(&tokens);
+    return result;
+}
+
+int deflate_compress(const void * data, const unsigned int length, const unsigned int level, void ** output, unsigned int * output_length)
+{
+    if (data == NULL || output == NULL || output_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    int result;
+
+    if (DEFLATE_BOUND(length) > 0xFFFFFFFFULL || (*output = (void *)memory_alloc((size_t)DEFLATE_BOUND(length))) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    if ((result = deflate_into((const unsigned char *)data, length, level, (unsigned char *)*output, output_length)) != STATUS_SUCCESS)
+    {
+        memory_free(*output);
+        *output = NULL;
+    }
+
+    return result;
+}
+
+int gzip_compress(const void * data, const unsigned int length, const unsigned int level, void ** output, unsigned int * output_length)
+{
+    if (data == NULL || output == NULL || output_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    const unsigned long long bound = GZIP_HEADER_SIZE + DEFLATE_BOUND(length) + GZIP_TRAILER_SIZE;
+    unsigned char * bytes;
+    unsigned int deflated;
+    int result;
+
+    if (bound > 0xFFFFFFFFULL || (bytes = (unsigned char *)memory_alloc((size_t)bound)) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    /// MAGIC, METHOD 8 (DEFLATE), NO FLAGS, NO TIME, NO EXTRA FLAGS, UNKNOWN SYSTEM
+    memset(bytes, 0, GZIP_HEADER_SIZE);
+    bytes[0] = 0x1F;
+    bytes[1] = 0x8B;
+    bytes[2] = 8;
+    bytes[9] = 255;
+
+    if ((result = deflate_into((const unsigned char *)data, length, level, bytes + GZIP_HEADER_SIZE, &deflated)) != STATUS_SUCCESS)
+    {
+        memory_free(bytes);
+        return result;
+    }
+
+    store_u32(bytes + GZIP_HEADER_SIZE + deflated, gzip_crc32(0, data, length));
+    store_u32(bytes + GZIP_HEADER_SIZE + deflated + 4, length);
+
+    *output = (void *)bytes;
+    *output_length = GZIP_HEADER_SIZE + deflated + GZIP_TRAILER_SIZE;
+    return STATUS_SUCCESS;
+}
+
+int encode_gzip_file(const char * input_file_name, const char * output_file_name, const unsigned int level)
+{
+    if (input_file_name == NULL || output_file_name == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    void * data;
+    unsigned int length;
+    void * compressed;
+    unsigned int compressed_length;
+    int result;
+
+    if ((result = read_data(input_file_name, &data, &length)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    result = gzip_compress(data, length, level, &compressed, &compressed_length);
+    memory_free(data);
+
+    if (result == STATUS_SUCCESS)
+    {
+        result = write_data(output_file_name, compressed, compressed_length);
+        memory_free(compressed);
+    }
+
+    return result;
+}
@@ -0,0 +1,82 @@
+#ifndef _DEFLATE_H_
+#define _DEFLATE_H_
+#include <stddef.h>
+
+/// TOKENS PER BLOCK, EVERY BLOCK GETS CODES OF ITS OWN (THE BUFFER OF zlib)
+#define DEFLATE_BLOCK_TOKENS (1 << 14)
+
+/// BYTES OF A STORED BLOCK AT MOST
+#define DEFLATE_STORED_MAX 65535
+
+/// THE CODE LENGTHS ARE RUN-LENGTH CODED WITH 19 SYMBOLS (16 REPEATS THE LAST LENGTH, 17 / 18 ARE RUNS OF
+/// ZEROS), WHOSE CODES ARE AT MOST 7 BITS
+#define DEFLATE_LENGTH_SYMBOLS     19
+#define DEFLATE_MAX_LENGTH_CODE    7
+
+/// MAGIC (2), METHOD (1), FLAGS (1), TIME (4), EXTRA FLAGS (1), SYSTEM (1); CRC-32 (4) AND SIZE (4) AFTER THE BLOCKS
+#define GZIP_HEADER_SIZE  10
+#define GZIP_TRAILER_SIZE 8
+
+/// A BLOCK IS NEVER LARGER THAN ITS BYTES STORED, WHICH COST AT MOST 6 BYTES PER 65535
+#define DEFLATE_BOUND(length) ((unsigned long long)(length) + (length) / 1024 + 64)
+
+/**
+*   @PARAMS
+*   crc    - CRC-32 of the bytes before, 0 for the first ones
+*   data   - Memory address of data
+*   length - In bytes
+*
+*   @RETURN
+*   The CRC-32 of gzip / zlib of the bytes before and data
+*/
+unsigned int gzip_crc32(const unsigned int crc, const void * data, const size_t length);
+
+/**
+*   Raw DEFLATE (RFC 1951) of data, readable by any inflate. Every
+*   DEFLATE_BLOCK_TOKENS tokens are a block with dynamic Huffman codes: their
+*   lengths come from huffman_code_lengths, limited to 15 bits, and are sent
+*   run-length coded. A block whose codes would not beat its stored bytes is
+*   stored instead. Level 0 codes the bytes as literals only, levels 1 to 9
+*   code the matches of lz_parse as well.
+*
+*   @PARAMS
+*   data          - Memory address of data
+*   length        - In bytes
+*   level         - 0 for literals only, otherwise the level of lz_parse
+*   output        - Receives the blocks (allocated)
+*   output_length - Receives the size of the blocks in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the tokens, the codes or the output
+*   STATUS_SUCCESS   - output holds the blocks
+*/
+int deflate_compress(const void * data, const unsigned int length, const unsigned int level, void ** output, unsigned int * output_length);
+
+/**
+*   deflate_compress wrapped in a gzip member (RFC 1952): the header without a
+*   name or time, the blocks, then the CRC-32 and the size of the data.
+*
+*   @PARAMS
+*   Same as deflate_compress
+*
+*   @RETURN
+*   Same as deflate_compress
+*/
+int gzip_compress(const void * data, const unsigned int length, const unsigned int level, void ** output, unsigned int * output_length);
+
+/**
+*   Compresses a file to a gzip file, see gzip_compress.
+*
+*   @PARAMS
+*   input_file_name  - Path of the data
+*   output_file_name - Path of the gzip file
+*   level            - Level of gzip_compress
+*
+*   @RETURN
+*   FILE_ERROR       - A file could not be read / written
+*   Otherwise the same as gzip_compress
+*/
+int encode_gzip_file(const char * input_file_name, const char * output_file_name, const unsigned int level);
+
+#endif // _DEFLATE_H_
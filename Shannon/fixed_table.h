@@ -0,0 +1,185 @@
+#ifndef _FIXED_TABLE_H_
+#define _FIXED_TABLE_H_
+#include "hash_table.h"
+#include "allocator.h"
+#include "utilities.h"
+#include "stats.h"
+
+/// FIBONACCI HASHING OF AN INTEGER KEY, THE HIGH BITS OF THE PRODUCT DEPEND ON EVERY BIT OF IT
+#define FIXED_HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+/// SLOTS OF A NEW TABLE (A POWER OF 2), THE TABLE DOUBLES WHEN HALF OF THEM ARE TAKEN
+#define FIXED_TABLE_BITS 12
+
+/**
+*   Generates a counting table specialized for keys of at most
+*   sizeof(KEY_TYPE) bytes, the fixed-width counterpart of hash_table.h: the
+*   bytes of a key are packed into an integer, the first byte in the lowest
+*   bits (NAME##_pack), which is hashed and compared as an integer in an
+*   open-addressing table with linear probing. The keys and the
+*   totals are two flat arrays, a slot with a total of 0 is free. Every
+*   function is inlined where it is used, no function pointer is called and
+*   no memcmp runs on the way to a counter. Defines:
+*
+*   struct NAME##_table
+*   int  NAME##_create(table)                               - like create_table
+*   KEY  NAME##_pack(bytes, width)                          - key of the width bytes at bytes
+*   int  NAME##_add(table, key, count)                      - like add_counted_element
+*   int  NAME##_export(table, destination, width, hash_fun) - adds every key (width bytes)
+*                                                              to a generic table, so the
+*                                                              entropy and Huffman functions
+*                                                              read it unchanged
+*   void NAME##_clean(table)                                - like clean_table
+*/
+#define DEFINE_FIXED_TABLE(NAME, KEY_TYPE)                                                                          \
+                                                                                                                    \
+struct NAME##_table                                                                                                 \
+{                                                                                                                   \
+    unsigned int element_count;                                                                                     \
+    unsigned int sample_count;                                                                                      \
+                                                                                                                    \
+    /* 2 ^ bits SLOTS */                                                                                            \
+    unsigned int bits;                                                                                              \
+    KEY_TYPE * keys;                                                                                                \
+    unsigned int * totals;                                                                                          \
+};                                                                                                                  \
+                                                                                                                    \
+static inline int NAME##_allocate(struct NAME##_table * const table, const unsigned int bits)                      \
+{                                                                                                                   \
+    table->keys = (KEY_TYPE *)memory_alloc(((size_t)1 << bits) * sizeof(KEY_TYPE));                                 \
+    table->totals = (unsigned int *)memory_calloc((size_t)1 << bits, sizeof(unsigned int));                        \
+                                                                                                                    \
+    if (table->keys == NULL || table->totals == NULL)                                                               \
+    {                                                                                                               \
+        memory_free(table->keys);                                                                                   \
+        memory_free(table->totals);                                                                                 \
+        table->keys = NULL;                                                                                         \
+        table->totals = NULL;                                                                                       \
+        return BAD_MEMORY_ALLOC;                                                                                    \
+    }                                                                                                               \
+                                                                                                                    \
+    table->bits = bits;                                                                                             \
+    return STATUS_SUCCESS;                                                                                          \
+}                                                                                                                   \
+                                                                                                                    \
+static inline int NAME##_create(struct NAME##_table * const table)                                                 \
+{                                                                                                                   \
+    if (table == NULL)                                                                                              \
+    {                                                                                                               \
+        return NULL_ARGUMENT;                                                                                       \
+    }                                                                                                               \
+                                                                                                                    \
+    table->element_count = 0;                                                                                       \
+    table->sample_count = 0;                                                                                        \
+    return NAME##_allocate(table, FIXED_TABLE_BITS);                                                                \
+}                                                                                                                   \
+                                                                                                                    \
+static inline size_t NAME##_slot(const KEY_TYPE key, const unsigned int bits)                                      \
+{                                                                                                                   \
+    return (size_t)(((unsigned long long)key * FIXED_HASH_MULTIPLIER) >> (64 - bits));                             \
+}                                                                                                                   \
+                                                                                                                    \
+static inline void NAME##_place(struct NAME##_table * const table, const KEY_TYPE key, const unsigned int total)   \
+{                                                                                                                   \
+    const size_t mask = ((size_t)1 << table->bits) - 1;                                                             \
+    size_t slot = NAME##_slot(key, table->bits);                                                                    \
+                                                                                                                    \
+    while (table->totals[slot] != 0)                                                                                \
+    {                                                                                                               \
+        slot = (slot + 1) & mask;                                                                                   \
+    }                                                                                                               \
+                                                                                                                    \
+    table->keys[slot] = key;                                                                                        \
+    table->totals[slot] = total;                                                                                    \
+}                                                                                                                   \
+                                                                                                                    \
+static inline int NAME##_grow(struct NAME##_table * const table)                                                   \
+{                                                                                                                   \
+    struct NAME##_table old = *table;                                                                               \
+                                                                                                                    \
+    if (NAME##_allocate(table, old.bits + 1) != STATUS_SUCCESS)                                                     \
+    {                                                                                                               \
+        *table = old;                                                                                               \
+        return BAD_MEMORY_ALLOC;                                                                                    \
+    }                                                                                                               \
+                                                                                                                    \
+    for (size_t slot = 0; slot < (size_t)1 << old.bits; ++slot)                                                     \
+    {                                                                                                               \
+        if (old.totals[slot] != 0)                                                                                  \
+        {                                                                                                           \
+            NAME##_place(table, old.keys[slot], old.totals[slot]);                                                  \
+        }                                                                                                           \
+    }                                                                                                               \
+                                                                                                                    \
+    memory_free(old.keys);                                                                                          \
+    memory_free(old.totals);                                                                                        \
+    return STATUS_SUCCESS;                                                                                          \
+}                                                                                                                   \
+                                                                                                                    \
+static inline int NAME##_add(struct NAME##_table * const table, const KEY_TYPE key, const unsigned int count)     \
+{                                                                                                                   \
+    const size_t mask = ((size_t)1 << table->bits) - 1;                                                             \
+    size_t slot = NAME##_slot(key, table->bits);                                                                    \
+                                                                                                                    \
+    STATS_ADD(hash_lookups, 1);                                                                                     \
+    table->sample_count += count;                                                                                   \
+                                                                                                                    \
+    while (table->totals[slot] != 0)                                                                                \
+    {                                                                                                               \
+        if (table->keys[slot] == key)                                                                               \
+        {                                                                                                           \
+            table->totals[slot] += count;                                                                           \
+            return STATUS_SUCCESS;                                                                                  \
+        }                                                                                                           \
+        slot = (slot + 1) & mask;                                                                                   \
+    }                                                                                                               \
+                                                                                                                    \
+    table->keys[slot] = key;                                                                                        \
+    table->totals[slot] = count;                                                                                    \
+                                                                                                                    \
+    /* AT MOST HALF OF THE SLOTS ARE TAKEN, SO A FREE ONE IS ALWAYS CLOSE */                                        \
+    return ++table->element_count > mask / 2 ? NAME##_grow(table) : STATUS_SUCCESS;                                 \
+}                                                                                                                   \
+                                                                                                                    \
+static inline KEY_TYPE NAME##_pack(const unsigned char * const bytes, const unsigned int width)                   \
+{                                                                                                                   \
+    KEY_TYPE key = 0;                                                                                               \
+                                                                                                                    \
+    for (unsigned int i = width; i > 0; --i)                                                                        \
+    {                                                                                                               \
+        key = key << 8 | bytes[i - 1];                                                                              \
+    }                                                                                                               \
+    return key;                                                                                                     \
+}                                                                                                                   \
+                                                                                                                    \
+static inline int NAME##_export(const struct NAME##_table * const table, struct hash_table * const destination,   \
+                                const unsigned int width, int (*hash_fun)(const void * const, unsigned int))       \
+{                                                                                                                   \
+    int result = STATUS_SUCCESS;                                                                                    \
+                                                                                                                    \
+    for (size_t slot = 0; slot < (size_t)1 << table->bits && result == STATUS_SUCCESS; ++slot)                      \
+    {                                                                                                               \
+        if (table->totals[slot] != 0)                                                                               \
+        {                                                                                                           \
+            unsigned char bytes[sizeof(KEY_TYPE)];                                                                  \
+                                                                                                                    \
+            for (unsigned int i = 0; i < width; ++i)                                                                \
+            {                                                                                                       \
+                bytes[i] = (unsigned char)(table->keys[slot] >> 8 * i);                                             \
+            }                                                                                                       \
+                                                                                                                    \
+            result = add_counted_element(destination, bytes, width, table->totals[slot], hash_fun, seq_cmp);        \
+        }                                                                                                           \
+    }                                                                                                               \
+    return result;                                                                                                  \
+}                                                                                                                   \
+                                                                                                                    \
+static inline void NAME##_clean(struct NAME##_table * const table)                                                 \
+{                                                                                                                   \
+    memory_free(table->keys);                                                                                       \
+    memory_free(table->totals);                                                                                     \
+    table->keys = NULL;                                                                                             \
+    table->totals = NULL;                                                                                           \
+}
+
+#endif // _FIXED_TABLE_H_
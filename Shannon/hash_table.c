@@ -1,13 +1,17 @@
 #include "hash_table.h"
 #include "avl_tree.h"
+#include "heap.h"
 #include "utilities.h"
+#include "allocator.h"
+#include "stats.h"
+#include "kernels.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 int seq_cmp(const void * const sequence_one, const unsigned int sz_one, const void * const sequence_two, const unsigned int sz_two)
 {
-    int cmp = memcmp(sequence_one, sequence_two, sz_one < sz_two ? sz_one : sz_two);
+    int cmp = cpu_kernels()->compare(sequence_one, sequence_two, sz_one < sz_two ? sz_one : sz_two);
 
     if (cmp != 0)
     {
@@ -44,6 +48,66 @@ int hash_code(const void * const sequence, unsigned int sz)
     return sum;
 }
 
+/// RABIN-KARP BASE, THE HASH IS TAKEN MODULO 2^32
+#define ROLLING_BASE 257u
+
+static unsigned int mix_hash(unsigned int value)
+{
+    /// FINALIZER SO THAT THE LOW BITS DEPEND ON THE WHOLE WINDOW
+    value ^= value >> 16;
+    value *= 0x85EBCA6Bu;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35u;
+    value ^= value >> 16;
+    return value;
+}
+
+int rolling_hash_init(struct rolling_hash * rolling, const void * const sequence, const unsigned int window)
+{
+    if (rolling == NULL || sequence == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    rolling->value = 0;
+    rolling->power = 1;
+    rolling->window = window;
+
+    for (unsigned int i = 0; i < window; ++i)
+    {
+        rolling->value = rolling->value * ROLLING_BASE + *((const unsigned char *)sequence + i);
+
+        if (i != 0)
+        {
+            rolling->power *= ROLLING_BASE;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+void rolling_hash_roll(struct rolling_hash * rolling, const unsigned char outgoing, const unsigned char incoming)
+{
+    rolling->value = (rolling->value - outgoing * rolling->power) * ROLLING_BASE + incoming;
+}
+
+int rolling_hash_code(const struct rolling_hash * const rolling)
+{
+    return (int)mix_hash(rolling->value);
+}
+
+int window_hash_code(const void * const sequence, unsigned int sz)
+{
+    struct rolling_hash rolling;
+
+    if (rolling_hash_init(&rolling, sequence, sz) != STATUS_SUCCESS)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    return rolling_hash_code(&rolling);
+}
+
 struct node * const find_by_kv(const struct hash_table* const table, const void * const element, const unsigned int length, int (*hash_fun)(const void * const seq, unsigned int sz), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
 {
     if (table == NULL || table->trees == NULL || element == NULL)
@@ -61,6 +125,7 @@ struct avl_tree * const find_by_key(const struct hash_table* const table, const
         return NULL;
     }
 
+    STATS_ADD(hash_lookups, 1);
     return table->trees + hash_fun(element, length) % table->table_size;
 }
 
@@ -91,13 +156,212 @@ int create_table(struct hash_table* table, const unsigned int table_size)
         return NULL_ARGUMENT;
     }
 
-    if ((table->trees = (struct avl_tree *)calloc(table_size, sizeof(struct avl_tree))) == NULL)
+    if ((table->trees = (struct avl_tree *)memory_calloc(table_size, sizeof(struct avl_tree))) == NULL)
     {
         return BAD_MEMORY_ALLOC;
     }
 
     table->table_size = table_size;
     table->element_count = 0;
+    table->sample_count = 0;
+    table->capacity = 0;
+    table->other_count = 0;
+    table->deducted_count = 0;
+    table->error_bound = 0;
+
+    return STATUS_SUCCESS;
+}
+
+int create_bounded_table(struct hash_table* table, const unsigned int table_size, const unsigned int capacity)
+{
+    int result = create_table(table, table_size);
+
+    if (result == STATUS_SUCCESS)
+    {
+        /// 2 * capacity MUST FIT IN element_count
+        table->capacity = capacity > 0x7FFFFFFFU ? 0x7FFFFFFFU : capacity;
+    }
+
+    return result;
+}
+
+static int compare_totals(const void * first, const void * second)
+{
+    const unsigned int one = *(const unsigned int *)first;
+    const unsigned int two = *(const unsigned int *)second;
+    return (one < two) - (one > two);
+}
+
+static unsigned int gather_totals(const struct node * const node, unsigned int * totals, unsigned int count)
+{
+    if (node != NULL)
+    {
+        totals[count++] = node->info.total;
+        count = gather_totals(node->left_child, totals, count);
+        count = gather_totals(node->right_child, totals, count);
+    }
+    return count;
+}
+
+/// TAKES decrement FROM EVERY TOTAL, KEEPS THE NODES THAT ARE LEFT WITH SOMETHING IN ORDER AND FREES THE OTHERS
+static unsigned int prune_nodes(struct node * node, struct node ** kept, unsigned int count, const unsigned int decrement, unsigned int * pruned)
+{
+    if (node != NULL)
+    {
+        struct node * right = node->right_child;
+
+        count = prune_nodes(node->left_child, kept, count, decrement, pruned);
+
+        if (node->info.total > decrement)
+        {
+            node->info.total -= decrement;
+            kept[count++] = node;
+        }
+        else
+        {
+            *pruned += node->info.total;
+            destroy_node(&node);
+        }
+
+        count = prune_nodes(right, kept, count, decrement, pruned);
+    }
+    return count;
+}
+
+/// BUILDS A TREE OF MINIMAL HEIGHT FROM NODES SORTED BY KEY, RETURNS ITS HEIGHT
+static int build_balanced(struct node ** root, struct node ** nodes, const unsigned int count)
+{
+    if (count == 0)
+    {
+        *root = NULL;
+        return 0;
+    }
+
+    const unsigned int middle = count / 2;
+    *root = nodes[middle];
+
+    const int left = build_balanced(&(*root)->left_child, nodes, middle);
+    const int right = build_balanced(&(*root)->right_child, nodes + middle + 1, count - middle - 1);
+    (*root)->bal = left - right;
+
+    return (left < right ? right : left) + 1;
+}
+
+/// ONE ROUND OF THE BOUNDED MODE (SEE create_bounded_table)
+static int reduce_table(struct hash_table* table)
+{
+    unsigned int * totals = (unsigned int *)memory_alloc(table->element_count * sizeof(unsigned int));
+
+    if (totals == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < table->table_size; ++i)
+    {
+        count = gather_totals((table->trees + i)->root, totals, count);
+    }
+
+    /// THE (capacity + 1)-TH LARGEST TOTAL
+    qsort(totals, count, sizeof(unsigned int), compare_totals);
+    const unsigned int decrement = totals[table->capacity];
+    memory_free(totals);
+
+    struct node ** kept = (struct node **)memory_alloc(table->element_count * sizeof(struct node *));
+
+    if (kept == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    unsigned int pruned = 0;
+    table->element_count = 0;
+
+    for (unsigned int i = 0; i < table->table_size; ++i)
+    {
+        struct avl_tree * tree = table->trees + i;
+
+        count = prune_nodes(tree->root, kept, 0, decrement, &pruned);
+        build_balanced(&tree->root, kept, count);
+
+        tree->total = count;
+        table->element_count += count;
+    }
+
+    memory_free(kept);
+
+    /// EVERY SURVIVOR LOST decrement AS WELL, IT STAYS COUNTED IN sample_count THROUGH deducted_count
+    table->other_count += pruned;
+    table->deducted_count += table->element_count * decrement;
+    table->error_bound += decrement;
+
+    return STATUS_SUCCESS;
+}
+
+static int grow_table(struct hash_table* table)
+{
+    ++table->element_count;
+
+    if (table->capacity != 0 && table->element_count >= 2 * table->capacity)
+    {
+        return reduce_table(table);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int trim_table(struct hash_table* table)
+{
+    if (table == NULL || table->trees == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (table->capacity != 0 && table->element_count > table->capacity)
+    {
+        return reduce_table(table);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int fold_other(struct hash_table* table, const void * const key, const unsigned int length, int (*hash_fun)(const void * const, unsigned int), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
+{
+    if (table == NULL || table->trees == NULL || key == NULL || hash_fun == NULL || compare == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (table->other_count == 0)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    struct node * found = find_by_kv(table, key, length, hash_fun, compare);
+
+    if (found == NULL)
+    {
+        int result = add_to_tree(table->trees + hash_fun(key, length) % table->table_size, key, length, compare);
+
+        if (result != STATUS_SUCCESS)
+        {
+            return result;
+        }
+
+        ++table->element_count;
+
+        if ((found = find_by_kv(table, key, length, hash_fun, compare)) == NULL)
+        {
+            return NULL_RESULT;
+        }
+
+        /// add_to_tree ALREADY COUNTED ONE OCCURRENCE
+        --found->info.total;
+    }
+
+    found->info.total += table->other_count;
+    table->other_count = 0;
 
     return STATUS_SUCCESS;
 }
@@ -121,7 +385,7 @@ int clean_table(struct hash_table* table)
             }
         }
 
-        free(table->trees);
+        memory_free(table->trees);
         table->trees = NULL;
     }
 
@@ -135,6 +399,8 @@ int add_element(struct hash_table* table, const void * const element, const unsi
         return NULL_ARGUMENT;
     }
 
+    ++table->sample_count;
+
     {
         struct node * const is_found = find_by_kv(table, element, length, hash_fun, compare);
 
@@ -149,12 +415,232 @@ int add_element(struct hash_table* table, const void * const element, const unsi
 
     if (result == STATUS_SUCCESS)
     {
-        ++table->element_count;
+        result = grow_table(table);
+    }
+
+    return result;
+}
+
+int add_hashed_element(struct hash_table* table, const void * const element, const unsigned int length, const int hash, int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
+{
+    if (table == NULL || table->trees == NULL || compare == NULL || element == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct avl_tree * tree = table->trees + (unsigned int)hash % table->table_size;
+
+    ++table->sample_count;
+    STATS_ADD(hash_lookups, 1);
+
+    {
+        struct node * const is_found = find_by_value(tree, element, length, compare);
+
+        if (is_found != NULL)
+        {
+            ++is_found->info.total;
+            return STATUS_SUCCESS;
+        }
+    }
+
+    int result = add_to_tree(tree, element, length, compare);
+
+    if (result == STATUS_SUCCESS)
+    {
+        result = grow_table(table);
     }
 
     return result;
 }
 
+int add_counted_element(struct hash_table* table, const void * const element, const unsigned int length, const unsigned int count, int (*hash_fun)(const void * const, unsigned int), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
+{
+    if (table == NULL || hash_fun == NULL || table->trees == NULL || compare == NULL || element == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (count == 0)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    table->sample_count += count;
+
+    struct node * found = find_by_kv(table, element, length, hash_fun, compare);
+
+    if (found == NULL)
+    {
+        int result = add_to_tree(table->trees + hash_fun(element, length) % table->table_size, element, length, compare);
+
+        if (result != STATUS_SUCCESS)
+        {
+            return result;
+        }
+
+        if ((found = find_by_kv(table, element, length, hash_fun, compare)) == NULL)
+        {
+            return NULL_RESULT;
+        }
+
+        /// add_to_tree ALREADY COUNTED ONE OCCURRENCE
+        found->info.total += count - 1;
+
+        return grow_table(table);
+    }
+    else
+    {
+        found->info.total += count;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+static int merge_nodes(struct hash_table* destination, const struct node * const node, int (*hash_fun)(const void * const, unsigned int), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
+{
+    if (node == NULL)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    int result = add_counted_element(destination, node->info.sequence, node->info.length, node->info.total, hash_fun, compare);
+
+    if (result != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    if ((result = merge_nodes(destination, node->left_child, hash_fun, compare)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    return merge_nodes(destination, node->right_child, hash_fun, compare);
+}
+
+int merge_table(struct hash_table* destination, const struct hash_table* const source, int (*hash_fun)(const void * const, unsigned int), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int))
+{
+    if (destination == NULL || source == NULL || source->trees == NULL || hash_fun == NULL || compare == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    int result;
+    for (unsigned int i = 0; i < source->table_size; ++i)
+    {
+        if ((result = merge_nodes(destination, (source->trees + i)->root, hash_fun, compare)) != STATUS_SUCCESS)
+        {
+            return result;
+        }
+    }
+
+    destination->sample_count += source->other_count + source->deducted_count;
+    destination->other_count += source->other_count;
+    destination->deducted_count += source->deducted_count;
+    destination->error_bound += source->error_bound;
+
+    return STATUS_SUCCESS;
+}
+
+/// HEAP ORDER OF top_k: THE SMALLER TOTAL, THEN THE LATER KEY, IS THE WEAKER ELEMENT
+static int compare_ranks(const void * const first, const void * const second)
+{
+    const struct node * const one = (const struct node *)first;
+    const struct node * const two = (const struct node *)second;
+
+    if (one->info.total != two->info.total)
+    {
+        return one->info.total < two->info.total ? -1 : 1;
+    }
+
+    return seq_cmp(two->info.sequence, two->info.length, one->info.sequence, one->info.length);
+}
+
+static int rank_nodes(struct heap * heap, const struct node * const node, const unsigned int k)
+{
+    if (node == NULL)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    int result;
+
+    if (heap->element_count < k)
+    {
+        result = heap->push(heap, (void *)node);
+    }
+    else if (compare_ranks(node, *heap->elements) > 0)
+    {
+        void * weakest;
+
+        if ((result = heap->pop(heap, &weakest)) == STATUS_SUCCESS)
+        {
+            result = heap->push(heap, (void *)node);
+        }
+    }
+    else
+    {
+        result = STATUS_SUCCESS;
+    }
+
+    if (result != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    if ((result = rank_nodes(heap, node->left_child, k)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    return rank_nodes(heap, node->right_child, k);
+}
+
+int top_k(const struct hash_table * const table, const unsigned int k, const struct node ** ranked)
+{
+    if (table == NULL || table->trees == NULL || ranked == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (k == 0)
+    {
+        return 0;
+    }
+
+    struct heap heap;
+    int result = create_heap(&heap, sizeof(struct node), WEAK_COLLECTION, print, compare_ranks);
+
+    for (unsigned int i = 0; i < table->table_size && result == STATUS_SUCCESS; ++i)
+    {
+        result = rank_nodes(&heap, (table->trees + i)->root, k);
+    }
+
+    if (result != STATUS_SUCCESS)
+    {
+        clean_heap(&heap);
+        return result;
+    }
+
+    /// THE HEAP GIVES THE WEAKEST FIRST, THE LIST IS FILLED FROM ITS END
+    const unsigned int count = heap.element_count;
+
+    for (unsigned int i = count; i > 0; --i)
+    {
+        void * node;
+
+        if ((result = heap.pop(&heap, &node)) != STATUS_SUCCESS)
+        {
+            clean_heap(&heap);
+            return result;
+        }
+
+        ranked[i - 1] = (const struct node *)node;
+    }
+
+    return (int)count;
+}
+
 void print_table(struct hash_table* table, void (*printer)(const struct node * const))
 {
     if (table != NULL && table->trees != NULL)
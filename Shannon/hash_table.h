@@ -7,11 +7,27 @@ struct hash_table
     /// NUMBER OF ELEMENTS IN THE TABLE
     unsigned int element_count;
 
+    /// NUMBER OF OCCURRENCES ADDED (SUM OF THE TOTALS)
+    unsigned int sample_count;
+
     /// THE SIZE OF THE HASH TABLE
     unsigned int table_size;
 
     /// THE TREES CONTAINED
     struct avl_tree* trees;
+
+    /// BOUNDED MODE (0 = UNBOUNDED): THE ELEMENTS ARE PRUNED WHEN THERE ARE 2 * capacity OF THEM
+    unsigned int capacity;
+
+    /// OCCURRENCES OF THE PRUNED ELEMENTS
+    unsigned int other_count;
+
+    /// OCCURRENCES TAKEN FROM THE TOTALS OF THE ELEMENTS THAT SURVIVED A ROUND OF THE BOUNDED MODE,
+    /// sample_count IS THE SUM OF THE TOTALS PLUS other_count PLUS deducted_count
+    unsigned int deducted_count;
+
+    /// A TOTAL OF THE BOUNDED MODE IS AT MOST error_bound BELOW THE TRUE COUNT
+    unsigned int error_bound;
 };
 
 /**
@@ -25,6 +41,63 @@ struct hash_table
 */
 int hash_code(const void * const sequence, unsigned int sz);
 
+struct rolling_hash
+{
+    /// HASH OF THE CURRENT WINDOW
+    unsigned int value;
+
+    /// BASE ^ (WINDOW - 1), USED TO DROP THE OUTGOING BYTE
+    unsigned int power;
+
+    /// THE LENGTH OF THE WINDOW IN BYTES
+    unsigned int window;
+};
+
+/**
+*   @PARAMS
+*   rolling  - Memory address of the rolling hash
+*   sequence - Memory address of the first window
+*   window   - Size of the window in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT  - rolling or sequence is NULL
+*   STATUS_SUCCESS - The hash of the first window was computed
+*/
+int rolling_hash_init(struct rolling_hash * rolling, const void * const sequence, const unsigned int window);
+
+/**
+*   Slides the window one byte to the right in O(1).
+*
+*   @PARAMS
+*   rolling  - Memory address of the rolling hash
+*   outgoing - The byte that leaves the window (first byte of it)
+*   incoming - The byte that enters the window (right after its end)
+*/
+void rolling_hash_roll(struct rolling_hash * rolling, const unsigned char outgoing, const unsigned char incoming);
+
+/**
+*   @PARAMS
+*   rolling - Memory address of the rolling hash
+*
+*   @RETURN
+*   Hash-code of the current window, mixed so that it can be reduced modulo the table size
+*/
+int rolling_hash_code(const struct rolling_hash * const rolling);
+
+/**
+*   Hashes a sequence from scratch with the same function the rolling hash uses,
+*   so tables filled through rolling hashes can be queried with find_by_kv.
+*
+*   @PARAMS
+*   sequence - Memory address of data
+*         sz - In bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT - sequence is NULL
+*   Hash-code
+*/
+int window_hash_code(const void * const sequence, unsigned int sz);
+
 /**
 *   @PARAMS
 *   sequence_one - Memory address of the first sequence
@@ -79,6 +152,70 @@ struct avl_tree * const find_by_key(const struct hash_table* const table, const
 */
 int create_table(struct hash_table* table, const unsigned int table_size);
 
+/**
+*   Creates a table that keeps the frequent elements in bounded memory
+*   (Misra-Gries summary). When an insert makes 2 * capacity elements, the
+*   (capacity + 1)-th largest total d is taken from every total and the
+*   elements left with nothing are removed, their occurrences go to
+*   other_count. What the survivors lose goes to deducted_count, it belongs
+*   to them and not to the removed elements. At most capacity elements
+*   survive a round (trim_table ends with the same) and at least
+*   capacity + 1 totals lose d, so:
+*       true count - error_bound <= total <= true count
+*       error_bound <= sample_count / (capacity + 1)
+*   and every element more frequent than sample_count / (capacity + 1) is in
+*   the table. A round is paid by the capacity inserts before it, the add
+*   functions stay O(log n) amortized. merge_table merges bounded tables
+*   into a summary with the same guarantees.
+*
+*   @PARAMS
+*   table      - Memory address of data
+*   table_size - Number of trees
+*   capacity   - Number of frequent elements that are tracked, 0 for unbounded
+*
+*   @RETURN
+*   BAD_MEMORY_ALLOC - Could not allocate memory for the trees
+*   NULL_ARGUMENT    - Argument table is NULL
+*   STATUS_SUCCESS   - Hash table successfully created
+*/
+int create_bounded_table(struct hash_table* table, const unsigned int table_size, const unsigned int capacity);
+
+/**
+*   Ends the counting of a bounded table: between two rounds it holds up to
+*   2 * capacity - 1 elements, so one more round is made when there are more
+*   than capacity, with the same guarantees. Nothing is done to an unbounded
+*   table.
+*
+*   @PARAMS
+*   table - Memory address of data
+*
+*   @RETURN
+*   NULL_ARGUMENT    - Argument table is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate memory for the round
+*   STATUS_SUCCESS   - At most capacity elements are left
+*/
+int trim_table(struct hash_table* table);
+
+/**
+*   Adds the occurrences of other_count as the element key (the "other"
+*   bucket), so the consumers of the totals (table_huffman_tree) see the
+*   pruned samples. key should not be a possible element, else the bucket
+*   adds up with it. sample_count and deducted_count do not change.
+*
+*   @PARAMS
+*   table    - Memory address of data
+*   key      - The element that stands for the pruned ones
+*   length   - In bytes
+*   hash_fun - Hash function
+*   compare  - Comparison function
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate memory for the bucket
+*   STATUS_SUCCESS   - Bucket added (or nothing was pruned), other_count is 0
+*/
+int fold_other(struct hash_table* table, const void * const key, const unsigned int length, int (*hash_fun)(const void * const seq, unsigned int sz), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int));
+
 /**
 *   @PARAMS
 *   table    - Memory address of data
@@ -96,6 +233,61 @@ int create_table(struct hash_table* table, const unsigned int table_size);
 */
 int add_element(struct hash_table* table, const void * const element, const unsigned int length, int (*hash_fun)(const void * const seq, unsigned int sz), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int));
 
+/**
+*   Same as add_element, but the hash-code was already computed by the caller
+*   (e.g. by a rolling hash). The element is still verified against the stored
+*   keys of the bucket with the comparison function.
+*
+*   @PARAMS
+*   table    - Memory address of data
+*   element  - New element to be added
+*   length   - In bytes
+*   hash     - Precomputed hash-code of the element
+*   compare  - Comparison function
+*
+*   @RETURN
+*   NULL_ARGUMENT    - Argument table, trees, element or compare is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate memory for the new element
+*   STATUS_SUCCESS   - Element successfully added
+*/
+int add_hashed_element(struct hash_table* table, const void * const element, const unsigned int length, const int hash, int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int));
+
+/**
+*   Same as add_element, but the element is counted count times at once.
+*
+*   @PARAMS
+*   table    - Memory address of data
+*   element  - New element to be added
+*   length   - In bytes
+*   count    - Number of occurrences to add
+*   hash_fun - Hash function
+*   compare  - Comparison function
+*
+*   @RETURN
+*   NULL_ARGUMENT    - Argument table, trees, element, hash_fun or compare is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate memory for the new element
+*   STATUS_SUCCESS   - Element successfully added
+*/
+int add_counted_element(struct hash_table* table, const void * const element, const unsigned int length, const unsigned int count, int (*hash_fun)(const void * const seq, unsigned int sz), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int));
+
+/**
+*   Adds every element of source to destination, summing the totals of the
+*   elements present in both. The tables may have different sizes. The
+*   other_count and error_bound of source are added to those of destination.
+*
+*   @PARAMS
+*   destination - The table that receives the elements
+*   source      - The table whose elements are added (left unchanged)
+*   hash_fun    - Hash function of the destination
+*   compare     - Comparison function
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate memory for a new element
+*   STATUS_SUCCESS   - Tables successfully merged
+*/
+int merge_table(struct hash_table* destination, const struct hash_table* const source, int (*hash_fun)(const void * const seq, unsigned int sz), int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int));
+
 /**
 *   @PARAMS
 *   table   - Memory address of data
@@ -106,6 +298,25 @@ int add_element(struct hash_table* table, const void * const element, const unsi
 */
 int clean_table(struct hash_table* table);
 
+/**
+*   Finds the k elements with the largest totals with a min-heap of at most k
+*   nodes (heap.h): every node of the table is compared once with the
+*   smallest of the heap, so it takes O(n log k) time and O(k) memory instead
+*   of sorting the table. Equal totals are ranked in the order of seq_cmp.
+*
+*   @PARAMS
+*   table  - Frequency table
+*   k      - Number of elements wanted
+*   ranked - Receives at most k nodes of the table, the largest total first;
+*            they are valid until the table changes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - table or ranked is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the heap
+*   >= 0             - Number of nodes written to ranked (k or fewer)
+*/
+int top_k(const struct hash_table * const table, const unsigned int k, const struct node ** ranked);
+
 void print_table(struct hash_table* table, void (*printer)(const struct node * const));
 
 struct node * const find_first_by_value(const struct hash_table * const table, const void * const element, const unsigned int length, int (*compare)(const void * const, const unsigned int, const void * const, const unsigned int));
@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include "node.h"
 #include "heap.h"
+#include "allocator.h"
+#include "stats.h"
 
 #define SWAP_VOID(a, b) \
 (*(a)) = (void *)((uintptr_t)*(a) ^ (uintptr_t)*(b));\
@@ -64,7 +66,7 @@ int push_weak(struct heap * const heap, void ** const heap_node, void * const da
 {
     if (heap->weak_pointer == DEEP_COLLECTION)
     {
-        if ((*heap_node = (void *)malloc(heap->element_size)) == NULL)
+        if ((*heap_node = (void *)memory_alloc(heap->element_size)) == NULL)
         {
             return BAD_MEMORY_ALLOC;
         }
@@ -85,9 +87,11 @@ int push(struct heap * const heap, void * const data)
         return NULL_ARGUMENT;
     }
 
+    STATS_ADD(heap_pushes, 1);
+
     if (heap->elements == NULL)
     {
-        if ((heap->elements = (void **)malloc(sizeof(void *))) == NULL)
+        if ((heap->elements = (void **)memory_alloc(sizeof(void *))) == NULL)
         {
             return BAD_MEMORY_ALLOC;
         }
@@ -106,7 +110,7 @@ int push(struct heap * const heap, void * const data)
     }
     else
     {
-        if (heap->element_count == heap->container_size && (heap->elements = (void **)realloc(heap->elements, (heap->container_size <<= 1) * sizeof(void *))) == NULL)
+        if (heap->element_count == heap->container_size && (heap->elements = (void **)memory_realloc(heap->elements, (heap->container_size <<= 1) * sizeof(void *))) == NULL)
         {
             return BAD_MEMORY_ALLOC;
         }
@@ -150,7 +154,7 @@ int pop_free(struct heap * const heap)
     }
     else if (heap->weak_pointer == DEEP_COLLECTION)
     {
-        free(destroy);
+        memory_free(destroy);
     }
 
     return STATUS_SUCCESS;
@@ -163,6 +167,8 @@ int pop(struct heap * const heap, void ** const data)
         return NULL_ARGUMENT;
     }
 
+    STATS_ADD(heap_pops, 1);
+
     if (heap->element_count == 1)
     {
         heap->container_size = 0;
@@ -170,7 +176,7 @@ int pop(struct heap * const heap, void ** const data)
 
         *data = *heap->elements;
 
-        free(heap->elements);
+        memory_free(heap->elements);
         heap->elements = NULL;
     }
     else
@@ -191,7 +197,7 @@ int pop(struct heap * const heap, void ** const data)
         /// REALLOCATE MEMORY
         if (heap->element_count < heap->container_size / 4)
         {
-            heap->elements = (void **)realloc(heap->elements, (heap->container_size >>= 1) * sizeof(void *));
+            heap->elements = (void **)memory_realloc(heap->elements, (heap->container_size >>= 1) * sizeof(void *));
 
             if (heap->elements == NULL)
             {
@@ -266,11 +272,11 @@ int clean_heap(struct heap * heap)
             {
                 for (unsigned int i = 0; i < heap->container_size; ++i)
                 {
-                    free(*(heap->elements + i));
+                    memory_free(*(heap->elements + i));
                 }
             }
 
-            free(heap->elements);
+            memory_free(heap->elements);
             heap->elements = NULL;
         }
 
@@ -1,7 +1,13 @@
 #include "hash_table.h"
 #include "utilities.h"
+#include "allocator.h"
 #include "huffman.h"
 #include "shannon.h"
+#include "container.h"
+#include "context.h"
+#include "stats.h"
+#include "sink.h"
+#include "kernels.h"
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,7 +25,7 @@ struct hash_table * weight_table(const char * filePath, const unsigned int table
     }
 
     struct hash_table * table = frequency_hash_table(buffer, length, 1, table_size, &parse_sequences);
-    free(buffer);
+    memory_free(buffer);
 
     return table;
 }
@@ -31,7 +37,7 @@ struct heap * collect_to_heap(const void * data, const unsigned char collect_met
         return NULL;
     }
 
-    struct heap *heap = (struct heap *)malloc(sizeof(struct heap));
+    struct heap *heap = (struct heap *)memory_alloc(sizeof(struct heap));
 
     if (heap == NULL)
     {
@@ -40,7 +46,7 @@ struct heap * collect_to_heap(const void * data, const unsigned char collect_met
 
     if (collector(heap, data, collect_method) != STATUS_SUCCESS)
     {
-        free(heap);
+        memory_free(heap);
         return NULL;
     }
 
@@ -66,7 +72,7 @@ int transfer(struct heap *heap, struct node ** node)
             struct node new_node;
 
             new_node.info.length = (*node)->info.length;
-            new_node.info.sequence = (void *)malloc(new_node.info.length);
+            new_node.info.sequence = (void *)memory_alloc(new_node.info.length);
 
             if (new_node.info.sequence == NULL)
             {
@@ -83,7 +89,7 @@ int transfer(struct heap *heap, struct node ** node)
 
             if (result != STATUS_SUCCESS)
             {
-                free(new_node.info.sequence);
+                memory_free(new_node.info.sequence);
                 return result;
             }
         }
@@ -146,23 +152,34 @@ int hash_table_to_heap(struct heap* heap, const void *data, const unsigned char
     return STATUS_SUCCESS;
 }
 
-struct node * huffman_tree(const void * buffer, unsigned int length, const unsigned char collect_method, const unsigned int specifier, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier))
+struct node * table_huffman_tree(struct hash_table * hash_table, const unsigned char collect_method)
 {
-    if (buffer == NULL || length <= 0)
+    if (hash_table == NULL)
     {
         return NULL;
     }
 
-    struct heap * heap = NULL;
+    int previous_stage = set_memory_stage(STATS_TABLE_TO_HEAP);
+    STATS_START(heap_clock);
+    struct heap * heap = collect_to_heap(hash_table, collect_method, &hash_table_to_heap);
+    STATS_STOP(STATS_TABLE_TO_HEAP, heap_clock);
+    set_memory_stage(previous_stage);
+
+    if (heap == NULL)
+    {
+        return NULL;
+    }
 
+    if (heap->element_count == 0)
     {
-        /// Obtain hash_table with weights then transfer it to a heap.
-        struct hash_table* hash_table = frequency_hash_table(buffer, length, specifier, table_size, parse_data);
-        heap = collect_to_heap(hash_table, collect_method, &hash_table_to_heap);
-        clean_table(hash_table);
-        free(hash_table);
+        clean_heap(heap);
+        memory_free(heap);
+        return NULL;
     }
 
+    previous_stage = set_memory_stage(STATS_HUFFMAN_TREE);
+    STATS_START(tree_clock);
+
     {
         /// SCOPE LIMITER FOR pairs
         struct node * pair;
@@ -175,8 +192,9 @@ struct node * huffman_tree(const void * buffer, unsigned int length, const unsig
 
         while (heap->element_count != 1)
         {
-            if (collect_method == WEAK_COLLECTION && (pair = (struct node *)malloc(sizeof(struct node))) == NULL)
+            if (collect_method == WEAK_COLLECTION && (pair = (struct node *)memory_alloc(sizeof(struct node))) == NULL)
             {
+                set_memory_stage(previous_stage);
                 return NULL;
             }
 
@@ -207,7 +225,32 @@ struct node * huffman_tree(const void * buffer, unsigned int length, const unsig
     ++huffman_root->bal;
 
     clean_heap(heap);
-    free(heap);
+    memory_free(heap);
+
+    STATS_STOP(STATS_HUFFMAN_TREE, tree_clock);
+    set_memory_stage(previous_stage);
+    return huffman_root;
+}
+
+struct node * huffman_tree(const void * buffer, unsigned int length, const unsigned char collect_method, const unsigned int specifier, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier))
+{
+    if (buffer == NULL || length <= 0)
+    {
+        return NULL;
+    }
+
+    /// Obtain hash_table with weights then transfer it to a heap.
+    struct hash_table* hash_table = frequency_hash_table(buffer, length, specifier, table_size, parse_data);
+
+    if (hash_table == NULL)
+    {
+        return NULL;
+    }
+
+    struct node * huffman_root = table_huffman_tree(hash_table, collect_method);
+
+    clean_table(hash_table);
+    memory_free(hash_table);
 
     return huffman_root;
 }
@@ -220,8 +263,8 @@ int print_breadth_first(const struct node * node)
         unsigned int queue_last  = 1;
         unsigned int queue_total = node->bal;
 
-        const struct node  ** queue = (const struct node **)malloc(sizeof(struct node *) * queue_total);
-        unsigned int  * depth_level = (unsigned int *)calloc(queue_total, sizeof(unsigned int));
+        const struct node  ** queue = (const struct node **)memory_alloc(sizeof(struct node *) * queue_total);
+        unsigned int  * depth_level = (unsigned int *)memory_calloc(queue_total, sizeof(unsigned int));
         int count = 0, previous_level = -1;
         *queue = node;
 
@@ -256,8 +299,8 @@ int print_breadth_first(const struct node * node)
 
         printf("TOTAL: %d", count);
 
-        free(depth_level);
-        free(queue);
+        memory_free(depth_level);
+        memory_free(queue);
     }
     return STATUS_SUCCESS;
 }
@@ -269,14 +312,14 @@ int create_huffman_code(struct huffman_code * huffman_pair, void * key_data, uns
         return NULL_ARGUMENT;
     }
 
-    if ((huffman_pair->key = (void *)malloc(key_data_length)) == NULL)
+    if ((huffman_pair->key = (void *)memory_alloc(key_data_length)) == NULL)
     {
         return BAD_MEMORY_ALLOC;
     }
 
-    if ((huffman_pair->code = (void *)malloc(code_data_length)) == NULL)
+    if ((huffman_pair->code = (void *)memory_alloc(code_data_length)) == NULL)
     {
-        free(huffman_pair->key);
+        memory_free(huffman_pair->key);
         return BAD_MEMORY_ALLOC;
     }
 
@@ -326,6 +369,61 @@ int huffman_hash(const void * const sequence, unsigned int sz)
     }
 }
 
+int huffman_cmp_key(const void * const sequence_one, const unsigned int sz_one, const void * const sequence_two, const unsigned int sz_two)
+{
+    if (sequence_one == NULL || sequence_two == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct huffman_code * second = (struct huffman_code *)sequence_two;
+
+    if (sz_one == sizeof(struct huffman_code) && sz_two == sizeof(struct huffman_code))
+    {
+        struct huffman_code * first = (struct huffman_code *)sequence_one;
+        return seq_cmp(first->key, first->key_length, second->key, second->key_length);
+    }
+
+    return seq_cmp(sequence_one, sz_one, second->key, second->key_length);
+}
+
+static void free_huffman_codes(struct node * node)
+{
+    if (node != NULL)
+    {
+        struct huffman_code * huffman_pair = (struct huffman_code *)node->info.sequence;
+
+        if (huffman_pair != NULL)
+        {
+            memory_free(huffman_pair->key);
+            memory_free(huffman_pair->code);
+            huffman_pair->key = NULL;
+            huffman_pair->code = NULL;
+        }
+
+        free_huffman_codes(node->left_child);
+        free_huffman_codes(node->right_child);
+    }
+}
+
+int clean_huffman_table(struct hash_table * huffman_table)
+{
+    if (huffman_table == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (huffman_table->trees != NULL)
+    {
+        for (unsigned int i = 0; i < huffman_table->table_size; ++i)
+        {
+            free_huffman_codes((huffman_table->trees + i)->root);
+        }
+    }
+
+    return clean_table(huffman_table);
+}
+
 int build_huffman_hash_table(const struct node * node, struct hash_table* table, unsigned char * codes, const unsigned int byte_offset, const unsigned char bit_offset, int (*hash_fun)(const void * const sequence, unsigned int sz))
 {
     if (node != NULL)
@@ -334,7 +432,8 @@ int build_huffman_hash_table(const struct node * node, struct hash_table* table,
         {
             struct huffman_code huffman_code;
             create_huffman_code(&huffman_code, node->info.sequence, node->info.length, codes, byte_offset + 1, bit_offset);
-            add_element(table, &huffman_code, sizeof(struct huffman_code), hash_fun, &huffman_cmp);
+            /// ORDERED BY KEY SO THAT THE ENCODER CAN SEARCH A BUCKET WITH huffman_cmp_key
+            add_element(table, &huffman_code, sizeof(struct huffman_code), hash_fun, &huffman_cmp_key);
             return STATUS_SUCCESS;
         }
 
@@ -369,32 +468,47 @@ int build_huffman_hash_table(const struct node * node, struct hash_table* table,
     return STATUS_SUCCESS;
 }
 
-struct hash_table* huffman_hash_table(const void * buffer, const unsigned int length, const unsigned int specifier, struct node ** huffman_root, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier), int (*hash_fun)(const void * const sequence, unsigned int sz))
+struct hash_table* huffman_code_table(const struct node * const huffman_root, const unsigned int table_size, int (*hash_fun)(const void * const sequence, unsigned int sz))
 {
-    *huffman_root = huffman_tree(buffer, length, WEAK_COLLECTION, specifier, table_size, parse_data);
-
-    if (*huffman_root == NULL || (*huffman_root)->bal == 0)
+    if (huffman_root == NULL || huffman_root->bal == 0)
     {
-        clean_nodes(huffman_root);
-        free(*huffman_root);
         return NULL;
     }
 
-    struct hash_table * huffman_table = (struct hash_table *)malloc(sizeof(struct hash_table));
+    struct hash_table * huffman_table = (struct hash_table *)memory_alloc(sizeof(struct hash_table));
     unsigned char  * codes;
 
     if (huffman_table == NULL
             || create_table(huffman_table, table_size) != STATUS_SUCCESS
-            || (codes = (unsigned char *)calloc((*huffman_root)->bal / 8 + 1, sizeof(unsigned char))) == NULL)
+            || (codes = (unsigned char *)memory_calloc(huffman_root->bal / 8 + 1, sizeof(unsigned char))) == NULL)
     {
-        clean_nodes(huffman_root);
-        free(*huffman_root);
-        free(huffman_table);
+        clean_table(huffman_table);
+        memory_free(huffman_table);
         return NULL;
     }
 
-    build_huffman_hash_table(*huffman_root, huffman_table, codes, 0, 1, hash_fun);
-    free(codes);
+    const int previous_stage = set_memory_stage(STATS_CODE_TABLE);
+    STATS_START(clock);
+    build_huffman_hash_table(huffman_root, huffman_table, codes, 0, 1, hash_fun);
+    STATS_STOP(STATS_CODE_TABLE, clock);
+    set_memory_stage(previous_stage);
+    memory_free(codes);
+
+    return huffman_table;
+}
+
+struct hash_table* huffman_hash_table(const void * buffer, const unsigned int length, const unsigned int specifier, struct node ** huffman_root, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier), int (*hash_fun)(const void * const sequence, unsigned int sz))
+{
+    *huffman_root = huffman_tree(buffer, length, WEAK_COLLECTION, specifier, table_size, parse_data);
+
+    struct hash_table * huffman_table = huffman_code_table(*huffman_root, table_size, hash_fun);
+
+    if (huffman_table == NULL)
+    {
+        clean_nodes(huffman_root);
+        memory_free(*huffman_root);
+        return NULL;
+    }
 
     return huffman_table;
 }
@@ -423,283 +537,751 @@ void print_huffman_code(const struct node * const node)
     }
 }
 
-int huffman_encrypt_data(const void * data, const unsigned int data_length, void ** encrypted_data, unsigned int * encrypted_length, struct node ** huffman_root, struct hash_table ** huffman)
+static int put_byte(struct output_sink * sink, const unsigned char byte)
 {
-    if (data == NULL || encrypted_data == NULL || encrypted_length == NULL)
+    if (sink->length == sink->capacity)
     {
-        return NULL_ARGUMENT;
-    }
+        int result = sink_drain(sink);
 
-    if ((*huffman = huffman_hash_table(data, data_length, 1, huffman_root, 128, &parse_sequences, &huffman_hash))== NULL)
-    {
-        return NULL_RESULT;
+        if (result != STATUS_SUCCESS)
+        {
+            return result;
+        }
     }
 
-    int result = STATUS_SUCCESS;
-    unsigned int byte_offset = 0;
-    unsigned char bit_offset = 1;
+    sink->buffer[sink->length++] = byte;
+    return STATUS_SUCCESS;
+}
 
-    *encrypted_length = 2;
-    if ((*encrypted_data = (void *)calloc(*encrypted_length, sizeof(unsigned char))) == NULL)
+static int add_checkpoint(struct seek_index * index, const unsigned long long bit_offset)
+{
+    if (index->count == index->capacity)
     {
-        result = BAD_MEMORY_ALLOC;
-        goto err_exit;
+        unsigned int capacity = index->capacity == 0 ? 64 : index->capacity * 2;
+        unsigned long long * offsets = (unsigned long long *)memory_realloc(index->offsets, capacity * sizeof(unsigned long long));
+
+        if (offsets == NULL)
+        {
+            return BAD_MEMORY_ALLOC;
+        }
+
+        index->offsets = offsets;
+        index->capacity = capacity;
     }
 
+    index->offsets[index->count++] = bit_offset;
+    return STATUS_SUCCESS;
+}
+
+static int encode_symbols(struct hash_table * huffman, const void * data, const unsigned int data_length, struct output_sink * sink, struct coding_context * context)
+{
+    int result;
+    unsigned char pending = 0;
+    unsigned char bit_offset = 1;
+    const unsigned long long start = sink_total(sink);
+
     struct huffman_code * huffman_pair;
     for (unsigned int i = 0; i < data_length; ++i)
     {
-        huffman_pair = (struct huffman_code *)find_by_key(*huffman, (unsigned char *)data + i, sizeof(unsigned char), huffman_hash)->root->info.sequence;
-
-        if (huffman_pair == NULL)
+        if (context->index_interval != 0 && i != 0 && i % context->index_interval == 0
+                && (result = add_checkpoint(&context->index, (sink_total(sink) - start) * 8 + __builtin_ctz(bit_offset))) != STATUS_SUCCESS)
         {
-            result = NULL_RESULT;
-            goto err_exit;
+            return result;
         }
 
-        if (*encrypted_length <= byte_offset + huffman_pair->code_length)
+        /// THE BUCKET MAY HOLD SEVERAL KEYS (BYTES ABOVE 127 HASH NEGATIVE), SEARCH IT BY KEY
+        struct node * code_node = find_by_kv(huffman, (unsigned char *)data + i, sizeof(unsigned char), huffman_hash, huffman_cmp_key);
+
+        if (code_node == NULL)
         {
-            unsigned int new_size = *encrypted_length << 1;
+            return NULL_RESULT;
+        }
 
-            if ((*encrypted_data = (void *)realloc(*encrypted_data, sizeof(unsigned char) * new_size)) == NULL)
-            {
-                result = BAD_MEMORY_ALLOC;
-                goto err_exit;
-            }
+        huffman_pair = (struct huffman_code *)code_node->info.sequence;
 
-            memset(*encrypted_data + *encrypted_length, 0, *encrypted_length);
-            *encrypted_length = new_size;
-        }
+        const unsigned char * code = (const unsigned char *)huffman_pair->code;
 
-        for (unsigned int byte = 0; byte < huffman_pair->code_length - 1; ++byte)
+        for (unsigned int byte = 0; byte <= huffman_pair->code_length - 1; ++byte)
         {
-            for (unsigned char  bit = 1; bit != 0; bit <<= 1)
+            /// EVERY BIT OF THE FULL BYTES, THEN THE BITS BELOW last_bit OF THE LAST ONE
+            const unsigned int end = byte == huffman_pair->code_length - 1 ? huffman_pair->last_bit : 256;
+
+            for (unsigned int bit = 1; bit < end; bit <<= 1)
             {
-                *((unsigned char *)*encrypted_data + byte_offset) |= ((*((unsigned char *)huffman_pair->code + byte)) & bit) != 0 ? bit_offset : 0;
+                pending |= (code[byte] & bit) != 0 ? bit_offset : 0;
 
                 if (bit_offset == 128)
                 {
-                    ++byte_offset;
+                    if ((result = put_byte(sink, pending)) != STATUS_SUCCESS)
+                    {
+                        return result;
+                    }
+
+                    pending = 0;
                     bit_offset = 1;
                 }
                 else
                 {
-                    bit_offset = bit_offset * 2;
+                    bit_offset <<= 1;
                 }
             }
         }
+    }
 
-        for (unsigned char bit = 1; bit < huffman_pair->last_bit; bit = bit * 2)
+    /// THE LAST BYTE IS PADDED WITH 0 BITS
+    return bit_offset == 1 ? STATUS_SUCCESS : put_byte(sink, pending);
+}
+
+int build_huffman_codebook(struct hash_table * huffman, struct huffman_codebook * book)
+{
+    if (huffman == NULL || book == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memset(book, 0, sizeof(struct huffman_codebook));
+
+    for (unsigned int value = 0; value < 256; ++value)
+    {
+        const unsigned char key = (unsigned char)value;
+        struct node * code_node = find_by_kv(huffman, &key, sizeof(unsigned char), huffman_hash, huffman_cmp_key);
+
+        if (code_node == NULL)
         {
-            *((unsigned char *)*encrypted_data + byte_offset) |= ((*((unsigned char *)huffman_pair->code + huffman_pair->code_length - 1)) & bit) != 0 ? bit_offset : 0;
+            continue;
+        }
 
-            if (bit_offset == 128)
-            {
-                ++byte_offset;
-                bit_offset = 1;
-            }
-            else
-            {
-                bit_offset = bit_offset * 2;
-            }
+        const struct huffman_code * huffman_pair = (const struct huffman_code *)code_node->info.sequence;
+        const unsigned char * code = (const unsigned char *)huffman_pair->code;
+        const unsigned int length = (huffman_pair->code_length - 1) * 8 + __builtin_ctz(huffman_pair->last_bit);
+
+        if (length > 56)
+        {
+            return NULL_RESULT;
         }
+
+        for (unsigned int byte = 0; byte < huffman_pair->code_length; ++byte)
+        {
+            book->code[value] |= (unsigned long long)code[byte] << (byte * 8);
+        }
+
+        /// BITS ABOVE THE LENGTH OF THE LAST BYTE ARE NOT PART OF THE CODE
+        book->code[value] &= length == 0 ? 0 : ~0ULL >> (64 - length);
+        book->length[value] = length;
+        book->max_length = length > book->max_length ? length : book->max_length;
     }
 
-    *encrypted_length = byte_offset + 1;
-    *encrypted_data = (void *)realloc(*encrypted_data, *encrypted_length);
+    return STATUS_SUCCESS;
+}
 
-    if (*encrypted_data == NULL)
+int huffman_encoded_bits(const struct huffman_codebook * book, const unsigned int counts[256], unsigned long long * bits)
+{
+    if (book == NULL || counts == NULL || bits == NULL)
     {
-        result = BAD_MEMORY_ALLOC;
-        goto err_exit;
+        return NULL_ARGUMENT;
     }
 
-    return result;
+    *bits = 0;
 
-err_exit:
-    clean_nodes(huffman_root);
-    clean_table(*huffman);
-    free(*huffman_root);
-    free(*huffman);
-    return result;
+    for (unsigned int value = 0; value < 256; ++value)
+    {
+        if (counts[value] != 0 && book->length[value] == 0)
+        {
+            return NULL_RESULT;
+        }
+
+        *bits += (unsigned long long)counts[value] * book->length[value];
+    }
+
+    return STATUS_SUCCESS;
 }
 
-int huffman_decrypt_data(const void * data, const unsigned int data_length, void ** decrypted_data, unsigned int * decrypted_length, struct node * huffman_root, struct hash_table * huffman_table, const bool print_flag)
+static int compare_leaf_weights(const void * first, const void * second)
 {
-    if (huffman_root == NULL || decrypted_data == NULL)
+    const unsigned long long one = *(const unsigned long long *)first;
+    const unsigned long long two = *(const unsigned long long *)second;
+
+    return (one > two) - (one < two);
+}
+
+int huffman_fresh_cost(const unsigned int counts[256], unsigned long long * bits, unsigned int * tree_length)
+{
+    if (counts == NULL || bits == NULL || tree_length == NULL)
     {
         return NULL_ARGUMENT;
     }
 
-    struct node * huffman_node;
-    unsigned int byte_index = 0;
-    unsigned char bit_offset = 1;
+    unsigned long long leaves[256];
+    unsigned long long pairs[256];
+    unsigned int leaf_count = 0;
 
-    *decrypted_length = 1;
-    *decrypted_data = (void *)malloc(sizeof(unsigned char) * (*decrypted_length));
+    for (unsigned int value = 0; value < 256; ++value)
+    {
+        if (counts[value] != 0)
+        {
+            leaves[leaf_count++] = counts[value];
+        }
+    }
+
+    qsort(leaves, leaf_count, sizeof(unsigned long long), compare_leaf_weights);
+    *bits = 0;
+
+    /// SORTED LEAVES AND PAIRS MADE IN ORDER ARE TWO QUEUES, THE LIGHTEST TWO FRONTS ARE PAIRED LIKE THE HEAP OF table_huffman_tree DOES;
+    /// EVERY PAIR ADDS ONE BIT TO THE CODES BELOW IT, SO THE WEIGHTS OF THE PAIRS ADD UP TO THE BITS OF THE DATA
+    for (unsigned int leaf = 0, head = 0, tail = 0; tail + 1 < leaf_count; ++tail)
+    {
+        unsigned long long pair = 0;
+
+        for (unsigned int child = 0; child < 2; ++child)
+        {
+            pair += leaf < leaf_count && (head == tail || leaves[leaf] <= pairs[head]) ? leaves[leaf++] : pairs[head++];
+        }
+
+        pairs[tail] = pair;
+        *bits += pair;
+    }
+
+    /// THE SIZE serialize_huffman_tree GIVES: A LEAF FOR EVERY BYTE VALUE AND A PARENT FOR EVERY PAIR
+    *tree_length = leaf_count == 0 ? 0 : leaf_count * TREE_LEAF_SIZE(1) + (leaf_count - 1) * TREE_PARENT_SIZE;
+    return STATUS_SUCCESS;
+}
+
+static void leaf_depths(const struct node * const node, const unsigned int depth, unsigned char * lengths, unsigned int * deepest)
+{
+    if (node->left_child == NULL && node->right_child == NULL)
+    {
+        const unsigned char * key = (const unsigned char *)node->info.sequence;
+
+        lengths[key[0] | key[1] << 8] = (unsigned char)(depth < 255 ? depth : 255);
+        *deepest = depth > *deepest ? depth : *deepest;
+        return;
+    }
+
+    leaf_depths(node->left_child, depth + 1, lengths, deepest);
+    leaf_depths(node->right_child, depth + 1, lengths, deepest);
+}
+
+int huffman_code_lengths(const unsigned int * counts, const unsigned int symbol_count, const unsigned int max_length, unsigned char * lengths)
+{
+    if (counts == NULL || lengths == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned int used = 0;
+    unsigned int last = 0;
+
+    for (unsigned int symbol = 0; symbol < symbol_count; ++symbol)
+    {
+        if (counts[symbol] != 0)
+        {
+            ++used;
+            last = symbol;
+        }
+    }
 
-    if (decrypted_data == NULL)
+    if (symbol_count > 0x10000 || max_length == 0 || (max_length < 32 && used > 1U << max_length))
+    {
+        return INVALID_FORMAT;
+    }
+
+    memset(lengths, 0, symbol_count);
+
+    if (used < 2)
+    {
+        lengths[last] = used == 1;
+        return STATUS_SUCCESS;
+    }
+
+    unsigned int * weights = (unsigned int *)memory_alloc(symbol_count * sizeof(unsigned int));
+
+    if (weights == NULL)
     {
         return BAD_MEMORY_ALLOC;
     }
 
-    printf("The decrypted data is:\n\n");
+    memcpy(weights, counts, symbol_count * sizeof(unsigned int));
+
+    int result = STATUS_SUCCESS;
 
-    for (unsigned int byte_offset = 0; byte_offset < data_length;)
+    for (unsigned int deepest = max_length + 1; deepest > max_length && result == STATUS_SUCCESS; )
     {
-        for (huffman_node = huffman_root; huffman_node->left_child != NULL && huffman_node->right_child != NULL;)
+        struct hash_table table;
+        struct node * root = NULL;
+
+        if ((result = create_table(&table, DEFAULT_TABLE_SIZE)) != STATUS_SUCCESS)
         {
-            if ((*((unsigned char *)data + byte_offset) & bit_offset) == 0)
-            {
-                huffman_node = huffman_node->left_child;
-            }
-            else
-            {
-                huffman_node = huffman_node->right_child;
-            }
+            break;
+        }
+
+        for (unsigned int symbol = 0; symbol < symbol_count && result == STATUS_SUCCESS; ++symbol)
+        {
+            const unsigned char key[2] = { (unsigned char)symbol, (unsigned char)(symbol >> 8) };
 
-            if (bit_offset == 128)
+            if (weights[symbol] != 0)
             {
-                ++byte_offset;
-                bit_offset = 1;
+                result = add_counted_element(&table, key, 2, weights[symbol], hash_code, seq_cmp);
             }
-            else
+        }
+
+        if (result == STATUS_SUCCESS && (root = table_huffman_tree(&table, WEAK_COLLECTION)) == NULL)
+        {
+            result = BAD_MEMORY_ALLOC;
+        }
+
+        clean_table(&table);
+
+        if (result == STATUS_SUCCESS)
+        {
+            deepest = 0;
+            leaf_depths(root, 0, lengths, &deepest);
+            clean_nodes(&root);
+        }
+
+        /// A FLATTER DISTRIBUTION GIVES A SHALLOWER TREE, COUNTS OF 1 GIVE A BALANCED ONE
+        for (unsigned int symbol = 0; symbol < symbol_count && deepest > max_length; ++symbol)
+        {
+            weights[symbol] = weights[symbol] - weights[symbol] / 2;
+        }
+    }
+
+    memory_free(weights);
+    return result;
+}
+
+/// THE PACKER WRITES TO A STAGING BLOCK OF THIS SIZE, WHICH IS THEN COPIED TO THE SINK
+#define PACK_BLOCK 4096
+
+static int pack_symbols(const struct huffman_codebook * book, const unsigned char * data, const unsigned int data_length, struct output_sink * sink, struct coding_context * context)
+{
+    const struct cpu_kernels * kernels = cpu_kernels();
+    const unsigned int block = PACK_BLOCK * 8 / book->max_length;
+    const unsigned int interval = context->index_interval;
+    const unsigned long long start = sink_total(sink);
+    unsigned char staging[PACK_BLOCK + PACK_SLACK];
+    struct bit_writer writer;
+    int result;
+
+    memset(&writer, 0, sizeof(struct bit_writer));
+
+    for (unsigned int offset = 0, count; offset < data_length; offset += count)
+    {
+        count = data_length - offset < block ? data_length - offset : block;
+
+        if (interval != 0)
+        {
+            /// A BLOCK NEVER CROSSES A CHECKPOINT OF THE SEEK INDEX
+            if (offset != 0 && offset % interval == 0
+                    && (result = add_checkpoint(&context->index, (sink_total(sink) - start) * 8 + writer.count)) != STATUS_SUCCESS)
             {
-                bit_offset <<= 1;
+                return result;
             }
+
+            count = interval - offset % interval < count ? interval - offset % interval : count;
         }
 
-        if (((unsigned char *)huffman_node->info.sequence)[0] == NULL)
+        const size_t written = kernels->pack_codes(data + offset, count, book, &writer, staging);
+
+        if (writer.missing != 0)
         {
-            break;
+            return NULL_RESULT;
         }
 
-        printf("%c", ((unsigned char *)huffman_node->info.sequence)[0]);
+        if ((result = sink_write(sink, staging, (unsigned int)written)) != STATUS_SUCCESS)
+        {
+            return result;
+        }
+    }
+
+    /// THE LAST BYTE IS PADDED WITH 0 BITS
+    return writer.count == 0 ? STATUS_SUCCESS : put_byte(sink, (unsigned char)writer.bits);
+}
+
+static int encode_to_sink(struct coding_context * context, struct hash_table * huffman, const struct huffman_codebook * book, const void * data, const unsigned int data_length, struct output_sink * sink)
+{
+#ifdef SHANNON_STATS
+    const unsigned long long total = sink_total(sink);
+#endif
+
+    STATS_BIND(&context->stats);
+    const int previous_stage = set_memory_stage(STATS_ENCODE);
+    STATS_START(clock);
+    context->index.count = 0;
+    int result = book != NULL ? pack_symbols(book, (const unsigned char *)data, data_length, sink, context) : encode_symbols(huffman, data, data_length, sink, context);
+
+    if (result == STATUS_SUCCESS)
+    {
+        result = sink_finish(sink);
+    }
+
+    STATS_STOP(STATS_ENCODE, clock);
+    set_memory_stage(previous_stage);
+
+    if (result == STATUS_SUCCESS)
+    {
+        STATS_ADD(bytes_in, data_length);
+        STATS_ADD(bytes_out, sink_total(sink) - total);
+    }
+
+    STATS_UNBIND();
+    return result;
+}
+
+int huffman_encode_codebook_sink(struct coding_context * context, const struct huffman_codebook * book, const void * data, const unsigned int data_length, struct output_sink * sink)
+{
+    if (context == NULL || book == NULL || data == NULL || sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    /// A CODEBOOK WITHOUT ANY BITS CANNOT TELL A MISSING BYTE FROM A 0 BIT CODE
+    return book->max_length == 0 ? NULL_RESULT : encode_to_sink(context, NULL, book, data, data_length, sink);
+}
+
+int huffman_encode_sink(struct coding_context * context, struct hash_table * huffman, const void * data, const unsigned int data_length, struct output_sink * sink)
+{
+    if (context == NULL || huffman == NULL || data == NULL || sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct huffman_codebook book;
+
+    /// CODES OF 1 TO 56 BITS GO THROUGH THE PACKER OF THE CPU, ANYTHING ELSE BIT BY BIT
+    if (build_huffman_codebook(huffman, &book) == STATUS_SUCCESS && book.max_length != 0)
+    {
+        return encode_to_sink(context, huffman, &book, data, data_length, sink);
+    }
+
+    return encode_to_sink(context, huffman, NULL, data, data_length, sink);
+}
+
+int huffman_encode_table(struct coding_context * context, struct hash_table * huffman, const void * data, const unsigned int data_length, void ** encrypted_data, unsigned int * encrypted_length)
+{
+    if (context == NULL || huffman == NULL || data == NULL || encrypted_data == NULL || encrypted_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct output_sink sink;
+    int result = create_buffer_sink(&sink, data_length / 2 + 16);
+
+    if (result == STATUS_SUCCESS && (result = huffman_encode_sink(context, huffman, data, data_length, &sink)) == STATUS_SUCCESS)
+    {
+        result = sink_release(&sink, encrypted_data, encrypted_length);
+    }
+
+    clean_sink(&sink);
+    return result;
+}
+
+int huffman_encrypt_data(struct coding_context * context, const void * data, const unsigned int data_length, void ** encrypted_data, unsigned int * encrypted_length, struct node ** huffman_root, struct hash_table ** huffman)
+{
+    if (context == NULL || data == NULL || encrypted_data == NULL || encrypted_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    STATS_BIND(&context->stats);
+    *huffman = huffman_hash_table(data, data_length, 1, huffman_root, context->table_size, &parse_sequences, &huffman_hash);
+    STATS_UNBIND();
+
+    if (*huffman == NULL)
+    {
+        return NULL_RESULT;
+    }
+
+    context->sample_count = data_length;
+    context->distinct_count = (*huffman)->element_count;
+
+    int result = huffman_encode_table(context, *huffman, data, data_length, encrypted_data, encrypted_length);
+
+    if (result == STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    clean_nodes(huffman_root);
+    clean_huffman_table(*huffman);
+    memory_free(*huffman_root);
+    memory_free(*huffman);
+    return result;
+}
+
+/// SYMBOLS BEFORE THE START OF A RANGE ARE DECODED TO A BLOCK OF THIS SIZE AND DROPPED
+#define SKIP_BLOCK 4096
+
+static int skip_symbols(struct bit_reader * reader, const struct decode_table * table, unsigned int skip)
+{
+    const struct cpu_kernels * kernels = cpu_kernels();
+    unsigned char discarded[SKIP_BLOCK];
+
+    for (unsigned int count; skip != 0 && !table->single_symbol; skip -= count)
+    {
+        count = skip < SKIP_BLOCK ? skip : SKIP_BLOCK;
+
+        if (kernels->decode_codes(reader, table, discarded, count) != STATUS_SUCCESS)
+        {
+            return CORRUPT_DATA;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+static int decode_symbols(struct bit_reader * reader, const struct decode_table * table, const unsigned int symbol_count, struct output_sink * sink)
+{
+    const struct cpu_kernels * kernels = cpu_kernels();
 
-        if (byte_index == *decrypted_length)
+    for (unsigned int remaining = symbol_count; remaining != 0;)
+    {
+        if (sink->length == sink->capacity)
         {
-            if ((*decrypted_data = (void *)realloc(*decrypted_data, *decrypted_length <<= 1)) == NULL)
+            int result = sink_drain(sink);
+
+            if (result != STATUS_SUCCESS)
             {
-                return BAD_MEMORY_ALLOC;
+                return result;
             }
         }
 
-        *((unsigned char *)*decrypted_data + byte_index++) = *(unsigned char *)huffman_node->info.sequence;
+        /// AS MANY SYMBOLS AS FIT IN THE SINK ARE DECODED AT ONCE
+        unsigned char * output = sink->buffer + sink->length;
+        unsigned int count = sink->capacity - sink->length < remaining ? sink->capacity - sink->length : remaining;
+
+        if (table->single_symbol)
+        {
+            /// A TREE OF ONE LEAF HAS CODES OF 0 BITS
+            memset(output, table->entries[0].value, count);
+        }
+        else if (kernels->decode_codes(reader, table, output, count) != STATUS_SUCCESS)
+        {
+            /// THE DATA ENDED IN THE MIDDLE OF A CODE
+            return CORRUPT_DATA;
+        }
+
+        sink->length += count;
+        remaining -= count;
     }
 
+    return STATUS_SUCCESS;
+}
 
-    if ((*decrypted_data = (void *)realloc(*decrypted_data, *decrypted_length = byte_index)) == NULL)
+int huffman_decode_table_range(struct coding_context * context, const void * data, const unsigned int data_length, const struct decode_table * table, const unsigned long long bit_offset, const unsigned int skip, const unsigned int symbol_count, struct output_sink * sink)
+{
+    if (context == NULL || data == NULL || table == NULL || sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct bit_reader reader;
+
+    memset(&reader, 0, sizeof(struct bit_reader));
+    reader.data = (const unsigned char *)data;
+    reader.length = data_length;
+    reader.offset = bit_offset >> 3;
+
+    if (reader.offset > data_length || (reader.offset == data_length && (bit_offset & 7) != 0))
+    {
+        return CORRUPT_DATA;
+    }
+
+    /// A CHECKPOINT IN THE MIDDLE OF A BYTE: THE BITS BELOW IT ARE DROPPED
+    if ((bit_offset & 7) != 0)
+    {
+        reader.bits = reader.data[reader.offset++] >> (bit_offset & 7);
+        reader.count = 8 - (bit_offset & 7);
+    }
+
+#ifdef SHANNON_STATS
+    const unsigned long long total = sink_total(sink);
+#endif
+
+    STATS_BIND(&context->stats);
+    const int previous_stage = set_memory_stage(STATS_DECODE);
+    STATS_START(clock);
+    int result = skip_symbols(&reader, table, skip);
+
+    if (result == STATUS_SUCCESS && (result = decode_symbols(&reader, table, symbol_count, sink)) == STATUS_SUCCESS)
+    {
+        result = sink_finish(sink);
+    }
+
+    STATS_STOP(STATS_DECODE, clock);
+    set_memory_stage(previous_stage);
+
+    if (result == STATUS_SUCCESS)
+    {
+        context->sample_count = symbol_count;
+        STATS_ADD(bytes_in, reader.offset - (bit_offset >> 3));
+        STATS_ADD(bytes_out, sink_total(sink) - total);
+    }
+
+    STATS_UNBIND();
+    return result;
+}
+
+int huffman_decode_table_sink(struct coding_context * context, const void * data, const unsigned int data_length, const struct decode_table * table, const unsigned int symbol_count, struct output_sink * sink)
+{
+    return huffman_decode_table_range(context, data, data_length, table, 0, 0, symbol_count, sink);
+}
+
+int huffman_decode_sink(struct coding_context * context, const void * data, const unsigned int data_length, struct node * huffman_root, const unsigned int symbol_count, struct output_sink * sink)
+{
+    if (context == NULL || data == NULL || huffman_root == NULL || sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct decode_table * table = (struct decode_table *)memory_alloc(sizeof(struct decode_table));
+    int result;
+
+    if (table == NULL)
     {
         return BAD_MEMORY_ALLOC;
     }
 
-    printf("\n");
-    return STATUS_SUCCESS;
+    if ((result = build_decode_table(huffman_root, table)) == STATUS_SUCCESS)
+    {
+        result = huffman_decode_table_sink(context, data, data_length, table, symbol_count, sink);
+    }
+
+    memory_free(table);
+    return result;
+}
+
+int huffman_decrypt_data(struct coding_context * context, const void * data, const unsigned int data_length, void ** decrypted_data, unsigned int * decrypted_length, struct node * huffman_root, const unsigned int symbol_count)
+{
+    if (context == NULL || huffman_root == NULL || decrypted_data == NULL || decrypted_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct output_sink sink;
+    int result = create_buffer_sink(&sink, symbol_count);
+
+    if (result == STATUS_SUCCESS && (result = huffman_decode_sink(context, data, data_length, huffman_root, symbol_count, &sink)) == STATUS_SUCCESS)
+    {
+        result = sink_release(&sink, decrypted_data, decrypted_length);
+    }
+
+    clean_sink(&sink);
+
+    /// THE OUTPUT IS PRINTED ONCE, AFTER THE DECODE
+    if (result == STATUS_SUCCESS && context->print_flag)
+    {
+        printf("The decrypted data is:\n\n");
+        fwrite(*decrypted_data, sizeof(unsigned char), *decrypted_length, stdout);
+        printf("\n");
+    }
+
+    return result;
 }
 
-int encode_huffman_file(const char * input_file_name, const char * output_file_name, struct node ** huffman_root, struct hash_table ** huffman_table, const bool print_flag)
+int encode_huffman_file(struct coding_context * context, const char * input_file_name, const char * output_file_name, struct node ** huffman_root, struct hash_table ** huffman_table)
 {
     int result = STATUS_SUCCESS;
     void *data;
     unsigned int length;
     void *encrypted_data;
     unsigned int encrypted_length;
+    struct node * root;
+    struct hash_table * table;
 
     /// READ DATA FROM GIVEN INPUT FILE
-    if ((result = fetch_data(input_file_name, &data, &length, "rb")) != STATUS_SUCCESS)
+    if ((result = read_data(input_file_name, &data, &length)) != STATUS_SUCCESS)
     {
-        printf("Could not fetch data from file: %s", input_file_name);
         return result;
     }
 
-    /// ENCODE DATA WITH HUFFMAN-TREE ALGORITHM
-    if ((result = huffman_encrypt_data(data, length, &encrypted_data, &encrypted_length, huffman_root, huffman_table)) != STATUS_SUCCESS)
+    /// ENCODE DATA WITH HUFFMAN-TREE ALGORITHM, TREE INCLUDED
+    if ((result = huffman_compress(context, data, length, &encrypted_data, &encrypted_length, &root, &table)) != STATUS_SUCCESS)
     {
-        printf("Could not encode data.");
-        free(data);
+        memory_free(data);
         return result;
     }
-    free(data);
+    memory_free(data);
 
     /// WRITE ENCRYPTED DATA TO OUTPUT FILE
-    if ((result = write_data(output_file_name, encrypted_data, encrypted_length)) != STATUS_SUCCESS)
-    {
-        printf("Could not write encrypted data to file: %s", output_file_name);
-        free(encrypted_data);
-        return result;
-    }
-
-    if (print_flag == true)
+    if ((result = write_data(output_file_name, encrypted_data, encrypted_length)) == STATUS_SUCCESS && context->print_flag == true && root != NULL)
     {
         /// VIEW THE SHANNON-INFORMATION
-        printf("View the Shannon Entropy for the Huffman encoding:\nPress to continue:"); getc(stdin);
-        printf("The Shannon Entropy for the Huffman Coding is: %f\n\n", huffman_entropy(*huffman_root, 0, length));
+        printf("The Shannon Entropy for the Huffman Coding is: %f\n\n", huffman_entropy(root, 0, length));
 
         /// PRINT THE HUFFMAN TREE
-        printf("The Huffman Tree's internal structure:\nPress to continue:"); getc(stdin);
-        rsd(*huffman_root, print_node);
+        printf("The Huffman Tree's internal structure:\n");
+        rsd(root, print_node);
         printf("\n\n");
 
         /// PRINT THE HUFFMAN HASH-TABLE
-        printf("View the Huffman codes:\nPress to continue:"); getc(stdin);
-        print_table(*huffman_table, print_huffman_code);
+        printf("The Huffman codes:\n");
+        print_table(table, print_huffman_code);
         printf("\n");
 
         /// VIEW THE ENCRYPTED DATA
-        printf("View encrypted data:\nPress to continue:"); getc(stdin);
+        printf("The encrypted data:\n");
         print_bits(encrypted_data, encrypted_length, FORMAT_BITS, false);
         printf("\n\n");
     }
 
-    free(encrypted_data);
+    memory_free(encrypted_data);
+
+    if (result == STATUS_SUCCESS && huffman_root != NULL)
+    {
+        *huffman_root = root;
+    }
+    else
+    {
+        clean_nodes(&root);
+    }
+
+    if (result == STATUS_SUCCESS && huffman_table != NULL)
+    {
+        *huffman_table = table;
+    }
+    else
+    {
+        clean_huffman_table(table);
+        memory_free(table);
+    }
+
     return result;
 }
 
-int decode_huffman_file(const char * input_file_name, const char * output_file_name, struct node * huffman_root, struct hash_table * huffman_table, const bool print_flag)
+int decode_huffman_file(struct coding_context * context, const char * input_file_name, const char * output_file_name)
 {
+    int result;
     void * encrypted_data;
     unsigned int encrypted_length;
 
     /// READ FROM FILE
-    FILE* input = fopen(input_file_name, "rb");
-
-    if (input == NULL)
+    if ((result = read_data(input_file_name, &encrypted_data, &encrypted_length)) != STATUS_SUCCESS)
     {
-        perror("Could not open file.");
-        return FILE_ERROR;
+        return result;
     }
 
-    fseek(input, 0L, SEEK_END);
-    encrypted_length = ftell(input);
-    encrypted_data = (void *)malloc(encrypted_length * sizeof(unsigned char));
+    FILE * output = fopen(output_file_name, "wb");
+    struct output_sink sink;
 
-    if (encrypted_data == NULL)
+    if (output == NULL)
     {
-        return BAD_MEMORY_ALLOC;
+        memory_free(encrypted_data);
+        return FILE_ERROR;
     }
 
-    fseek(input, 0L, SEEK_SET);
-    fread(encrypted_data, sizeof(unsigned char), encrypted_length, input);
-    fclose(input);
-
-    int result;
-    void * decryped_data;
-    unsigned int decrypted_length;
-
-    printf("View decrypted data:\nPress to continue:"); getc(stdin);
-    if ((result = huffman_decrypt_data(encrypted_data, encrypted_length, &decryped_data, &decrypted_length, huffman_root, huffman_table, print_flag)) != STATUS_SUCCESS)
+    /// THE TREE IS READ FROM THE FILE ITSELF, THE DECODED DATA GOES TO THE FILE IN CHUNKS
+    if ((result = create_callback_sink(&sink, DEFAULT_SINK_CHUNK, file_sink_write, output)) == STATUS_SUCCESS)
     {
-        free(encrypted_data);
-        return result;
+        result = huffman_decompress_sink(context, encrypted_data, encrypted_length, &sink);
     }
 
-    free(encrypted_data);
-    if ((result = write_data(output_file_name, decryped_data, decrypted_length)) != STATUS_SUCCESS)
+    clean_sink(&sink);
+    memory_free(encrypted_data);
+
+    if (fclose(output) != 0 && result == STATUS_SUCCESS)
     {
-        printf("Could not write decrypted data to file: %s", output_file_name);
-        free(decryped_data);
-        return result;
+        result = FILE_ERROR;
     }
-    free(decryped_data);
-    return STATUS_SUCCESS;
+
+    return result;
 }
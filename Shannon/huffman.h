@@ -1,6 +1,9 @@
 #ifndef _HUFFMAN_H_
 #define _HUFFMAN_H_
 #include "hash_table.h"
+#include "context.h"
+#include "sink.h"
+#include "kernels.h"
 
 struct huffman_code
 {
@@ -18,6 +21,33 @@ struct heap * collect_to_heap(const void * data, const unsigned char collect_met
 
 struct node * huffman_tree(const void * buffer, unsigned int length, const unsigned char collect_method, const unsigned int specifier, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier));
 
+/**
+*   Builds the Huffman tree from an already filled frequency table, e.g. one
+*   merged by parallel_word_table. With WEAK_COLLECTION the nodes are moved out
+*   of the table, which is left empty.
+*
+*   @PARAMS
+*   hash_table     - Frequency table
+*   collect_method - WEAK_COLLECTION or DEEP_COLLECTION
+*
+*   @RETURN
+*    NULL - Table is NULL / empty or memory could not be allocated
+*   !NULL - Root of the Huffman tree
+*/
+struct node * table_huffman_tree(struct hash_table * hash_table, const unsigned char collect_method);
+
+/**
+*   @PARAMS
+*   huffman_root - Root of the Huffman tree
+*   table_size   - Size of the code table
+*   hash_fun     - Hash function used for the keys
+*
+*   @RETURN
+*    NULL - Invalid tree or memory could not be allocated
+*   !NULL - Table of key-code pairs
+*/
+struct hash_table* huffman_code_table(const struct node * const huffman_root, const unsigned int table_size, int (*hash_fun)(const void * const sequence, unsigned int sz));
+
 void print_huffman_code(const struct node * const node);
 
 struct hash_table* huffman_hash_table(const void * buffer, const unsigned int length, const unsigned int specifier, struct node ** huffman_root, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier), int (*hash_fun)(const void * const sequence, unsigned int sz));
@@ -26,12 +56,246 @@ int huffman_hash(const void * const sequence, unsigned int sz);
 
 int huffman_cmp(const void * const sequence_one, const unsigned int sz_one, const void * const sequence_two, const unsigned int sz_two);
 
-int huffman_encrypt_data(const void * data, const unsigned int data_length, void ** encrypted_data, unsigned int * encrypted_length, struct node ** huffman_root, struct hash_table ** huffman);
+/**
+*   Compares a raw key (or the key of a huffman_code) with the key of a
+*   huffman_code stored in a code table.
+*
+*   @RETURN
+*   Same as seq_cmp
+*/
+int huffman_cmp_key(const void * const sequence_one, const unsigned int sz_one, const void * const sequence_two, const unsigned int sz_two);
+
+/**
+*   Cleans a table built by huffman_code_table, the keys and codes included.
+*
+*   @PARAMS
+*   huffman_table - Table of key-code pairs
+*
+*   @RETURN
+*   NULL_ARGUMENT  - huffman_table is NULL
+*   STATUS_SUCCESS - Table successfully cleaned
+*/
+int clean_huffman_table(struct hash_table * huffman_table);
+
+/**
+*   Code lengths of an alphabet of up to 65536 symbols (e.g. the literals /
+*   lengths and the distances of lz77.h), from the tree table_huffman_tree
+*   builds with every symbol as a 2 byte key. While the tree is deeper than
+*   max_length the counts are halved, a used symbol keeps at least 1, and the
+*   tree is built again. A single used symbol gets a code of 1 bit.
+*
+*   @PARAMS
+*   counts       - Occurrences of every symbol
+*   symbol_count - Size of the alphabet
+*   max_length   - Longest code allowed
+*   lengths      - Receives the code length of every symbol, 0 for unused ones
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   INVALID_FORMAT   - More than 65536 symbols, or more used ones than max_length bits can tell apart
+*   BAD_MEMORY_ALLOC - Could not build the tree
+*   STATUS_SUCCESS   - lengths holds the code lengths
+*/
+int huffman_code_lengths(const unsigned int * counts, const unsigned int symbol_count, const unsigned int max_length, unsigned char * lengths);
+
+/**
+*   Copies the codes of the 1 byte keys of a code table to a flat codebook
+*   for the packer of cpu_kernels. Bytes without a code get length 0.
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   NULL_RESULT    - A code is longer than 56 bits
+*   STATUS_SUCCESS - Codebook was filled
+*/
+int build_huffman_codebook(struct hash_table * huffman, struct huffman_codebook * book);
+
+/**
+*   Exact number of bits the data of a byte histogram takes with a codebook,
+*   without encoding it (sum of count * code length).
+*
+*   @PARAMS
+*   book   - Codebook, e.g. of the tables of an earlier block
+*   counts - Histogram of the bytes of the data
+*   bits   - Receives the number of bits
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   NULL_RESULT    - A byte of the histogram has no code in the codebook
+*   STATUS_SUCCESS - bits holds the size
+*/
+int huffman_encoded_bits(const struct huffman_codebook * book, const unsigned int counts[256], unsigned long long * bits);
+
+/**
+*   Cost of coding a byte histogram with a tree of its own, without building
+*   the tree: the bits of the data (the same for every Huffman tree of the
+*   histogram) and the bytes of the serialized tree the container holds.
+*
+*   @PARAMS
+*   counts      - Histogram of the bytes of the data
+*   bits        - Receives the number of bits of the data
+*   tree_length - Receives the size of the serialized tree in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   STATUS_SUCCESS - bits and tree_length hold the cost
+*/
+int huffman_fresh_cost(const unsigned int counts[256], unsigned long long * bits, unsigned int * tree_length);
+
+/**
+*   Encodes the data with an already built table of key-code pairs (1 byte keys)
+*   and writes the bits to a sink, packed by the kernels of the CPU.
+*
+*   @PARAMS
+*   context     - Statistics of the encode
+*   huffman     - Table of key-code pairs, e.g. from huffman_code_table
+*   data        - Memory address of data
+*   data_length - In bytes
+*   sink        - Receives the encoded bytes, finished before returning
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   NULL_RESULT    - A byte of the data has no code in the table
+*   STATUS_SUCCESS - Data was encoded
+*   Any error of the sink
+*/
+int huffman_encode_sink(struct coding_context * context, struct hash_table * huffman, const void * data, const unsigned int data_length, struct output_sink * sink);
+
+/**
+*   Same as huffman_encode_sink with a codebook, e.g. one of precompiled tables.
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   NULL_RESULT    - A byte of the data has no code in the codebook
+*   STATUS_SUCCESS - Data was encoded
+*   Any error of the sink
+*/
+int huffman_encode_codebook_sink(struct coding_context * context, const struct huffman_codebook * book, const void * data, const unsigned int data_length, struct output_sink * sink);
+
+/**
+*   Same as huffman_encode_sink, the bits are collected in memory.
+*
+*   @PARAMS
+*   context          - Statistics of the encode
+*   huffman          - Table of key-code pairs, e.g. from huffman_code_table
+*   data             - Memory address of data
+*   data_length      - In bytes
+*   encrypted_data   - Receives the encoded bits (allocated)
+*   encrypted_length - Receives the length of the encoded data in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   NULL_RESULT      - A byte of the data has no code in the table
+*   BAD_MEMORY_ALLOC - Could not allocate the encoded data
+*   STATUS_SUCCESS   - Data was encoded
+*/
+int huffman_encode_table(struct coding_context * context, struct hash_table * huffman, const void * data, const unsigned int data_length, void ** encrypted_data, unsigned int * encrypted_length);
+
+/**
+*   @PARAMS
+*   context          - Configuration (table_size), scratch buffer and counts of the encode
+*   data             - Memory address of data
+*   data_length      - In bytes
+*   encrypted_data   - Receives the encoded bits (allocated)
+*   encrypted_length - Receives the length of the encoded data in bytes
+*   huffman_root     - Receives the Huffman tree
+*   huffman          - Receives the table of key-code pairs
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   NULL_RESULT      - The Huffman tree / table could not be built
+*   BAD_MEMORY_ALLOC - Could not allocate the encoded data
+*   STATUS_SUCCESS   - Data was encoded
+*/
+int huffman_encrypt_data(struct coding_context * context, const void * data, const unsigned int data_length, void ** encrypted_data, unsigned int * encrypted_length, struct node ** huffman_root, struct hash_table ** huffman);
+
+/**
+*   Decodes exactly symbol_count symbols with the Huffman tree and writes them
+*   to a sink, nothing is printed. There is no end of data symbol, so the data
+*   may hold any byte.
+*
+*   @PARAMS
+*   context      - Receives the number of decoded symbols (sample_count)
+*   data         - Encoded bits
+*   data_length  - In bytes
+*   huffman_root - Huffman tree of the encode
+*   symbol_count - Number of symbols that were encoded
+*   sink         - Receives the decoded bytes, finished before returning
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the decode table
+*   CORRUPT_DATA     - The data ends in the middle of a code, or the tree is too large
+*   STATUS_SUCCESS   - Data was decoded
+*   Any error of the sink
+*/
+int huffman_decode_sink(struct coding_context * context, const void * data, const unsigned int data_length, struct node * huffman_root, const unsigned int symbol_count, struct output_sink * sink);
+
+/**
+*   Same as huffman_decode_sink with a decode table that is already built,
+*   e.g. one mapped from a file of precompiled tables.
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   CORRUPT_DATA   - The data ends in the middle of a code
+*   STATUS_SUCCESS - Data was decoded
+*   Any error of the sink
+*/
+int huffman_decode_table_sink(struct coding_context * context, const void * data, const unsigned int data_length, const struct decode_table * table, const unsigned int symbol_count, struct output_sink * sink);
+
+/**
+*   Decodes symbol_count symbols that start skip symbols after a bit offset,
+*   e.g. a checkpoint of a seek index, and writes them to a sink.
+*
+*   @PARAMS
+*   bit_offset   - Bit of data the decode starts at (0 is the first bit)
+*   skip         - Symbols decoded and dropped before the first written one
+*   symbol_count - Symbols written to the sink
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   CORRUPT_DATA   - bit_offset is past the data or the data ends in the middle of a code
+*   STATUS_SUCCESS - Data was decoded
+*   Any error of the sink
+*/
+int huffman_decode_table_range(struct coding_context * context, const void * data, const unsigned int data_length, const struct decode_table * table, const unsigned long long bit_offset, const unsigned int skip, const unsigned int symbol_count, struct output_sink * sink);
 
-int huffman_decrypt_data(const void * data, const unsigned int data_length, void ** decrypted_data, unsigned int * decrypted_length, struct node * huffman_root, struct hash_table * huffman_table, const bool print_flag);
+/**
+*   Same as huffman_decode_sink, the symbols are collected in a buffer of
+*   symbol_count bytes and printed once at the end when print_flag is set.
+*/
+int huffman_decrypt_data(struct coding_context * context, const void * data, const unsigned int data_length, void ** decrypted_data, unsigned int * decrypted_length, struct node * huffman_root, const unsigned int symbol_count);
 
-int encode_huffman_file(const char * input_file_name, const char * output_file_name, struct node ** huffman_root, struct hash_table ** huffman_table, const bool print_flag);
+/**
+*   Compresses a file into a container (see huffman_compress).
+*
+*   @PARAMS
+*   context          - Configuration, scratch buffer and counts of the encode
+*   input_file_name  - Path of the file to be compressed
+*   output_file_name - Path of the container
+*   huffman_root     - Receives the Huffman tree, may be NULL
+*   huffman_table    - Receives the table of key-code pairs, may be NULL
+*
+*   @RETURN
+*   FILE_ERROR     - Could not read / write one of the files
+*   STATUS_SUCCESS - File was compressed
+*   Any error of huffman_compress
+*/
+int encode_huffman_file(struct coding_context * context, const char * input_file_name, const char * output_file_name, struct node ** huffman_root, struct hash_table ** huffman_table);
 
-int decode_huffman_file(const char * input_file_name, const char * output_file_name, struct node * huffman_root, struct hash_table * huffman_table, const bool print_flag);
+/**
+*   Decompresses a container written by encode_huffman_file, the tree is read
+*   from the container.
+*
+*   @PARAMS
+*   context          - Configuration and counts of the decode
+*   input_file_name  - Path of the container
+*   output_file_name - Path of the decompressed file
+*
+*   @RETURN
+*   FILE_ERROR     - Could not read / write one of the files
+*   STATUS_SUCCESS - File was decompressed
+*   Any error of huffman_decompress
+*/
+int decode_huffman_file(struct coding_context * context, const char * input_file_name, const char * output_file_name);
 
 #endif // _HUFFMAN_H_
@@ -0,0 +1,745 @@
+#include "utilities.h"
+#include "kernels.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// THE SIMD VARIANTS ARE BUILT WITH TARGET ATTRIBUTES, SO ONE BINARY HOLDS ALL OF THEM
+#if defined(__GNUC__) && defined(__x86_64__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+static const char * variant_names[CPU_VARIANT_COUNT] = { "scalar", "sse4.2", "avx2", "avx512" };
+
+/// HISTOGRAM
+
+static void count_bytes(unsigned int partial[4][256], const unsigned char * data, const size_t length)
+{
+    size_t i = 0;
+
+    /// FOUR TABLES, SO THAT EQUAL NEIGHBOURS DO NOT WAIT ON THE SAME COUNTER
+    for (; i + 4 <= length; i += 4)
+    {
+        ++partial[0][data[i]];
+        ++partial[1][data[i + 1]];
+        ++partial[2][data[i + 2]];
+        ++partial[3][data[i + 3]];
+    }
+
+    for (; i < length; ++i)
+    {
+        ++partial[0][data[i]];
+    }
+}
+
+static void merge_counts(unsigned int partial[4][256], unsigned int counts[256])
+{
+    for (unsigned int value = 0; value < 256; ++value)
+    {
+        counts[value] += partial[0][value] + partial[1][value] + partial[2][value] + partial[3][value];
+    }
+}
+
+static void histogram_scalar(const unsigned char * data, size_t length, unsigned int counts[256])
+{
+    unsigned int partial[4][256];
+
+    memset(partial, 0, sizeof(partial));
+    count_bytes(partial, data, length);
+    merge_counts(partial, counts);
+}
+
+/// COMPARE
+
+static int compare_scalar(const void * first, const void * second, size_t length)
+{
+    const unsigned char * one = (const unsigned char *)first;
+    const unsigned char * two = (const unsigned char *)second;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (one[i] != two[i])
+        {
+            return one[i] < two[i] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+/// FIND BYTE
+
+static size_t find_byte_scalar(const void * data, size_t length, unsigned char byte)
+{
+    const unsigned char * bytes = (const unsigned char *)data;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (bytes[i] == byte)
+        {
+            return i;
+        }
+    }
+
+    return length;
+}
+
+/// PACK CODES
+
+static size_t pack_codes_scalar(const unsigned char * data, size_t length, const struct huffman_codebook * book, struct bit_writer * writer, unsigned char * output)
+{
+    unsigned long long bits = writer->bits;
+    unsigned int count = writer->count;
+    unsigned int missing = 0;
+    size_t written = 0;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        /// FEWER THAN 8 BITS ARE WAITING, A CODE HAS AT MOST 56
+        bits |= book->code[data[i]] << count;
+        count += book->length[data[i]];
+        missing |= book->length[data[i]] == 0;
+
+        while (count >= 8)
+        {
+            output[written++] = (unsigned char)bits;
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    writer->bits = bits;
+    writer->count = count;
+    writer->missing |= missing;
+    return written;
+}
+
+/// DECODE CODES
+
+static int decode_codes_scalar(struct bit_reader * reader, const struct decode_table * table, unsigned char * output, size_t count)
+{
+    unsigned long long bits = reader->bits;
+    unsigned int available = reader->count;
+    size_t offset = reader->offset;
+    int result = STATUS_SUCCESS;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        while (available <= 56 && offset < reader->length)
+        {
+            bits |= (unsigned long long)reader->data[offset++] << available;
+            available += 8;
+        }
+
+        const struct decode_entry * entry = table->entries + (bits & ((1U << DECODE_TABLE_BITS) - 1));
+
+        if (entry->length > available)
+        {
+            result = CORRUPT_DATA;
+            break;
+        }
+
+        bits >>= entry->length;
+        available -= entry->length;
+
+        if (entry->link == 0)
+        {
+            output[i] = (unsigned char)entry->value;
+            continue;
+        }
+
+        /// CODE LONGER THAN THE TABLE, THE REST OF IT IS WALKED IN THE NODES
+        unsigned int child = entry->value;
+
+        do
+        {
+            if (available == 0 && offset < reader->length)
+            {
+                bits = reader->data[offset++];
+                available = 8;
+            }
+
+            if (available == 0)
+            {
+                result = CORRUPT_DATA;
+                break;
+            }
+
+            child = table->nodes[child][bits & 1];
+            bits >>= 1;
+            --available;
+        }
+        while ((child & DECODE_LEAF) == 0);
+
+        if (result != STATUS_SUCCESS)
+        {
+            break;
+        }
+
+        output[i] = (unsigned char)child;
+    }
+
+    reader->bits = bits;
+    reader->count = available;
+    reader->offset = offset;
+    return result;
+}
+
+#ifdef KERNELS_X86
+
+/// x86 IS LITTLE-ENDIAN: 8 BYTES ARE MOVED BETWEEN MEMORY AND THE BIT BUFFER AT ONCE
+
+static inline size_t flush_wide(unsigned long long * bits, unsigned int * count, unsigned char * output)
+{
+    size_t bytes = *count >> 3;
+
+    memcpy(output, bits, sizeof(unsigned long long));
+    *bits = bytes == 8 ? 0 : *bits >> (bytes << 3);
+    *count &= 7;
+    return bytes;
+}
+
+static size_t pack_codes_wide(const unsigned char * data, size_t length, const struct huffman_codebook * book, struct bit_writer * writer, unsigned char * output)
+{
+    unsigned long long bits = writer->bits;
+    unsigned int count = writer->count;
+    unsigned int missing = 0;
+    size_t written = 0;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        bits |= book->code[data[i]] << count;
+        count += book->length[data[i]];
+        missing |= book->length[data[i]] == 0;
+        written += flush_wide(&bits, &count, output + written);
+    }
+
+    writer->bits = bits;
+    writer->count = count;
+    writer->missing |= missing;
+    return written;
+}
+
+static int decode_codes_wide(struct bit_reader * reader, const struct decode_table * table, unsigned char * output, size_t count)
+{
+    unsigned long long bits = reader->bits;
+    unsigned int available = reader->count;
+    size_t offset = reader->offset;
+    size_t i = 0;
+
+    while (i < count && offset + 8 <= reader->length)
+    {
+        /// THE BITS LOADED PAST available ARE THE SAME THE NEXT LOAD BRINGS, SO OR-ING THEM AGAIN IS HARMLESS
+        if (available < 56)
+        {
+            unsigned long long word;
+
+            memcpy(&word, reader->data + offset, sizeof(unsigned long long));
+            bits |= word << available;
+            offset += (63 - available) >> 3;
+            available |= 56;
+        }
+
+        const struct decode_entry * entry = table->entries + (bits & ((1U << DECODE_TABLE_BITS) - 1));
+
+        if (entry->link != 0)
+        {
+            /// A LONG CODE IS WALKED BY THE SCALAR DECODER
+            reader->bits = bits;
+            reader->count = available;
+            reader->offset = offset;
+
+            if (decode_codes_scalar(reader, table, output + i++, 1) != STATUS_SUCCESS)
+            {
+                return CORRUPT_DATA;
+            }
+
+            bits = reader->bits;
+            available = reader->count;
+            offset = reader->offset;
+            continue;
+        }
+
+        bits >>= entry->length;
+        available -= entry->length;
+        output[i++] = (unsigned char)entry->value;
+    }
+
+    reader->bits = bits;
+    reader->count = available;
+    reader->offset = offset;
+
+    /// THE LAST BYTES ARE READ ONE BY ONE
+    return i == count ? STATUS_SUCCESS : decode_codes_scalar(reader, table, output + i, count - i);
+}
+
+/// SSE4.2
+
+__attribute__((target("sse4.2")))
+static void histogram_sse42(const unsigned char * data, size_t length, unsigned int counts[256])
+{
+    unsigned int partial[4][256];
+    size_t i = 0;
+
+    memset(partial, 0, sizeof(partial));
+
+    /// A BLOCK OF ONE REPEATED BYTE IS COUNTED AT ONCE
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8((char)data[i]))) == 0xFFFF)
+        {
+            partial[0][data[i]] += 16;
+        }
+        else
+        {
+            count_bytes(partial, data + i, 16);
+        }
+    }
+
+    count_bytes(partial, data + i, length - i);
+    merge_counts(partial, counts);
+}
+
+__attribute__((target("sse4.2")))
+static int compare_sse42(const void * first, const void * second, size_t length)
+{
+    const unsigned char * one = (const unsigned char *)first;
+    const unsigned char * two = (const unsigned char *)second;
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        unsigned int different = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(one + i)), _mm_loadu_si128((const __m128i *)(two + i)))) & 0xFFFF;
+
+        if (different != 0)
+        {
+            i += __builtin_ctz(different);
+            return one[i] < two[i] ? -1 : 1;
+        }
+    }
+
+    return compare_scalar(one + i, two + i, length - i);
+}
+
+__attribute__((target("sse4.2")))
+static size_t find_byte_sse42(const void * data, size_t length, unsigned char byte)
+{
+    const unsigned char * bytes = (const unsigned char *)data;
+    const __m128i needle = _mm_set1_epi8((char)byte);
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        unsigned int found = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(bytes + i)), needle));
+
+        if (found != 0)
+        {
+            return i + __builtin_ctz(found);
+        }
+    }
+
+    return i + find_byte_scalar(bytes + i, length - i, byte);
+}
+
+/// AVX2
+
+__attribute__((target("avx2")))
+static void histogram_avx2(const unsigned char * data, size_t length, unsigned int counts[256])
+{
+    unsigned int partial[4][256];
+    size_t i = 0;
+
+    memset(partial, 0, sizeof(partial));
+
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + i));
+
+        if ((unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8((char)data[i]))) == 0xFFFFFFFFU)
+        {
+            partial[0][data[i]] += 32;
+        }
+        else
+        {
+            count_bytes(partial, data + i, 32);
+        }
+    }
+
+    count_bytes(partial, data + i, length - i);
+    merge_counts(partial, counts);
+}
+
+__attribute__((target("avx2")))
+static int compare_avx2(const void * first, const void * second, size_t length)
+{
+    const unsigned char * one = (const unsigned char *)first;
+    const unsigned char * two = (const unsigned char *)second;
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32)
+    {
+        unsigned int different = ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(one + i)), _mm256_loadu_si256((const __m256i *)(two + i))));
+
+        if (different != 0)
+        {
+            i += __builtin_ctz(different);
+            return one[i] < two[i] ? -1 : 1;
+        }
+    }
+
+    return compare_sse42(one + i, two + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static size_t find_byte_avx2(const void * data, size_t length, unsigned char byte)
+{
+    const unsigned char * bytes = (const unsigned char *)data;
+    const __m256i needle = _mm256_set1_epi8((char)byte);
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32)
+    {
+        unsigned int found = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(bytes + i)), needle));
+
+        if (found != 0)
+        {
+            return i + __builtin_ctz(found);
+        }
+    }
+
+    return i + find_byte_sse42(bytes + i, length - i, byte);
+}
+
+__attribute__((target("avx2")))
+static size_t pack_codes_avx2(const unsigned char * data, size_t length, const struct huffman_codebook * book, struct bit_writer * writer, unsigned char * output)
+{
+    /// FOUR CODES OF AT MOST 14 BITS FIT NEXT TO THE 7 WAITING BITS IN ONE WORD
+    if (book->max_length > 14)
+    {
+        return pack_codes_wide(data, length, book, writer, output);
+    }
+
+    unsigned long long bits = writer->bits;
+    unsigned int count = writer->count;
+    unsigned int missing = 0;
+    size_t written = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= length; i += 4)
+    {
+        unsigned int indices;
+        memcpy(&indices, data + i, sizeof(unsigned int));
+
+        const unsigned int first = book->length[data[i]];
+        const unsigned int second = first + book->length[data[i + 1]];
+        const unsigned int third = second + book->length[data[i + 2]];
+        const unsigned int fourth = book->length[data[i + 3]];
+
+        missing |= (first == 0) | (second == first) | (third == second) | (fourth == 0);
+
+        /// GATHER THE 4 CODES, SHIFT EVERY ONE TO ITS OFFSET AND OR THEM TOGETHER
+        __m256i codes = _mm256_i32gather_epi64((const long long *)book->code, _mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)indices)), 8);
+        __m256i shifted = _mm256_sllv_epi64(codes, _mm256_set_epi64x(third, second, first, 0));
+        __m128i folded = _mm_or_si128(_mm256_castsi256_si128(shifted), _mm256_extracti128_si256(shifted, 1));
+
+        bits |= ((unsigned long long)_mm_cvtsi128_si64(folded) | (unsigned long long)_mm_extract_epi64(folded, 1)) << count;
+        count += third + fourth;
+        written += flush_wide(&bits, &count, output + written);
+    }
+
+    writer->bits = bits;
+    writer->count = count;
+    writer->missing |= missing;
+    return written + pack_codes_wide(data + i, length - i, book, writer, output + written);
+}
+
+/// AVX-512
+
+__attribute__((target("avx512f,avx512bw")))
+static void histogram_avx512(const unsigned char * data, size_t length, unsigned int counts[256])
+{
+    unsigned int partial[4][256];
+    size_t i = 0;
+
+    memset(partial, 0, sizeof(partial));
+
+    for (; i + 64 <= length; i += 64)
+    {
+        __m512i block = _mm512_loadu_si512((const void *)(data + i));
+
+        if (_mm512_cmpeq_epi8_mask(block, _mm512_set1_epi8((char)data[i])) == ~0ULL)
+        {
+            partial[0][data[i]] += 64;
+        }
+        else
+        {
+            count_bytes(partial, data + i, 64);
+        }
+    }
+
+    count_bytes(partial, data + i, length - i);
+    merge_counts(partial, counts);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static int compare_avx512(const void * first, const void * second, size_t length)
+{
+    const unsigned char * one = (const unsigned char *)first;
+    const unsigned char * two = (const unsigned char *)second;
+    size_t i = 0;
+
+    for (; i + 64 <= length; i += 64)
+    {
+        unsigned long long different = _mm512_cmpneq_epi8_mask(_mm512_loadu_si512((const void *)(one + i)), _mm512_loadu_si512((const void *)(two + i)));
+
+        if (different != 0)
+        {
+            i += __builtin_ctzll(different);
+            return one[i] < two[i] ? -1 : 1;
+        }
+    }
+
+    return compare_avx2(one + i, two + i, length - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t find_byte_avx512(const void * data, size_t length, unsigned char byte)
+{
+    const unsigned char * bytes = (const unsigned char *)data;
+    const __m512i needle = _mm512_set1_epi8((char)byte);
+    size_t i = 0;
+
+    for (; i + 64 <= length; i += 64)
+    {
+        unsigned long long found = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void *)(bytes + i)), needle);
+
+        if (found != 0)
+        {
+            return i + __builtin_ctzll(found);
+        }
+    }
+
+    return i + find_byte_avx2(bytes + i, length - i, byte);
+}
+
+__attribute__((target("avx512f,avx512bw,avx2")))
+static size_t pack_codes_avx512(const unsigned char * data, size_t length, const struct huffman_codebook * book, struct bit_writer * writer, unsigned char * output)
+{
+    /// EIGHT CODES OF AT MOST 7 BITS FIT NEXT TO THE 7 WAITING BITS IN ONE WORD
+    if (book->max_length > 7)
+    {
+        return pack_codes_avx2(data, length, book, writer, output);
+    }
+
+    unsigned long long bits = writer->bits;
+    unsigned int count = writer->count;
+    unsigned int missing = 0;
+    size_t written = 0;
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8)
+    {
+        long long offsets[8];
+        unsigned int total = 0;
+
+        for (unsigned int lane = 0; lane < 8; ++lane)
+        {
+            offsets[lane] = total;
+            total += book->length[data[i + lane]];
+            missing |= book->length[data[i + lane]] == 0;
+        }
+
+        __m512i codes = _mm512_i32gather_epi64(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(data + i))), (const void *)book->code, 8);
+        __m512i shifted = _mm512_sllv_epi64(codes, _mm512_loadu_si512((const void *)offsets));
+
+        bits |= (unsigned long long)_mm512_reduce_or_epi64(shifted) << count;
+        count += total;
+        written += flush_wide(&bits, &count, output + written);
+    }
+
+    writer->bits = bits;
+    writer->count = count;
+    writer->missing |= missing;
+    return written + pack_codes_wide(data + i, length - i, book, writer, output + written);
+}
+
+static const struct cpu_kernels variants[CPU_VARIANT_COUNT] =
+{
+    { CPU_SCALAR, histogram_scalar, compare_scalar, find_byte_scalar, pack_codes_scalar, decode_codes_scalar },
+    { CPU_SSE42, histogram_sse42, compare_sse42, find_byte_sse42, pack_codes_wide, decode_codes_wide },
+    { CPU_AVX2, histogram_avx2, compare_avx2, find_byte_avx2, pack_codes_avx2, decode_codes_wide },
+    { CPU_AVX512, histogram_avx512, compare_avx512, find_byte_avx512, pack_codes_avx512, decode_codes_wide }
+};
+
+#else
+
+static const struct cpu_kernels variants[CPU_VARIANT_COUNT] =
+{
+    { CPU_SCALAR, histogram_scalar, compare_scalar, find_byte_scalar, pack_codes_scalar, decode_codes_scalar }
+};
+
+#endif // KERNELS_X86
+
+static const struct cpu_kernels * selected_kernels = NULL;
+static pthread_once_t selection = PTHREAD_ONCE_INIT;
+
+enum cpu_variant detect_cpu_variant(void)
+{
+#ifdef KERNELS_X86
+    /// __builtin_cpu_supports READS CPUID AND CHECKS THAT THE OPERATING SYSTEM SAVES THE REGISTERS
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        return CPU_AVX512;
+    }
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return CPU_AVX2;
+    }
+
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        return CPU_SSE42;
+    }
+#endif
+
+    return CPU_SCALAR;
+}
+
+static void select_kernels(void)
+{
+    enum cpu_variant variant = detect_cpu_variant();
+    const char * forced = getenv("SHANNON_CPU");
+
+    if (forced != NULL && parse_cpu_variant(forced) < variant)
+    {
+        variant = parse_cpu_variant(forced);
+    }
+
+    selected_kernels = variants + variant;
+}
+
+const struct cpu_kernels * cpu_kernels(void)
+{
+    pthread_once(&selection, select_kernels);
+    return selected_kernels;
+}
+
+int force_cpu_variant(const enum cpu_variant variant)
+{
+    pthread_once(&selection, select_kernels);
+
+    if (variant >= CPU_VARIANT_COUNT || variant > detect_cpu_variant())
+    {
+        return INVALID_TYPE;
+    }
+
+    selected_kernels = variants + variant;
+    return STATUS_SUCCESS;
+}
+
+const char * cpu_variant_name(const enum cpu_variant variant)
+{
+    return variant < CPU_VARIANT_COUNT ? variant_names[variant] : "unknown";
+}
+
+enum cpu_variant parse_cpu_variant(const char * name)
+{
+    for (unsigned int variant = 0; name != NULL && variant < CPU_VARIANT_COUNT; ++variant)
+    {
+        if (strcmp(name, variant_names[variant]) == 0)
+        {
+            return (enum cpu_variant)variant;
+        }
+    }
+
+    return CPU_VARIANT_COUNT;
+}
+
+static unsigned char leaf_symbol(const struct node * const node)
+{
+    return node->info.sequence == NULL || node->info.length == 0 ? 0 : *(const unsigned char *)node->info.sequence;
+}
+
+static bool is_leaf(const struct node * const node)
+{
+    return node->left_child == NULL || node->right_child == NULL;
+}
+
+static int add_nodes(struct decode_table * table, const struct node * node, unsigned int * index)
+{
+    /// A CHILD IS A SYMBOL OR THE INDEX OF A NODE ADDED AFTER ITS PARENT
+    if (table->node_count == DECODE_MAX_NODES)
+    {
+        return CORRUPT_DATA;
+    }
+
+    *index = table->node_count++;
+
+    const struct node * children[2] = { node->left_child, node->right_child };
+
+    for (unsigned int bit = 0; bit < 2; ++bit)
+    {
+        unsigned int child;
+
+        if (is_leaf(children[bit]))
+        {
+            child = DECODE_LEAF | leaf_symbol(children[bit]);
+        }
+        else if (add_nodes(table, children[bit], &child) != STATUS_SUCCESS)
+        {
+            return CORRUPT_DATA;
+        }
+
+        table->nodes[*index][bit] = (unsigned short)child;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+static int fill_entries(struct decode_table * table, const struct node * node, const unsigned int code, const unsigned int depth)
+{
+    if (is_leaf(node))
+    {
+        /// EVERY INDEX WHOSE LOW depth BITS ARE THE CODE
+        for (unsigned int index = code; index < (1U << DECODE_TABLE_BITS); index += 1U << depth)
+        {
+            table->entries[index].value = leaf_symbol(node);
+            table->entries[index].length = (unsigned char)depth;
+            table->entries[index].link = 0;
+        }
+        return STATUS_SUCCESS;
+    }
+
+    if (depth == DECODE_TABLE_BITS)
+    {
+        unsigned int index;
+        int result = add_nodes(table, node, &index);
+
+        table->entries[code].value = (unsigned short)index;
+        table->entries[code].length = DECODE_TABLE_BITS;
+        table->entries[code].link = 1;
+        return result;
+    }
+
+    int result = fill_entries(table, node->left_child, code, depth + 1);
+    return result != STATUS_SUCCESS ? result : fill_entries(table, node->right_child, code | 1U << depth, depth + 1);
+}
+
+int build_decode_table(const struct node * const huffman_root, struct decode_table * table)
+{
+    if (huffman_root == NULL || table == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memset(table, 0, sizeof(struct decode_table));
+    table->single_symbol = is_leaf(huffman_root);
+    return fill_entries(table, huffman_root, 0, 0);
+}
@@ -0,0 +1,145 @@
+#ifndef _KERNELS_H_
+#define _KERNELS_H_
+#include <stddef.h>
+#include "avl_tree.h"
+
+/// CODES UP TO THIS LENGTH ARE DECODED WITH ONE LOOKUP, LONGER ONES CONTINUE IN THE TREE
+#define DECODE_TABLE_BITS 10
+
+/// BYTES OF SLACK THE PACKER MAY WRITE PAST THE LAST FULL BYTE
+#define PACK_SLACK 8
+
+enum cpu_variant
+{
+    CPU_SCALAR = 0,
+    CPU_SSE42  = 1,
+    CPU_AVX2   = 2,
+    CPU_AVX512 = 3,
+    CPU_VARIANT_COUNT = 4
+};
+
+struct huffman_codebook
+{
+    /// CODE OF EVERY BYTE, FIRST BIT IN BIT 0, AND ITS LENGTH IN BITS
+    unsigned long long code[256];
+    unsigned int length[256];
+    unsigned int max_length;
+};
+
+struct bit_writer
+{
+    /// BITS NOT WRITTEN YET (FEWER THAN 8 BETWEEN CALLS)
+    unsigned long long bits;
+    unsigned int count;
+
+    /// SET WHEN A BYTE WITHOUT A CODE (LENGTH 0) WAS PACKED
+    unsigned int missing;
+};
+
+/// MOST NODES THE TREE BELOW THE TABLE CAN HAVE (ONE LESS THAN THE BYTE VALUES)
+#define DECODE_MAX_NODES 256
+
+/// CHILD OF A NODE THAT IS A SYMBOL (LOW 8 BITS) AND NOT THE INDEX OF ANOTHER NODE
+#define DECODE_LEAF 0x8000
+
+struct decode_entry
+{
+    /// THE SYMBOL OF A CODE OF length BITS, OR (link != 0) THE NODE TO CONTINUE FROM
+    unsigned short value;
+    unsigned char length;
+    unsigned char link;
+};
+
+/// NO POINTERS: THE TABLE CAN BE STORED IN A FILE AND MAPPED AS IT IS
+struct decode_table
+{
+    struct decode_entry entries[1 << DECODE_TABLE_BITS];
+
+    /// CHILDREN (0 FOR BIT 0, 1 FOR BIT 1) OF THE NODES DEEPER THAN DECODE_TABLE_BITS
+    unsigned short nodes[DECODE_MAX_NODES][2];
+    unsigned int node_count;
+
+    /// SET WHEN THE TREE IS ONE LEAF, EVERY CODE IS 0 BITS LONG
+    unsigned int single_symbol;
+};
+
+struct bit_reader
+{
+    const unsigned char * data;
+    size_t length;
+    size_t offset;
+
+    /// BITS READ FROM data BUT NOT DECODED YET
+    unsigned long long bits;
+    unsigned int count;
+};
+
+struct cpu_kernels
+{
+    enum cpu_variant variant;
+
+    /// ADDS THE NUMBER OF EVERY BYTE VALUE TO counts
+    void (*histogram)(const unsigned char * data, size_t length, unsigned int counts[256]);
+
+    /// SAME RESULT SIGN AS memcmp
+    int (*compare)(const void * first, const void * second, size_t length);
+
+    /// INDEX OF THE FIRST byte IN data, length WHEN THERE IS NONE
+    size_t (*find_byte)(const void * data, size_t length, unsigned char byte);
+
+    /// APPENDS THE CODES OF data TO output, RETURNS THE NUMBER OF FULL BYTES WRITTEN
+    size_t (*pack_codes)(const unsigned char * data, size_t length, const struct huffman_codebook * book, struct bit_writer * writer, unsigned char * output);
+
+    /// DECODES count SYMBOLS TO output, CORRUPT_DATA WHEN THE BITS RUN OUT
+    int (*decode_codes)(struct bit_reader * reader, const struct decode_table * table, unsigned char * output, size_t count);
+};
+
+/**
+*   The variant is chosen once, on the first call, from the CPU (CPUID). The
+*   environment variable SHANNON_CPU (scalar, sse4.2, avx2 or avx512) forces a
+*   lower one, e.g. to cross-check the results of the variants.
+*
+*   @RETURN
+*   Kernels of the selected variant
+*/
+const struct cpu_kernels * cpu_kernels(void);
+
+/**
+*   @RETURN
+*   Best variant the CPU and the operating system support
+*/
+enum cpu_variant detect_cpu_variant(void);
+
+/**
+*   Test mode: makes cpu_kernels return the kernels of the given variant.
+*   Must not be called while other threads are coding.
+*
+*   @PARAMS
+*   variant - Variant to use
+*
+*   @RETURN
+*   INVALID_TYPE   - The CPU does not support the variant
+*   STATUS_SUCCESS - Variant is in use
+*/
+int force_cpu_variant(const enum cpu_variant variant);
+
+const char * cpu_variant_name(const enum cpu_variant variant);
+
+/**
+*   @RETURN
+*   The variant with this name (see cpu_kernels), CPU_VARIANT_COUNT if there is none
+*/
+enum cpu_variant parse_cpu_variant(const char * name);
+
+/**
+*   Fills the lookup table of the decoder from the Huffman tree. The first byte
+*   of the sequence of a leaf is its symbol.
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   CORRUPT_DATA   - The tree has more than DECODE_MAX_NODES nodes below the table
+*   STATUS_SUCCESS - Table was built
+*/
+int build_decode_table(const struct node * const huffman_root, struct decode_table * table);
+
+#endif // _KERNELS_H_
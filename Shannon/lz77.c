@@ -0,0 +1,594 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "huffman.h"
+#include "lz77.h"
+#include <string.h>
+
+/// HEADS OF THE HASH CHAINS OF THE 3 BYTE PREFIXES
+#define LZ_HASH_BITS 15
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)
+
+/// A CODE IS DECODED WITH ONE LOOKUP OF ITS LONGEST LENGTH
+#define LZ_DECODE_SIZE (1 << LZ_MAX_CODE_LENGTH)
+
+static const unsigned short length_bases[29] =
+{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const unsigned char length_extra[29] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const unsigned short distance_bases[LZ_DISTANCE_SYMBOLS] =
+{
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const unsigned char distance_extra[LZ_DISTANCE_SYMBOLS] =
+{
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+struct lz_level
+{
+    /// CANDIDATES A SEARCH FOLLOWS, THE LENGTH THAT ENDS IT AND THE LONGEST MATCH STILL
+    /// WORTH LOOKING ONE BYTE FURTHER FOR A LONGER ONE (0 = GREEDY)
+    unsigned short chain;
+    unsigned short nice;
+    unsigned short lazy;
+};
+
+/// THE TRADE-OFFS OF THE LEVELS OF zlib
+static const struct lz_level levels[LZ_MAX_LEVEL] =
+{
+    { 4, 8, 0 }, { 8, 16, 0 }, { 32, 32, 0 },
+    { 16, 16, 4 }, { 32, 32, 16 }, { 128, 128, 16 },
+    { 256, 128, 32 }, { 1024, 258, 128 }, { 4096, 258, 258 }
+};
+
+struct lz_finder
+{
+    /// LAST POSITION OF EVERY HASH AND THE POSITION BEFORE IT WITH THE SAME HASH
+    int * head;
+    int * previous;
+
+    /// FIRST POSITION NOT IN THE CHAINS YET
+    unsigned int next;
+};
+
+static unsigned int prefix_hash(const unsigned char * bytes)
+{
+    return ((bytes[0] | bytes[1] << 8 | (unsigned int)bytes[2] << 16) * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+static void insert_until(struct lz_finder * finder, const unsigned char * data, const unsigned int length, const unsigned int end)
+{
+    for (; finder->next < end; ++finder->next)
+    {
+        if (finder->next + LZ_MIN_MATCH <= length)
+        {
+            const unsigned int hash = prefix_hash(data + finder->next);
+
+            finder->previous[finder->next & (LZ_WINDOW - 1)] = finder->head[hash];
+            finder->head[hash] = (int)finder->next;
+        }
+    }
+}
+
+static unsigned int longest_match(const struct lz_finder * finder, const unsigned char * data, const unsigned int length, const unsigned int position,
+                                  const struct lz_level * level, unsigned int * distance)
+{
+    if (position + LZ_MIN_MATCH > length)
+    {
+        return 0;
+    }
+
+    const unsigned int limit = length - position < LZ_MAX_MATCH ? length - position : LZ_MAX_MATCH;
+    const unsigned char * current = data + position;
+    unsigned int best = LZ_MIN_MATCH - 1;
+    int candidate = finder->head[prefix_hash(current)];
+
+    for (unsigned int chain = level->chain; candidate >= 0 && chain > 0 && position - (unsigned int)candidate < LZ_WINDOW; --chain)
+    {
+        const unsigned char * earlier = data + candidate;
+
+        /// THE BYTE THAT WOULD MAKE THE MATCH LONGER THAN THE BEST ONE IS CHECKED FIRST
+        if (earlier[best] == current[best] && earlier[0] == current[0] && earlier[1] == current[1])
+        {
+            unsigned int matched = 2;
+
+            while (matched < limit && earlier[matched] == current[matched])
+            {
+                ++matched;
+            }
+
+            if (matched > best)
+            {
+                best = matched;
+                *distance = position - (unsigned int)candidate;
+
+                if (best >= level->nice || best == limit)
+                {
+                    break;
+                }
+            }
+        }
+
+        /// A SLOT TAKEN OVER BY A NEWER POSITION ENDS THE CHAIN
+        const int next = finder->previous[candidate & (LZ_WINDOW - 1)];
+
+        if (next >= candidate)
+        {
+            break;
+        }
+        candidate = next;
+    }
+
+    return best >= LZ_MIN_MATCH ? best : 0;
+}
+
+static void add_token(struct lz_tokens * tokens, const unsigned int length, const unsigned int value)
+{
+    tokens->tokens[tokens->count].length = (unsigned short)length;
+    tokens->tokens[tokens->count].value = (unsigned short)value;
+    ++tokens->count;
+}
+
+int lz_parse(const unsigned char * data, const unsigned int length, const unsigned int level, struct lz_tokens * tokens)
+{
+    if (data == NULL || tokens == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    const struct lz_level * settings = levels + (level < LZ_MIN_LEVEL ? LZ_MIN_LEVEL : level > LZ_MAX_LEVEL ? LZ_MAX_LEVEL : level) - 1;
+    struct lz_finder finder;
+
+    /// EVERY TOKEN TAKES AT LEAST ONE BYTE
+    tokens->count = 0;
+    tokens->capacity = length;
+    tokens->tokens = (struct lz_token *)memory_alloc((length == 0 ? 1 : (size_t)length) * sizeof(struct lz_token));
+    finder.head = (int *)memory_alloc(LZ_HASH_SIZE * sizeof(int));
+    finder.previous = (int *)memory_alloc(LZ_WINDOW * sizeof(int));
+    finder.next = 0;
+
+    if (tokens->tokens == NULL || finder.head == NULL || finder.previous == NULL)
+    {
+        memory_free(finder.head);
+        memory_free(finder.previous);
+        clean_lz_tokens(tokens);
+        return BAD_MEMORY_ALLOC;
+    }
+
+    memset(finder.head, 0xFF, LZ_HASH_SIZE * sizeof(int));
+
+    for (unsigned int position = 0; position < length; )
+    {
+        unsigned int distance = 0;
+        unsigned int matched;
+
+        insert_until(&finder, data, length, position);
+        matched = longest_match(&finder, data, length, position, settings, &distance);
+
+        /// LAZY MATCHING: A LONGER MATCH ONE BYTE FURTHER TURNS THE CURRENT BYTE INTO A LITERAL
+        while (matched != 0 && matched < settings->lazy && position + 1 < length)
+        {
+            unsigned int next_distance = 0;
+            unsigned int next_matched;
+
+            insert_until(&finder, data, length, position + 1);
+            next_matched = longest_match(&finder, data, length, position + 1, settings, &next_distance);
+
+            if (next_matched <= matched)
+            {
+                break;
+            }
+
+            add_token(tokens, 0, data[position++]);
+            matched = next_matched;
+            distance = next_distance;
+        }
+
+        if (matched != 0)
+        {
+            add_token(tokens, matched, distance);
+            position += matched;
+        }
+        else
+        {
+            add_token(tokens, 0, data[position++]);
+        }
+    }
+
+    memory_free(finder.head);
+    memory_free(finder.previous);
+    return STATUS_SUCCESS;
+}
+
+int clean_lz_tokens(struct lz_tokens * tokens)
+{
+    if (tokens == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memory_free(tokens->tokens);
+    tokens->tokens = NULL;
+    tokens->count = 0;
+    tokens->capacity = 0;
+    return STATUS_SUCCESS;
+}
+
+/// INDEX OF THE LAST BASE NOT ABOVE value
+static unsigned int find_base(const unsigned short * bases, const unsigned int count, const unsigned int value)
+{
+    unsigned int low = 0;
+    unsigned int high = count - 1;
+
+    while (low < high)
+    {
+        const unsigned int middle = (low + high + 1) / 2;
+
+        if (bases[middle] <= value)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+unsigned int lz_length_symbol(const unsigned int length, unsigned int * extra_bits, unsigned int * extra)
+{
+    const unsigned int index = find_base(length_bases, 29, length);
+
+    *extra_bits = length_extra[index];
+    *extra = length - length_bases[index];
+    return LZ_END_OF_DATA + 1 + index;
+}
+
+unsigned int lz_distance_symbol(const unsigned int distance, unsigned int * extra_bits, unsigned int * extra)
+{
+    const unsigned int index = find_base(distance_bases, LZ_DISTANCE_SYMBOLS, distance);
+
+    *extra_bits = distance_extra[index];
+    *extra = distance - distance_bases[index];
+    return index;
+}
+
+int lz_canonical_codes(const unsigned char * lengths, const unsigned int symbol_count, unsigned short * codes)
+{
+    if (lengths == NULL || codes == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned int counts[LZ_MAX_CODE_LENGTH + 1];
+    unsigned int next[LZ_MAX_CODE_LENGTH + 1];
+    int left = 1;
+
+    memset(counts, 0, sizeof(counts));
+
+    for (unsigned int symbol = 0; symbol < symbol_count; ++symbol)
+    {
+        if (lengths[symbol] > LZ_MAX_CODE_LENGTH)
+        {
+            return CORRUPT_DATA;
+        }
+        ++counts[lengths[symbol]];
+    }
+
+    /// THE FIRST CODE OF EVERY LENGTH FOLLOWS THE CODES OF THE SHORTER ONES
+    counts[0] = 0;
+    next[0] = 0;
+
+    for (unsigned int bits = 1; bits <= LZ_MAX_CODE_LENGTH; ++bits)
+    {
+        next[bits] = (next[bits - 1] + counts[bits - 1]) << 1;
+        left = (left << 1) - (int)counts[bits];
+
+        if (left < 0)
+        {
+            return CORRUPT_DATA;
+        }
+    }
+
+    for (unsigned int symbol = 0; symbol < symbol_count; ++symbol)
+    {
+        const unsigned int bits = lengths[symbol];
+        unsigned int code = bits == 0 ? 0 : next[bits]++;
+        unsigned int reversed = 0;
+
+        for (unsigned int i = 0; i < bits; ++i, code >>= 1)
+        {
+            reversed = reversed << 1 | (code & 1);
+        }
+
+        codes[symbol] = (unsigned short)reversed;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int lz_compress(const void * data, const unsigned int length, const unsigned int level, void ** coded, unsigned int * coded_length)
+{
+    if (data == NULL || coded == NULL || coded_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct lz_tokens tokens;
+    unsigned int counts[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    unsigned char lengths[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    unsigned short codes[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    unsigned int * distance_counts = counts + LZ_LITERAL_SYMBOLS;
+    unsigned long long bits = 0;
+    unsigned int extra_bits;
+    unsigned int extra;
+    int result;
+
+    if ((result = lz_parse((const unsigned char *)data, length, level, &tokens)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    memset(counts, 0, sizeof(counts));
+    ++counts[LZ_END_OF_DATA];
+
+    for (unsigned int i = 0; i < tokens.count; ++i)
+    {
+        const struct lz_token * token = tokens.tokens + i;
+
+        if (token->length == 0)
+        {
+            ++counts[token->value];
+            continue;
+        }
+
+        ++counts[lz_length_symbol(token->length, &extra_bits, &extra)];
+        bits += extra_bits;
+        ++distance_counts[lz_distance_symbol(token->value, &extra_bits, &extra)];
+        bits += extra_bits;
+    }
+
+    if ((result = huffman_code_lengths(counts, LZ_LITERAL_SYMBOLS, LZ_MAX_CODE_LENGTH, lengths)) == STATUS_SUCCESS
+            && (result = huffman_code_lengths(distance_counts, LZ_DISTANCE_SYMBOLS, LZ_MAX_CODE_LENGTH, lengths + LZ_LITERAL_SYMBOLS)) == STATUS_SUCCESS
+            && (result = lz_canonical_codes(lengths, LZ_LITERAL_SYMBOLS, codes)) == STATUS_SUCCESS)
+    {
+        result = lz_canonical_codes(lengths + LZ_LITERAL_SYMBOLS, LZ_DISTANCE_SYMBOLS, codes + LZ_LITERAL_SYMBOLS);
+    }
+
+    /// THE EXACT SIZE OF THE BITS: THE EXTRA BITS AND THE CODES OF EVERY SYMBOL
+    for (unsigned int symbol = 0; symbol < LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS; ++symbol)
+    {
+        bits += (unsigned long long)counts[symbol] * lengths[symbol];
+    }
+
+    const unsigned long long total = LZ_TABLE_SIZE + (bits + 7) / 8;
+
+    if (result == STATUS_SUCCESS && (total > 0xFFFFFFFFULL || (*coded = (void *)memory_alloc((size_t)total)) == NULL))
+    {
+        result = BAD_MEMORY_ALLOC;
+    }
+
+    if (result == STATUS_SUCCESS)
+    {
+        struct lz_writer writer = { (unsigned char *)*coded, 0, 0 };
+
+        for (unsigned int i = 0; i < LZ_TABLE_SIZE; ++i)
+        {
+            *writer.output++ = (unsigned char)(lengths[2 * i] | lengths[2 * i + 1] << 4);
+        }
+
+        for (unsigned int i = 0; i < tokens.count; ++i)
+        {
+            const struct lz_token * token = tokens.tokens + i;
+
+            if (token->length == 0)
+            {
+                lz_put_bits(&writer, codes[token->value], lengths[token->value]);
+                continue;
+            }
+
+            const unsigned int length_symbol = lz_length_symbol(token->length, &extra_bits, &extra);
+
+            lz_put_bits(&writer, codes[length_symbol], lengths[length_symbol]);
+            lz_put_bits(&writer, extra, extra_bits);
+
+            const unsigned int distance_symbol = LZ_LITERAL_SYMBOLS + lz_distance_symbol(token->value, &extra_bits, &extra);
+
+            lz_put_bits(&writer, codes[distance_symbol], lengths[distance_symbol]);
+            lz_put_bits(&writer, extra, extra_bits);
+        }
+
+        lz_put_bits(&writer, codes[LZ_END_OF_DATA], lengths[LZ_END_OF_DATA]);
+        lz_put_bits(&writer, 0, 7);
+
+        *coded_length = (unsigned int)total;
+    }
+
+    clean_lz_tokens(&tokens);
+    return result;
+}
+
+static int build_lookup(const unsigned char * lengths, const unsigned int symbol_count, unsigned short * lookup)
+{
+    unsigned short codes[LZ_LITERAL_SYMBOLS];
+    int result;
+
+    if ((result = lz_canonical_codes(lengths, symbol_count, codes)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    /// EVERY ENTRY WHOSE LOW BITS ARE A CODE HOLDS ITS SYMBOL AND LENGTH, THE OTHERS STAY 0 (NO CODE)
+    memset(lookup, 0, LZ_DECODE_SIZE * sizeof(unsigned short));
+
+    for (unsigned int symbol = 0; symbol < symbol_count; ++symbol)
+    {
+        if (lengths[symbol] != 0)
+        {
+            for (unsigned int entry = codes[symbol]; entry < LZ_DECODE_SIZE; entry += 1U << lengths[symbol])
+            {
+                lookup[entry] = (unsigned short)(symbol << 4 | lengths[symbol]);
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+struct lz_reader
+{
+    const unsigned char * data;
+    unsigned int length;
+    unsigned int offset;
+
+    /// BITS READ FROM data BUT NOT DECODED YET, ZEROS PAST ITS END
+    unsigned long long bits;
+    unsigned int count;
+};
+
+static void refill(struct lz_reader * reader)
+{
+    while (reader->count <= 56)
+    {
+        const unsigned long long byte = reader->offset < reader->length ? reader->data[reader->offset] : 0;
+
+        reader->bits |= byte << reader->count;
+        reader->count += 8;
+        ++reader->offset;
+    }
+}
+
+static unsigned int take_bits(struct lz_reader * reader, const unsigned int count)
+{
+    const unsigned int value = (unsigned int)(reader->bits & ((1ULL << count) - 1));
+
+    reader->bits >>= count;
+    reader->count -= count;
+    return value;
+}
+
+int lz_decompress(const void * coded, const unsigned int coded_length, void * output, const unsigned int length)
+{
+    if (coded == NULL || output == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (coded_length < LZ_TABLE_SIZE)
+    {
+        return CORRUPT_DATA;
+    }
+
+    const unsigned char * input = (const unsigned char *)coded;
+    unsigned char lengths[LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS];
+    unsigned short * lookup = (unsigned short *)memory_alloc(2 * LZ_DECODE_SIZE * sizeof(unsigned short));
+    unsigned short * distance_lookup = lookup + LZ_DECODE_SIZE;
+    int result;
+
+    if (lookup == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    for (unsigned int i = 0; i < LZ_TABLE_SIZE; ++i)
+    {
+        lengths[2 * i] = input[i] & 15;
+        lengths[2 * i + 1] = input[i] >> 4;
+    }
+
+    if ((result = build_lookup(lengths, LZ_LITERAL_SYMBOLS, lookup)) != STATUS_SUCCESS
+            || (result = build_lookup(lengths + LZ_LITERAL_SYMBOLS, LZ_DISTANCE_SYMBOLS, distance_lookup)) != STATUS_SUCCESS)
+    {
+        memory_free(lookup);
+        return result;
+    }
+
+    struct lz_reader reader = { input + LZ_TABLE_SIZE, coded_length - LZ_TABLE_SIZE, 0, 0, 0 };
+    unsigned char * data = (unsigned char *)output;
+    unsigned int written = 0;
+
+    for (;;)
+    {
+        refill(&reader);
+
+        unsigned int entry = lookup[reader.bits & (LZ_DECODE_SIZE - 1)];
+        unsigned int symbol = entry >> 4;
+
+        if ((entry & 15) == 0)
+        {
+            result = CORRUPT_DATA;
+            break;
+        }
+
+        take_bits(&reader, entry & 15);
+
+        if (symbol < LZ_END_OF_DATA)
+        {
+            if (written == length)
+            {
+                result = CORRUPT_DATA;
+                break;
+            }
+
+            data[written++] = (unsigned char)symbol;
+            continue;
+        }
+
+        if (symbol == LZ_END_OF_DATA)
+        {
+            break;
+        }
+
+        /// 29 LENGTH SYMBOLS, 286 AND 287 ARE NOT USED
+        if ((symbol -= LZ_END_OF_DATA + 1) >= 29)
+        {
+            result = CORRUPT_DATA;
+            break;
+        }
+
+        const unsigned int matched = length_bases[symbol] + take_bits(&reader, length_extra[symbol]);
+
+        refill(&reader);
+        entry = distance_lookup[reader.bits & (LZ_DECODE_SIZE - 1)];
+        symbol = entry >> 4;
+
+        if ((entry & 15) == 0)
+        {
+            result = CORRUPT_DATA;
+            break;
+        }
+
+        take_bits(&reader, entry & 15);
+
+        const unsigned int distance = distance_bases[symbol] + take_bits(&reader, distance_extra[symbol]);
+
+        if (distance > written || matched > length - written)
+        {
+            result = CORRUPT_DATA;
+            break;
+        }
+
+        /// THE COPY MAY OVERLAP THE BYTES IT WRITES, IT GOES ONE BYTE AT A TIME
+        for (unsigned int i = 0; i < matched; ++i, ++written)
+        {
+            data[written] = data[written - distance];
+        }
+    }
+
+    /// THE LAST CODE MUST END INSIDE THE DATA
+    if (result == STATUS_SUCCESS && (written != length || (unsigned long long)reader.offset * 8 - reader.count > (unsigned long long)reader.length * 8))
+    {
+        result = CORRUPT_DATA;
+    }
+
+    memory_free(lookup);
+    return result;
+}
@@ -0,0 +1,159 @@
+#ifndef _LZ77_H_
+#define _LZ77_H_
+
+/// A MATCH POINTS AT MOST LZ_WINDOW - 1 BYTES BACK AND COPIES LZ_MIN_MATCH TO LZ_MAX_MATCH BYTES
+#define LZ_WINDOW    32768
+#define LZ_MIN_MATCH 3
+#define LZ_MAX_MATCH 258
+
+/// THE ALPHABETS OF DEFLATE: THE BYTES, THE END OF THE DATA AND 29 LENGTH CODES, THEN 30 DISTANCE CODES
+#define LZ_LITERAL_SYMBOLS  286
+#define LZ_DISTANCE_SYMBOLS 30
+#define LZ_END_OF_DATA      256
+#define LZ_MAX_CODE_LENGTH  15
+
+/// THE CODED DATA STARTS WITH THE CODE LENGTHS OF BOTH ALPHABETS, TWO PER BYTE (THE FIRST IN THE LOW HALF)
+#define LZ_TABLE_SIZE ((LZ_LITERAL_SYMBOLS + LZ_DISTANCE_SYMBOLS) / 2)
+
+/// LEVELS OF THE MATCH FINDER, FROM THE SHORTEST HASH CHAINS TO THE LONGEST ONES WITH LAZY MATCHING
+#define LZ_MIN_LEVEL     1
+#define LZ_MAX_LEVEL     9
+#define DEFAULT_LZ_LEVEL 6
+
+struct lz_token
+{
+    /// 0 FOR A LITERAL (THE BYTE IN value), OTHERWISE A MATCH OF length BYTES value BYTES BACK
+    unsigned short length;
+    unsigned short value;
+};
+
+struct lz_tokens
+{
+    struct lz_token * tokens;
+    unsigned int count;
+    unsigned int capacity;
+};
+
+struct lz_writer
+{
+    unsigned char * output;
+
+    /// BITS NOT WRITTEN YET (FEWER THAN 8 BETWEEN CALLS)
+    unsigned long long bits;
+    unsigned int count;
+};
+
+/// APPENDS THE count LOW BITS OF value (AT MOST 32), THE FIRST IN BIT 0, AND WRITES THE WHOLE BYTES
+static inline void lz_put_bits(struct lz_writer * writer, const unsigned int value, const unsigned int count)
+{
+    writer->bits |= (unsigned long long)value << writer->count;
+    writer->count += count;
+
+    while (writer->count >= 8)
+    {
+        *writer->output++ = (unsigned char)writer->bits;
+        writer->bits >>= 8;
+        writer->count -= 8;
+    }
+}
+
+/**
+*   Greedy (levels 1 to 3) or lazy (levels 4 to 9) parse of the data into
+*   literals and matches. The last LZ_WINDOW bytes are searched through hash
+*   chains of 3 byte prefixes, the level sets how many candidates a search
+*   follows and which match is long enough to stop at.
+*
+*   @PARAMS
+*   data   - Memory address of data
+*   length - In bytes
+*   level  - LZ_MIN_LEVEL to LZ_MAX_LEVEL, others are clamped
+*   tokens - Receives the tokens (allocated), clean them with clean_lz_tokens
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the chains or the tokens
+*   STATUS_SUCCESS   - tokens holds the parse
+*/
+int lz_parse(const unsigned char * data, const unsigned int length, const unsigned int level, struct lz_tokens * tokens);
+
+/**
+*   @PARAMS
+*   tokens - Tokens of lz_parse
+*
+*   @RETURN
+*   NULL_ARGUMENT  - tokens is NULL
+*   STATUS_SUCCESS - Tokens were released
+*/
+int clean_lz_tokens(struct lz_tokens * tokens);
+
+/**
+*   Symbol of the literal / length alphabet of a match length.
+*
+*   @PARAMS
+*   length     - LZ_MIN_MATCH to LZ_MAX_MATCH
+*   extra_bits - Receives the number of extra bits
+*   extra      - Receives the value of the extra bits
+*
+*   @RETURN
+*   The symbol, 257 to 285
+*/
+unsigned int lz_length_symbol(const unsigned int length, unsigned int * extra_bits, unsigned int * extra);
+
+/**
+*   Same as lz_length_symbol for a distance (1 to LZ_WINDOW - 1), the symbol is 0 to 29.
+*/
+unsigned int lz_distance_symbol(const unsigned int distance, unsigned int * extra_bits, unsigned int * extra);
+
+/**
+*   Canonical codes of code lengths (the ones of DEFLATE): shorter codes
+*   first, codes of a length in the order of their symbols. The codes are
+*   bit-reversed, so writing them from bit 0 up puts their first bit first.
+*
+*   @PARAMS
+*   lengths      - Code length of every symbol, 0 for unused ones, at most LZ_MAX_CODE_LENGTH
+*   symbol_count - Size of the alphabet
+*   codes        - Receives the code of every symbol
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   CORRUPT_DATA   - A length is too long or there are more codes than the lengths allow
+*   STATUS_SUCCESS - codes holds the codes
+*/
+int lz_canonical_codes(const unsigned char * lengths, const unsigned int symbol_count, unsigned short * codes);
+
+/**
+*   Parses the data (lz_parse) and codes the tokens with one Huffman code
+*   for the literals / lengths and one for the distances, both from
+*   huffman_code_lengths: the code lengths (LZ_TABLE_SIZE bytes), then the
+*   bits of the tokens and of LZ_END_OF_DATA, first bit in bit 0.
+*
+*   @PARAMS
+*   data         - Memory address of data
+*   length       - In bytes
+*   level        - Level of lz_parse
+*   coded        - Receives the coded data (allocated)
+*   coded_length - Receives the size of the coded data in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the tokens, the codes or the coded data
+*   STATUS_SUCCESS   - coded holds the data
+*/
+int lz_compress(const void * data, const unsigned int length, const unsigned int level, void ** coded, unsigned int * coded_length);
+
+/**
+*   @PARAMS
+*   coded        - Data written by lz_compress
+*   coded_length - In bytes
+*   output       - Receives the decoded data
+*   length       - Number of bytes the data decodes to
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   CORRUPT_DATA     - Invalid code lengths, a match before the start, or not exactly length bytes
+*   BAD_MEMORY_ALLOC - Could not allocate the decode tables
+*   STATUS_SUCCESS   - output holds the data
+*/
+int lz_decompress(const void * coded, const unsigned int coded_length, void * output, const unsigned int length);
+
+#endif // _LZ77_H_
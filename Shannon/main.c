@@ -1,76 +1,963 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 #include "utilities.h"
+#include "container.h"
 #include "shannon.h"
 #include "huffman.h"
+#include "context.h"
+#include "allocator.h"
+#include "tables.h"
 #include "heap.h"
+#include "pipeline.h"
+#include "counts.h"
+#include "transform.h"
+#include "lz77.h"
+#include "deflate.h"
+#ifndef _WIN32
+#include <glob.h>
+#endif
 
-int main()
+#define COMPRESSED_EXTENSION ".huf"
+#define DECOMPRESSED_EXTENSION ".out"
+#define GZIP_EXTENSION         ".gz"
+
+/// FILE NAME OF STDIN / STDOUT
+#define STANDARD_STREAM "-"
+
+/// ESTIMATED PEAK MEMORY OF A JOB, AS A MULTIPLE OF THE SIZE OF ITS INPUT FILE
+#define COMPRESS_MEMORY_FACTOR   4
+#define DECOMPRESS_MEMORY_FACTOR 10
+#define ENTROPY_MEMORY_FACTOR    8
+
+enum command
+{
+    COMMAND_COMPRESS   = 0,
+    COMMAND_DECOMPRESS = 1,
+    COMMAND_ENTROPY    = 2,
+    COMMAND_TABLES     = 3,
+    COMMAND_COUNTS     = 4,
+    COMMAND_GZIP       = 5
+};
+
+struct options
+{
+    enum command command;
+
+    /// WORKERS AND MEMORY BUDGET (0 = UNLIMITED) OF THE POOL
+    unsigned int thread_count;
+
+    /// THREADS A JOB GETS FOR ITS BLOCKS: THE WORKERS LEFT OVER WHEN THERE ARE FEWER FILES THAN -j
+    unsigned int job_threads;
+    unsigned long long memory_budget;
+
+    /// ENTROPY SETTINGS
+    unsigned int specifier;
+    unsigned int table_size;
+    bool sliding;
+    bool words;
+    unsigned int word_capacity;
+    unsigned int top_count;
+
+    bool verbose;
+    bool stats;
+    bool memory_report;
+
+    /// BYTES PER BLOCK OF THE BURROWS-WHEELER TRANSFORM OF compress (0 = NONE)
+    unsigned int transform_block;
+
+    /// LEVEL OF THE LZ77 MATCH FINDER OF compress (0 = NONE)
+    unsigned int lz_level;
+
+    /// SEEK INDEX INTERVAL OF compress (0 = NONE), RANGE OF decompress (length 0 = WHOLE FILE)
+    unsigned int index_interval;
+    unsigned int range_offset;
+    unsigned int range_length;
+
+    /// FILE WRITTEN BY THE tables / counts COMMAND
+    const char * output_file;
+
+    /// PRECOMPILED TABLES USED BY THE OTHER COMMANDS
+    const char * tables_input;
+    const struct huffman_tables * tables;
+
+    /// PIPELINED MODE: CODER THREADS OF EVERY JOB (0 = WHOLE FILES) AND BYTES PER CHUNK
+    unsigned int coder_count;
+    unsigned int chunk_size;
+};
+
+struct job
 {
-    /// SHANNON-INFORMATION-EXERCISE:
+    char * input;
+    char * output;
+    unsigned long long cost;
     int result;
-    void * buffer;
-    unsigned int buffer_length;
-    const char * input_file = "plain_text.txt";
+};
 
-    FILE * input = fopen(input_file, "r");
+struct pool
+{
+    /// JOBS, TAKEN IN ORDER BY THE WORKERS
+    struct job * jobs;
+    unsigned int job_count;
+    unsigned int next_job;
 
-    if (input == NULL)
+    /// MEMORY OF THE JOBS THAT ARE RUNNING
+    unsigned long long memory_in_use;
+
+    pthread_mutex_t lock;
+    pthread_cond_t released;
+
+    const struct options * options;
+};
+
+static void usage(const char * program)
+{
+    fprintf(stderr,
+            "Usage: %s <compress | decompress | entropy | tables | counts | gzip> [options] <files...>\n"
+            "\n"
+            "  compress     FILE -> FILE" COMPRESSED_EXTENSION "\n"
+            "  decompress   FILE" COMPRESSED_EXTENSION " -> FILE (other names get " DECOMPRESSED_EXTENSION ")\n"
+            "  entropy      Prints the Shannon Information of every file\n"
+            "  tables       Builds precompiled Huffman tables from sample files (-o)\n"
+            "  counts       Counts the files like entropy and writes the counts to one file (-o)\n"
+            "  gzip         FILE -> FILE" GZIP_EXTENSION " that any gzip / zlib decoder reads (literals only,\n"
+            "               or the matches of -z)\n"
+            "\n"
+            "counts and tables merge the counts files among their inputs, entropy reads them.\n"
+            "\n"
+            "Options:\n"
+            "  -j N         Process N files at the same time (default 1), the threads left\n"
+            "               over count the words of a file together (-w)\n"
+            "  -m MB        Only start a job if the running ones fit in MB megabytes\n"
+            "  -l FILE      Also read the names of the files from FILE, one per line\n"
+            "  -n N         Length of the counted sequences (entropy, default 1)\n"
+            "  -s           Count overlapping sequences (entropy)\n"
+            "  -w           Count words instead of sequences (entropy)\n"
+            "  -k N         Count words in a Misra-Gries summary of N words, the others are\n"
+            "               spread over pieces of its error bound (-w)\n"
+            "  -f N         Also print the N most frequent sequences / words (entropy)\n"
+            "  -t N         Size of the hash-tables (default %d)\n"
+            "  -v           Print the tables, trees and data of every job\n"
+            "  -S           Print the stage times and operation counts of every job\n"
+            "               (collected when built with -DSHANNON_STATS)\n"
+            "  -M           Track the allocations and print the current / peak bytes of\n"
+            "               every stage when all jobs are done\n"
+            "  -T FILE      Compress / decompress with the precompiled tables of FILE\n"
+            "  -x KB        Burrows-Wheeler transform blocks of KB kilobytes before coding\n"
+            "               (compress, %d is the size of bzip2)\n"
+            "  -z LEVEL     Code LZ77 matches found at LEVEL %d (fastest) to %d (smallest)\n"
+            "               instead of the bytes (compress, not with -x, %d is the default of gzip)\n"
+            "  -i KB        Write a seek index with a checkpoint every KB kilobytes (compress)\n"
+            "  -R OFF:LEN   Only decode LEN bytes starting at byte OFF (decompress)\n"
+            "  -o FILE      File the tables / counts command writes\n"
+            "  -p N         Stream the files through a reader, N coders and a writer\n"
+            "  -b KB        Size of the chunks of -p (default %d)\n"
+            "\n"
+            "Patterns such as *.txt are expanded even when quoted. The file " STANDARD_STREAM " is\n"
+            "stdin, compressed / decompressed to stdout in the pipelined mode.\n",
+            program, DEFAULT_TABLE_SIZE, DEFAULT_TRANSFORM_BLOCK >> 10, LZ_MIN_LEVEL, LZ_MAX_LEVEL, DEFAULT_LZ_LEVEL,
+            DEFAULT_CHUNK_SIZE >> 10);
+}
+
+static unsigned long long file_size(const char * path)
+{
+    FILE * file = fopen(path, "rb");
+
+    if (file == NULL)
     {
-        perror("Could not open file.");
-        return FILE_ERROR;
+        return 0;
     }
 
-    fseek(input, 0, SEEK_END);
-    buffer_length = ftell(input);
-    fseek(input, 0, SEEK_SET);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
 
-    if ((buffer = (void *)malloc(sizeof(unsigned char) * buffer_length)) == NULL)
+    return size < 0 ? 0 : (unsigned long long)size;
+}
+
+static char * output_name(const char * input, const enum command command)
+{
+    size_t length = strlen(input);
+    size_t extension = strlen(COMPRESSED_EXTENSION);
+    char * output = (char *)malloc(length + extension + sizeof(DECOMPRESSED_EXTENSION));
+
+    if (output == NULL)
     {
-        perror("Could not allocate memory for the buffer.");
-        return BAD_MEMORY_ALLOC;
+        return NULL;
+    }
+
+    strcpy(output, input);
+
+    if (strcmp(input, STANDARD_STREAM) == 0)
+    {
+        return output;
+    }
+    else if (command == COMMAND_COMPRESS)
+    {
+        strcat(output, COMPRESSED_EXTENSION);
+    }
+    else if (command == COMMAND_GZIP)
+    {
+        strcat(output, GZIP_EXTENSION);
+    }
+    else if (length > extension && strcmp(input + length - extension, COMPRESSED_EXTENSION) == 0)
+    {
+        output[length - extension] = '\0';
+    }
+    else
+    {
+        strcat(output, DECOMPRESSED_EXTENSION);
     }
 
-    fread(buffer, sizeof(unsigned char), buffer_length, input);
-    fclose(input);
+    return output;
+}
 
-    printf("Shannon Information for 1-sized sequences: ");
-    printf("\nPress key to continue: "); getc(stdin);
-    printf("Shannon Information for 1-sized sequences: %f\n", sequence_entropy(buffer, buffer_length, 1, 1));
+static int add_job(struct pool * pool, const char * input)
+{
+    struct job * jobs = (struct job *)realloc(pool->jobs, (pool->job_count + 1) * sizeof(struct job));
 
-    printf("\nShannon Information for 2-sized sequences: ");
-    printf("\nPress key to continue: "); getc(stdin);
-    printf("Shannon Information for 2-sized sequences: %f\n", sequence_entropy(buffer, buffer_length, 2, 3));
+    if (jobs == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
 
-    printf("\nShannon Information for 3-sized sequences: ");
-    printf("\nPress key to continue: "); getc(stdin);
-    printf("Shannon Information for 3-sized sequences: %f\n", sequence_entropy(buffer, buffer_length, 3, 5));
+    pool->jobs = jobs;
 
-    printf("\nShannon Information for words: ");
-    printf("\nPress key to continue: "); getc(stdin);
-    printf("Shannon Information for words: %f\n", words_entropy(buffer, buffer_length, 1, 100));
-    free(buffer);
+    struct job * job = pool->jobs + pool->job_count;
+    unsigned long long factor = pool->options->command == COMMAND_COMPRESS || pool->options->command == COMMAND_GZIP ? COMPRESS_MEMORY_FACTOR
+                                : pool->options->command == COMMAND_DECOMPRESS ? DECOMPRESS_MEMORY_FACTOR : ENTROPY_MEMORY_FACTOR;
 
-    /// HUFFMAN-ENCRYPTION-EXERCISE:
+    if ((job->input = (char *)malloc(strlen(input) + 1)) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
 
-    struct node * huffman_root;
-    struct hash_table * huffman_table;
+    strcpy(job->input, input);
+    job->output = NULL;
+    job->cost = file_size(input) * factor;
+    job->result = STATUS_SUCCESS;
 
-    const char * output_file = "encrypted_text.txt";
-    const char * result_file = "decrypted_text.txt";
+    if ((pool->options->command == COMMAND_COMPRESS || pool->options->command == COMMAND_DECOMPRESS || pool->options->command == COMMAND_GZIP)
+            && (job->output = output_name(input, pool->options->command)) == NULL)
+    {
+        free(job->input);
+        return BAD_MEMORY_ALLOC;
+    }
 
-    if ((result = encode_huffman_file(input_file, output_file, &huffman_root, &huffman_table, true)) != STATUS_SUCCESS)
+    ++pool->job_count;
+    return STATUS_SUCCESS;
+}
+
+static int add_pattern(struct pool * pool, const char * pattern)
+{
+#ifndef _WIN32
+    if (strpbrk(pattern, "*?[") != NULL)
     {
+        glob_t matches;
+        int result = STATUS_SUCCESS;
+
+        if (glob(pattern, 0, NULL, &matches) != 0)
+        {
+            fprintf(stderr, "%s: no such file\n", pattern);
+            return FILE_ERROR;
+        }
+
+        for (size_t i = 0; i < matches.gl_pathc && result == STATUS_SUCCESS; ++i)
+        {
+            result = add_job(pool, matches.gl_pathv[i]);
+        }
+
+        globfree(&matches);
         return result;
     }
+#endif
+    return add_job(pool, pattern);
+}
+
+static int add_list(struct pool * pool, const char * list_file)
+{
+    FILE * list = fopen(list_file, "r");
+
+    if (list == NULL)
+    {
+        fprintf(stderr, "%s: could not open the list\n", list_file);
+        return FILE_ERROR;
+    }
+
+    char line[4096];
+    int result = STATUS_SUCCESS;
+
+    while (result == STATUS_SUCCESS && fgets(line, sizeof(line), list) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (line[0] != '\0')
+        {
+            result = add_pattern(pool, line);
+        }
+    }
+
+    fclose(list);
+    return result;
+}
 
-    if ((result = decode_huffman_file(output_file, result_file, huffman_root, huffman_table, true)) != STATUS_SUCCESS)
+static int decode_range_file(struct coding_context * context, const char * input_file_name, const char * output_file_name, const unsigned int offset, const unsigned int length)
+{
+    int result;
+    void * compressed;
+    unsigned int compressed_length;
+
+    if ((result = read_data(input_file_name, &compressed, &compressed_length)) != STATUS_SUCCESS)
     {
         return result;
     }
 
-    clean_nodes(&huffman_root);
-    clean_table(huffman_table);
-    free(huffman_table);
-    free(huffman_root);
-    return 0;
+    FILE * output = fopen(output_file_name, "wb");
+    struct output_sink sink;
+
+    if (output == NULL)
+    {
+        memory_free(compressed);
+        return FILE_ERROR;
+    }
+
+    if ((result = create_callback_sink(&sink, DEFAULT_SINK_CHUNK, file_sink_write, output)) == STATUS_SUCCESS)
+    {
+        result = huffman_decode_range(context, compressed, compressed_length, offset, length, &sink);
+    }
+
+    clean_sink(&sink);
+    memory_free(compressed);
+
+    if (fclose(output) != 0 && result == STATUS_SUCCESS)
+    {
+        result = FILE_ERROR;
+    }
+
+    return result;
+}
+
+static bool is_stream_file(const char * file_name)
+{
+    FILE * file = fopen(file_name, "rb");
+    unsigned char magic[STREAM_HEADER_SIZE];
+    bool stream = file != NULL && fread(magic, sizeof(unsigned char), STREAM_HEADER_SIZE, file) == STREAM_HEADER_SIZE
+                  && memcmp(magic, STREAM_MAGIC, 3) == 0;
+
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    return stream;
+}
+
+static int pipeline_file(struct coding_context * context, const struct options * options, const struct job * job, unsigned long long * bytes_in, unsigned long long * bytes_out)
+{
+    int result;
+    FILE * input = strcmp(job->input, STANDARD_STREAM) == 0 ? stdin : fopen(job->input, "rb");
+    FILE * output = strcmp(job->output, STANDARD_STREAM) == 0 ? stdout : fopen(job->output, "wb");
+
+    if (input == NULL || output == NULL)
+    {
+        result = FILE_ERROR;
+    }
+    else if (options->command == COMMAND_COMPRESS)
+    {
+        result = pipeline_compress(context, input, output, options->chunk_size, options->coder_count, bytes_in, bytes_out);
+    }
+    else
+    {
+        result = pipeline_decompress(context, input, output, options->coder_count, bytes_in, bytes_out);
+    }
+
+    if (input != NULL && input != stdin)
+    {
+        fclose(input);
+    }
+
+    if (output != NULL && output != stdout && fclose(output) != 0 && result == STATUS_SUCCESS)
+    {
+        result = FILE_ERROR;
+    }
+
+    return result;
+}
+
+static int run_job(const struct options * options, struct job * job)
+{
+    int result;
+    struct coding_context context;
+
+    create_context(&context);
+    context.print_flag = options->verbose;
+    context.table_size = options->table_size;
+    context.specifier = options->specifier;
+    context.word_capacity = options->word_capacity;
+    context.top_count = options->top_count;
+    context.tables = options->tables;
+    context.index_interval = options->index_interval;
+    context.transform_block = options->transform_block;
+    context.lz_level = options->lz_level;
+
+    /// THE BLOCKS OF THE TRANSFORM AND THE SLICES OF THE WORD COUNT ARE SPREAD OVER THE THREADS THE JOB GETS
+    if (options->command == COMMAND_COMPRESS || options->command == COMMAND_DECOMPRESS || (options->command == COMMAND_ENTROPY && options->words))
+    {
+        context.thread_count = options->job_threads;
+    }
+
+    /// THE REPORT MUST NOT MIX WITH DATA WRITTEN TO STDOUT
+    FILE * report = job->output != NULL && strcmp(job->output, STANDARD_STREAM) == 0 ? stderr : stdout;
+    bool streamed = job->output != NULL && (options->coder_count != 0 || strcmp(job->input, STANDARD_STREAM) == 0
+                                            || (options->command == COMMAND_DECOMPRESS && options->range_length == 0 && is_stream_file(job->input)));
+
+    /// A gzip FILE IS WRITTEN WHOLE FROM A FILE, NOT THROUGH THE PIPELINE
+    if (options->command == COMMAND_GZIP)
+    {
+        if ((result = encode_gzip_file(job->input, job->output, options->lz_level)) == STATUS_SUCCESS)
+        {
+            fprintf(report, "%s -> %s (%llu -> %llu bytes)\n", job->input, job->output, file_size(job->input), file_size(job->output));
+        }
+    }
+    else if (streamed)
+    {
+        unsigned long long bytes_in = 0;
+        unsigned long long bytes_out = 0;
+
+        if ((result = pipeline_file(&context, options, job, &bytes_in, &bytes_out)) == STATUS_SUCCESS)
+        {
+            fprintf(report, "%s -> %s (%llu -> %llu bytes)\n", job->input, job->output, bytes_in, bytes_out);
+        }
+    }
+    else if (options->command == COMMAND_COMPRESS)
+    {
+        if ((result = encode_huffman_file(&context, job->input, job->output, NULL, NULL)) == STATUS_SUCCESS)
+        {
+            fprintf(report, "%s -> %s (%llu -> %llu bytes)\n", job->input, job->output, file_size(job->input), file_size(job->output));
+        }
+    }
+    else if (options->command == COMMAND_DECOMPRESS && options->range_length != 0)
+    {
+        if ((result = decode_range_file(&context, job->input, job->output, options->range_offset, options->range_length)) == STATUS_SUCCESS)
+        {
+            fprintf(report, "%s[%u:%u] -> %s (%u bytes)\n", job->input, options->range_offset, options->range_length, job->output, context.sample_count);
+        }
+    }
+    else if (options->command == COMMAND_DECOMPRESS)
+    {
+        if ((result = decode_huffman_file(&context, job->input, job->output)) == STATUS_SUCCESS)
+        {
+            fprintf(report, "%s -> %s (%u bytes)\n", job->input, job->output, context.sample_count);
+        }
+    }
+    else
+    {
+        void * buffer;
+        unsigned int length;
+
+        if ((result = read_data(job->input, &buffer, &length)) == STATUS_SUCCESS)
+        {
+            double entropy;
+
+            if (is_frequency_data(buffer, length))
+            {
+                entropy = counts_entropy(&context, buffer, length);
+            }
+            else if (options->words)
+            {
+                entropy = words_entropy(&context, buffer, length);
+            }
+            else if (options->sliding)
+            {
+                entropy = sliding_sequence_entropy(&context, buffer, length);
+            }
+            else
+            {
+                entropy = sequence_entropy(&context, buffer, length);
+            }
+
+            /// THE LINES OF A FILE STAY TOGETHER WHEN JOBS RUN AT THE SAME TIME
+            flockfile(stdout);
+
+            if (options->words && options->word_capacity != 0)
+            {
+                printf("%s: %f bits (%u samples, %u distinct, %u other)\n", job->input, entropy, context.sample_count, context.distinct_count, context.other_count);
+            }
+            else
+            {
+                printf("%s: %f bits (%u samples, %u distinct)\n", job->input, entropy, context.sample_count, context.distinct_count);
+            }
+
+            for (unsigned int i = 0; i < context.top_found; ++i)
+            {
+                printf("\t%u\t", context.top[i].total);
+                print_bits(context.top[i].sequence, context.top[i].length, FORMAT_ASCII, false);
+                printf("\n");
+            }
+
+            funlockfile(stdout);
+            memory_free(buffer);
+        }
+    }
+
+    if (result != STATUS_SUCCESS)
+    {
+        fprintf(stderr, "%s: failed with error %d\n", job->input, result);
+    }
+
+    if (options->stats)
+    {
+        print_stats(stderr, job->input, &context.stats);
+    }
+
+    clean_context(&context);
+    return result;
+}
+
+static int build_tables(const struct options * options, const struct pool * pool)
+{
+    struct hash_table * frequencies = (struct hash_table *)memory_alloc(sizeof(struct hash_table));
+    int result = frequencies == NULL ? BAD_MEMORY_ALLOC : create_table(frequencies, options->table_size);
+
+    /// EVERY BYTE VALUE GETS A CODE, SO THE TABLES CAN ENCODE ANY FILE
+    for (unsigned int value = 0; value < 256 && result == STATUS_SUCCESS; ++value)
+    {
+        const unsigned char key = (unsigned char)value;
+        result = add_counted_element(frequencies, &key, 1, 1, hash_code, seq_cmp);
+    }
+
+    for (unsigned int i = 0; i < pool->job_count && result == STATUS_SUCCESS; ++i)
+    {
+        void * buffer;
+        unsigned int length;
+
+        if ((result = read_data(pool->jobs[i].input, &buffer, &length)) == STATUS_SUCCESS)
+        {
+            result = is_frequency_data(buffer, length) ? parse_frequency_data(frequencies, buffer, length, 1) : parse_sequences(frequencies, buffer, length, 1);
+            memory_free(buffer);
+        }
+    }
+
+    /// COUNTS FILES OF LONGER SEQUENCES OR WORDS ADD KEYS BEYOND THE 256 BYTE VALUES
+    if (result == STATUS_SUCCESS && frequencies->element_count != 256)
+    {
+        result = INVALID_FORMAT;
+    }
+
+    struct node * root = result == STATUS_SUCCESS ? table_huffman_tree(frequencies, WEAK_COLLECTION) : NULL;
+
+    if (result == STATUS_SUCCESS && (result = root == NULL ? NULL_RESULT : save_huffman_tables(root, options->output_file)) == STATUS_SUCCESS)
+    {
+        printf("%u samples -> %s\n", pool->job_count, options->output_file);
+    }
+
+    if (result != STATUS_SUCCESS)
+    {
+        fprintf(stderr, "%s: failed with error %d\n", options->output_file, result);
+    }
+
+    clean_nodes(&root);
+    clean_table(frequencies);
+    memory_free(frequencies);
+    return result;
+}
+
+static int build_counts(const struct options * options, const struct pool * pool)
+{
+    /// THE TABLE IS FILLED LIKE THE ONE OF AN entropy JOB, COUNTS FILES ARE HASHED THE SAME WAY
+    int (*hash_fun)(const void * const, unsigned int) = options->sliding && !options->words ? window_hash_code : hash_code;
+    int (*parse_data)(struct hash_table*, const void * const, const unsigned int, const unsigned int) = options->words ? parse_words
+            : options->sliding ? parse_sliding_sequences : parse_sequences;
+
+    struct hash_table * frequencies = (struct hash_table *)memory_alloc(sizeof(struct hash_table));
+    int result = frequencies == NULL ? BAD_MEMORY_ALLOC : create_bounded_table(frequencies, options->table_size, options->words ? options->word_capacity : 0);
+
+    for (unsigned int i = 0; i < pool->job_count && result == STATUS_SUCCESS; ++i)
+    {
+        void * buffer;
+        unsigned int length;
+
+        if ((result = read_data(pool->jobs[i].input, &buffer, &length)) == STATUS_SUCCESS)
+        {
+            if (is_frequency_data(buffer, length))
+            {
+                result = merge_frequency_data(frequencies, buffer, length, hash_fun, seq_cmp);
+            }
+            else if (options->words && options->thread_count > 1)
+            {
+                /// THE FILES ARE COUNTED ONE AFTER THE OTHER, EACH ONE BY ALL THE THREADS
+                unsigned int word_count;
+                struct hash_table * words = parallel_word_table(buffer, length, options->table_size, options->word_capacity, options->thread_count, &word_count);
+
+                result = words == NULL ? BAD_MEMORY_ALLOC : merge_table(frequencies, words, hash_code, seq_cmp);
+
+                if (words != NULL)
+                {
+                    clean_table(words);
+                    memory_free(words);
+                }
+            }
+            else
+            {
+                result = parse_data(frequencies, buffer, length, options->specifier);
+            }
+            memory_free(buffer);
+        }
+    }
+
+    if (result == STATUS_SUCCESS && (result = save_frequency_table(frequencies, options->output_file)) == STATUS_SUCCESS)
+    {
+        printf("%u files (%u samples, %u distinct) -> %s\n", pool->job_count, frequencies->sample_count, frequencies->element_count, options->output_file);
+    }
+
+    if (result != STATUS_SUCCESS)
+    {
+        fprintf(stderr, "%s: failed with error %d\n", options->output_file, result);
+    }
+
+    if (frequencies != NULL)
+    {
+        clean_table(frequencies);
+        memory_free(frequencies);
+    }
+    return result;
+}
+
+static void * worker(void * argument)
+{
+    struct pool * pool = (struct pool *)argument;
+
+    for (;;)
+    {
+        struct job * job;
+
+        pthread_mutex_lock(&pool->lock);
+
+        if (pool->next_job == pool->job_count)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+
+        job = pool->jobs + pool->next_job++;
+
+        /// ADMIT THE JOB ONCE IT FITS NEXT TO THE RUNNING ONES, A JOB ALONE ALWAYS FITS
+        while (pool->options->memory_budget != 0 && pool->memory_in_use != 0
+                && pool->memory_in_use + job->cost > pool->options->memory_budget)
+        {
+            pthread_cond_wait(&pool->released, &pool->lock);
+        }
+
+        pool->memory_in_use += job->cost;
+        pthread_mutex_unlock(&pool->lock);
+
+        job->result = run_job(pool->options, job);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->memory_in_use -= job->cost;
+        pthread_cond_broadcast(&pool->released);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static int parse_number(const char * text, unsigned long long * value)
+{
+    char * end;
+
+    if (text == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    *value = strtoull(text, &end, 10);
+    return *end == '\0' && end != text ? STATUS_SUCCESS : INVALID_FORMAT;
+}
+
+static int parse_range(const char * text, unsigned int * offset, unsigned int * length)
+{
+    char * end;
+
+    if (text == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned long long first = strtoull(text, &end, 10);
+
+    if (end == text || *end != ':')
+    {
+        return INVALID_FORMAT;
+    }
+
+    text = end + 1;
+    unsigned long long count = strtoull(text, &end, 10);
+
+    if (end == text || *end != '\0' || first > 0xFFFFFFFFULL || count == 0 || count > 0xFFFFFFFFULL)
+    {
+        return INVALID_FORMAT;
+    }
+
+    *offset = (unsigned int)first;
+    *length = (unsigned int)count;
+    return STATUS_SUCCESS;
+}
+
+int main(int argc, char ** argv)
+{
+    struct options options;
+    struct pool pool;
+    unsigned long long value;
+    int result = STATUS_SUCCESS;
+
+    memset(&options, 0, sizeof(struct options));
+    memset(&pool, 0, sizeof(struct pool));
+    options.thread_count = 1;
+    options.specifier = DEFAULT_SPECIFIER;
+    options.table_size = DEFAULT_TABLE_SIZE;
+    pool.options = &options;
+
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "compress") == 0)
+    {
+        options.command = COMMAND_COMPRESS;
+    }
+    else if (strcmp(argv[1], "decompress") == 0)
+    {
+        options.command = COMMAND_DECOMPRESS;
+    }
+    else if (strcmp(argv[1], "entropy") == 0)
+    {
+        options.command = COMMAND_ENTROPY;
+    }
+    else if (strcmp(argv[1], "tables") == 0)
+    {
+        options.command = COMMAND_TABLES;
+    }
+    else if (strcmp(argv[1], "counts") == 0)
+    {
+        options.command = COMMAND_COUNTS;
+    }
+    else if (strcmp(argv[1], "gzip") == 0)
+    {
+        options.command = COMMAND_GZIP;
+    }
+    else
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (int i = 2; i < argc && result == STATUS_SUCCESS; ++i)
+    {
+        const char * argument = argv[i];
+
+        if (argument[0] != '-' || argument[1] == '\0')
+        {
+            result = add_pattern(&pool, argument);
+            continue;
+        }
+
+        switch (argument[1])
+        {
+        case 'j':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS && value != 0)
+            {
+                options.thread_count = (unsigned int)value;
+            }
+            break;
+        case 'm':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS)
+            {
+                options.memory_budget = value << 20;
+            }
+            break;
+        case 'n':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS && value != 0)
+            {
+                options.specifier = (unsigned int)value;
+            }
+            break;
+        case 't':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS && value != 0)
+            {
+                options.table_size = (unsigned int)value;
+            }
+            break;
+        case 'l':
+            result = ++i < argc ? add_list(&pool, argv[i]) : INVALID_FORMAT;
+            break;
+        case 's':
+            options.sliding = true;
+            break;
+        case 'w':
+            options.words = true;
+            break;
+        case 'f':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS)
+            {
+                options.top_count = value > 0xFFFFFFFF ? 0xFFFFFFFFU : (unsigned int)value;
+            }
+            break;
+        case 'k':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS)
+            {
+                options.word_capacity = value > 0x7FFFFFFF ? 0x7FFFFFFFU : (unsigned int)value;
+            }
+            break;
+        case 'v':
+            options.verbose = true;
+            break;
+        case 'S':
+            options.stats = true;
+            break;
+        case 'M':
+            options.memory_report = true;
+            break;
+        case 'T':
+            result = ++i < argc ? STATUS_SUCCESS : INVALID_FORMAT;
+            options.tables_input = result == STATUS_SUCCESS ? argv[i] : NULL;
+            break;
+        case 'i':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS && value != 0)
+            {
+                options.index_interval = value > 0x3FFFFF ? 0xFFFFFFFFU : (unsigned int)(value << 10);
+            }
+            break;
+        case 'x':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS && value != 0)
+            {
+                options.transform_block = value >= MAX_TRANSFORM_BLOCK >> 10 ? MAX_TRANSFORM_BLOCK : (unsigned int)(value << 10);
+            }
+            break;
+        case 'z':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS)
+            {
+                options.lz_level = value < LZ_MIN_LEVEL ? LZ_MIN_LEVEL : value > LZ_MAX_LEVEL ? LZ_MAX_LEVEL : (unsigned int)value;
+            }
+            break;
+        case 'R':
+            result = parse_range(++i < argc ? argv[i] : NULL, &options.range_offset, &options.range_length);
+            break;
+        case 'o':
+            result = ++i < argc ? STATUS_SUCCESS : INVALID_FORMAT;
+            options.output_file = result == STATUS_SUCCESS ? argv[i] : NULL;
+            break;
+        case 'p':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS && value != 0)
+            {
+                options.coder_count = (unsigned int)value;
+            }
+            break;
+        case 'b':
+            if ((result = parse_number(++i < argc ? argv[i] : NULL, &value)) == STATUS_SUCCESS && value != 0)
+            {
+                options.chunk_size = value > 0x3FFFFF ? 0xFFFFFC00U : (unsigned int)(value << 10);
+            }
+            break;
+        default:
+            result = INVALID_FORMAT;
+            break;
+        }
+    }
+
+    struct huffman_tables tables;
+
+    /// THE TRANSFORM AND THE MATCHES ARE TWO WAYS OF MODELING THE REPEATS, ONE IS PICKED
+    /// A gzip FILE HAS NEITHER TRANSFORMED BLOCKS NOR THE CHUNKS OF THE PIPELINE
+    if (result != STATUS_SUCCESS || pool.job_count == 0 || (options.transform_block != 0 && options.lz_level != 0)
+            || (options.command == COMMAND_GZIP && (options.transform_block != 0 || options.coder_count != 0))
+            || (options.command == COMMAND_TABLES || options.command == COMMAND_COUNTS) != (options.output_file != NULL))
+    {
+        usage(argv[0]);
+        result = result != STATUS_SUCCESS ? result : INVALID_FORMAT;
+    }
+    else if (options.command == COMMAND_TABLES)
+    {
+        result = build_tables(&options, &pool);
+    }
+    else if (options.command == COMMAND_COUNTS)
+    {
+        result = build_counts(&options, &pool);
+    }
+    else if (options.tables_input != NULL && (result = map_huffman_tables(options.tables_input, &tables)) != STATUS_SUCCESS)
+    {
+        fprintf(stderr, "%s: could not map the tables, error %d\n", options.tables_input, result);
+    }
+    else
+    {
+        /// ONE MAPPING IS SHARED BY ALL JOBS
+        options.tables = options.tables_input != NULL ? &tables : NULL;
+
+        unsigned int thread_count = options.thread_count < pool.job_count ? options.thread_count : pool.job_count;
+        options.job_threads = options.thread_count / thread_count;
+        pthread_t * threads = (pthread_t *)malloc(thread_count * sizeof(pthread_t));
+        unsigned int started = 0;
+        struct allocator allocator;
+        struct memory_tracker tracker;
+
+        /// INSTALLED BEFORE THE FIRST ALLOCATION OF THE LIBRARY
+        if (options.memory_report)
+        {
+            create_tracking_allocator(&allocator, &tracker);
+            set_allocator(&allocator);
+        }
+
+        pthread_mutex_init(&pool.lock, NULL);
+        pthread_cond_init(&pool.released, NULL);
+
+        while (threads != NULL && started < thread_count && pthread_create(threads + started, NULL, worker, &pool) == 0)
+        {
+            ++started;
+        }
+
+        /// NO THREAD COULD BE STARTED: RUN THE JOBS HERE
+        if (started == 0)
+        {
+            worker(&pool);
+        }
+
+        for (unsigned int i = 0; i < started; ++i)
+        {
+            pthread_join(threads[i], NULL);
+        }
+
+        for (unsigned int i = 0; i < pool.job_count; ++i)
+        {
+            if (pool.jobs[i].result != STATUS_SUCCESS)
+            {
+                result = pool.jobs[i].result;
+            }
+        }
+
+        pthread_cond_destroy(&pool.released);
+        pthread_mutex_destroy(&pool.lock);
+        free(threads);
+
+        if (options.memory_report)
+        {
+            print_memory_tracker(stderr, &tracker);
+            set_allocator(NULL);
+            clean_memory_tracker(&tracker);
+        }
+
+        if (options.tables != NULL)
+        {
+            unmap_huffman_tables(&tables);
+        }
+    }
+
+    for (unsigned int i = 0; i < pool.job_count; ++i)
+    {
+        free(pool.jobs[i].input);
+        free(pool.jobs[i].output);
+    }
+
+    free(pool.jobs);
+    return result == STATUS_SUCCESS ? 0 : 1;
 }
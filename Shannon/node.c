@@ -1,4 +1,5 @@
 #include "utilities.h"
+#include "allocator.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -11,7 +12,7 @@ struct node * node_deep_copy(const struct node * const node)
         return NULL;
     }
 
-    struct node * new_node = (struct node *)malloc(sizeof(struct node));
+    struct node * new_node = (struct node *)memory_alloc(sizeof(struct node));
 
     if (new_node == NULL)
     {
@@ -22,11 +23,11 @@ struct node * node_deep_copy(const struct node * const node)
 
     if (node->info.sequence != NULL && node->info.length != 0)
     {
-        new_node->info.sequence = (void *)malloc(node->info.length);
+        new_node->info.sequence = (void *)memory_alloc(node->info.length);
 
         if (new_node->info.sequence == NULL)
         {
-            free(new_node);
+            memory_free(new_node);
             return NULL;
         }
 
@@ -45,10 +46,10 @@ int destroy_node(struct node ** node)
 
     if ((*node)->info.sequence != NULL)
     {
-        free((*node)->info.sequence);
+        memory_free((*node)->info.sequence);
     }
 
-    free(*node);
+    memory_free(*node);
     *node = NULL;
 
     return STATUS_SUCCESS;
@@ -0,0 +1,474 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "container.h"
+#include "pipeline.h"
+#include "ring.h"
+#include "sink.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+struct pipeline_chunk
+{
+    unsigned char * data;
+    unsigned int length;
+    int result;
+};
+
+struct pipeline;
+
+struct coder
+{
+    struct pipeline * pipeline;
+    struct coding_context context;
+
+    /// CHUNKS FROM THE READER, CHUNKS TO THE WRITER (NULL ENDS BOTH)
+    struct spsc_ring input;
+    struct spsc_ring output;
+
+    pthread_t thread;
+    bool started;
+};
+
+struct pipeline
+{
+    FILE * input;
+    FILE * output;
+    unsigned int chunk_size;
+    bool compress;
+
+    /// EVERY CODER IS A LANE: ITS CONTEXT KEEPS THE TREE OF ITS LAST CHUNK
+    bool reuse_tables;
+
+    /// CHUNK i GOES TO CODER i % coder_count, SO THE WRITER FINDS THE CHUNKS IN ORDER
+    struct coder * coders;
+    unsigned int coder_count;
+
+    /// SET BY THE FIRST ERROR, THE READER STOPS AND THE CODERS ONLY PASS THE CHUNKS ON
+    atomic_int abort;
+    int read_result;
+    unsigned long long bytes_in;
+};
+
+static void free_chunk(struct pipeline_chunk * chunk)
+{
+    if (chunk != NULL)
+    {
+        memory_free(chunk->data);
+        memory_free(chunk);
+    }
+}
+
+static int read_chunk(struct pipeline * pipeline, struct pipeline_chunk ** chunk)
+{
+    unsigned int length = pipeline->chunk_size;
+    unsigned char size[4];
+
+    *chunk = NULL;
+
+    if (!pipeline->compress)
+    {
+        /// A FRAME: SIZE, THEN THE CONTAINER; SIZE 0 ENDS THE STREAM
+        if (fread(size, sizeof(unsigned char), 4, pipeline->input) != 4)
+        {
+            return ferror(pipeline->input) ? FILE_ERROR : CORRUPT_DATA;
+        }
+
+        pipeline->bytes_in += 4;
+
+        if ((length = load_u32(size)) == 0)
+        {
+            return STATUS_SUCCESS;
+        }
+    }
+
+    if ((*chunk = (struct pipeline_chunk *)memory_calloc(1, sizeof(struct pipeline_chunk))) == NULL
+            || ((*chunk)->data = (unsigned char *)memory_alloc(length)) == NULL)
+    {
+        free_chunk(*chunk);
+        *chunk = NULL;
+        return BAD_MEMORY_ALLOC;
+    }
+
+    (*chunk)->length = (unsigned int)fread((*chunk)->data, sizeof(unsigned char), length, pipeline->input);
+    pipeline->bytes_in += (*chunk)->length;
+
+    if ((*chunk)->length == length)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    int result = ferror(pipeline->input) ? FILE_ERROR : pipeline->compress ? STATUS_SUCCESS : CORRUPT_DATA;
+
+    /// THE END OF THE INPUT: THE LAST CHUNK IS SHORT, AN EMPTY ONE IS DROPPED
+    if (result != STATUS_SUCCESS || (*chunk)->length == 0)
+    {
+        free_chunk(*chunk);
+        *chunk = NULL;
+    }
+
+    return result;
+}
+
+static void * reader(void * argument)
+{
+    struct pipeline * pipeline = (struct pipeline *)argument;
+    struct pipeline_chunk * chunk;
+    unsigned long long sequence = 0;
+
+    while (atomic_load(&pipeline->abort) == 0)
+    {
+        int result = read_chunk(pipeline, &chunk);
+
+        if (result != STATUS_SUCCESS)
+        {
+            pipeline->read_result = result;
+            atomic_store(&pipeline->abort, 1);
+            break;
+        }
+
+        if (chunk == NULL)
+        {
+            break;
+        }
+
+        ring_push(&pipeline->coders[sequence++ % pipeline->coder_count].input, chunk);
+
+        /// A CHUNK SHORTER THAN chunk_size IS THE LAST ONE OF THE INPUT
+        if (pipeline->compress && chunk->length < pipeline->chunk_size)
+        {
+            break;
+        }
+    }
+
+    for (unsigned int i = 0; i < pipeline->coder_count; ++i)
+    {
+        ring_push(&pipeline->coders[i].input, NULL);
+    }
+
+    return NULL;
+}
+
+static void * coder(void * argument)
+{
+    struct coder * coder = (struct coder *)argument;
+    struct pipeline_chunk * chunk;
+
+    while ((chunk = (struct pipeline_chunk *)ring_pop(&coder->input)) != NULL)
+    {
+        unsigned char * coded = NULL;
+        unsigned int length = 0;
+
+        if (atomic_load(&coder->pipeline->abort) != 0)
+        {
+            chunk->result = NULL_RESULT;
+        }
+        else
+        {
+            chunk->result = coder->pipeline->compress
+                            ? huffman_compress(&coder->context, chunk->data, chunk->length, (void **)&coded, &length, NULL, NULL)
+                            : huffman_decompress(&coder->context, chunk->data, chunk->length, (void **)&coded, &length);
+        }
+
+        /// THE CODED BYTES REPLACE THE INPUT OF THE CHUNK
+        memory_free(chunk->data);
+        chunk->data = coded;
+        chunk->length = length;
+        ring_push(&coder->output, chunk);
+    }
+
+    ring_push(&coder->output, NULL);
+    return NULL;
+}
+
+static int write_chunk(struct pipeline * pipeline, const struct pipeline_chunk * chunk, unsigned long long * bytes_out)
+{
+    unsigned char size[4];
+
+    if (pipeline->compress)
+    {
+        store_u32(size, chunk->length);
+
+        if (fwrite(size, sizeof(unsigned char), 4, pipeline->output) != 4)
+        {
+            return FILE_ERROR;
+        }
+
+        *bytes_out += 4;
+    }
+
+    if (fwrite(chunk->data, sizeof(unsigned char), chunk->length, pipeline->output) != chunk->length)
+    {
+        return FILE_ERROR;
+    }
+
+    *bytes_out += chunk->length;
+    return STATUS_SUCCESS;
+}
+
+static int run_pipeline(struct coding_context * context, struct pipeline * pipeline, unsigned long long * bytes_out)
+{
+    int result = STATUS_SUCCESS;
+    pthread_t reader_thread;
+
+    if ((pipeline->coders = (struct coder *)memory_calloc(pipeline->coder_count, sizeof(struct coder))) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    for (unsigned int i = 0; i < pipeline->coder_count && result == STATUS_SUCCESS; ++i)
+    {
+        struct coder * coder = pipeline->coders + i;
+
+        /// EVERY CODER HAS ITS OWN CONTEXT WITH THE CONFIGURATION OF THE CALLER
+        create_context(&coder->context);
+        coder->context.specifier = context->specifier;
+        coder->context.table_size = context->table_size;
+        coder->context.tables = context->tables;
+        coder->context.index_interval = context->index_interval;
+        coder->context.transform_block = context->transform_block;
+        coder->context.lz_level = context->lz_level;
+        coder->context.reuse_tables = pipeline->reuse_tables;
+        coder->pipeline = pipeline;
+
+        if ((result = create_ring(&coder->input, PIPELINE_DEPTH)) == STATUS_SUCCESS)
+        {
+            result = create_ring(&coder->output, PIPELINE_DEPTH);
+        }
+    }
+
+    for (unsigned int i = 0; i < pipeline->coder_count && result == STATUS_SUCCESS; ++i)
+    {
+        if (pthread_create(&pipeline->coders[i].thread, NULL, coder, pipeline->coders + i) != 0)
+        {
+            result = BAD_MEMORY_ALLOC;
+            break;
+        }
+
+        pipeline->coders[i].started = true;
+    }
+
+    if (result == STATUS_SUCCESS && pthread_create(&reader_thread, NULL, reader, pipeline) != 0)
+    {
+        result = BAD_MEMORY_ALLOC;
+    }
+
+    if (result != STATUS_SUCCESS)
+    {
+        /// NO READER: THE CODERS THAT RUN ARE STOPPED HERE
+        for (unsigned int i = 0; i < pipeline->coder_count; ++i)
+        {
+            if (pipeline->coders[i].started)
+            {
+                ring_push(&pipeline->coders[i].input, NULL);
+                ring_pop(&pipeline->coders[i].output);
+            }
+        }
+    }
+    else
+    {
+        struct pipeline_chunk * chunk;
+        unsigned long long sequence = 0;
+
+        /// THE CALLING THREAD IS THE WRITER; AFTER AN ERROR IT KEEPS TAKING THE CHUNKS SO THAT NO THREAD BLOCKS
+        while ((chunk = (struct pipeline_chunk *)ring_pop(&pipeline->coders[sequence % pipeline->coder_count].output)) != NULL)
+        {
+            if (result == STATUS_SUCCESS && (result = chunk->result) == STATUS_SUCCESS)
+            {
+                result = write_chunk(pipeline, chunk, bytes_out);
+            }
+
+            if (result != STATUS_SUCCESS)
+            {
+                atomic_store(&pipeline->abort, 1);
+            }
+
+            free_chunk(chunk);
+            ++sequence;
+        }
+
+        pthread_join(reader_thread, NULL);
+
+        /// THE END OF THE RING THE WRITER STOPPED AT IS TAKEN, THE OTHER CODERS STILL HOLD THEIRS
+        for (unsigned int i = 0; i < pipeline->coder_count; ++i)
+        {
+            struct pipeline_chunk * rest;
+
+            while (i != sequence % pipeline->coder_count && (rest = (struct pipeline_chunk *)ring_pop(&pipeline->coders[i].output)) != NULL)
+            {
+                free_chunk(rest);
+            }
+        }
+
+        result = pipeline->read_result != STATUS_SUCCESS ? pipeline->read_result : result;
+    }
+
+    for (unsigned int i = 0; i < pipeline->coder_count; ++i)
+    {
+        if (pipeline->coders[i].started)
+        {
+            pthread_join(pipeline->coders[i].thread, NULL);
+        }
+
+        add_stats(&context->stats, &pipeline->coders[i].context.stats);
+        clean_context(&pipeline->coders[i].context);
+        clean_ring(&pipeline->coders[i].input);
+        clean_ring(&pipeline->coders[i].output);
+    }
+
+    memory_free(pipeline->coders);
+    return result;
+}
+
+int pipeline_compress(struct coding_context * context, FILE * input, FILE * output, const unsigned int chunk_size, const unsigned int coder_count,
+                      unsigned long long * bytes_in, unsigned long long * bytes_out)
+{
+    if (context == NULL || input == NULL || output == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct pipeline pipeline;
+    unsigned long long written = STREAM_HEADER_SIZE + STREAM_LANES_SIZE;
+    unsigned char header[STREAM_HEADER_SIZE + STREAM_LANES_SIZE] = { STREAM_MAGIC[0], STREAM_MAGIC[1], STREAM_MAGIC[2], STREAM_VERSION };
+    unsigned char end[4] = { 0, 0, 0, 0 };
+    int result;
+
+    memset(&pipeline, 0, sizeof(struct pipeline));
+    pipeline.input = input;
+    pipeline.output = output;
+    pipeline.chunk_size = chunk_size == 0 ? DEFAULT_CHUNK_SIZE : chunk_size;
+    pipeline.coder_count = coder_count == 0 ? 1 : coder_count > STREAM_MAX_LANES ? STREAM_MAX_LANES : coder_count;
+    pipeline.compress = true;
+    pipeline.reuse_tables = true;
+    atomic_init(&pipeline.abort, 0);
+    store_u32(header + STREAM_HEADER_SIZE, pipeline.coder_count);
+
+    if (fwrite(header, sizeof(unsigned char), sizeof(header), output) != sizeof(header))
+    {
+        return FILE_ERROR;
+    }
+
+    if ((result = run_pipeline(context, &pipeline, &written)) == STATUS_SUCCESS)
+    {
+        result = fwrite(end, sizeof(unsigned char), 4, output) == 4 && fflush(output) == 0 ? STATUS_SUCCESS : FILE_ERROR;
+        written += 4;
+    }
+
+    if (bytes_in != NULL)
+    {
+        *bytes_in = pipeline.bytes_in;
+    }
+
+    if (bytes_out != NULL)
+    {
+        *bytes_out = written;
+    }
+
+    return result;
+}
+
+static int decompress_container(struct coding_context * context, const unsigned char * header, FILE * input, FILE * output, unsigned long long * bytes_in, unsigned long long * bytes_out)
+{
+    /// A SINGLE CONTAINER HAS NO FRAMES, IT IS READ WHOLE AND DECODED IN ONE PIECE
+    struct output_sink container;
+    struct output_sink decoded;
+    unsigned char block[DEFAULT_SINK_CHUNK];
+    int result = create_buffer_sink(&container, DEFAULT_SINK_CHUNK);
+
+    if (result == STATUS_SUCCESS)
+    {
+        result = sink_write(&container, header, STREAM_HEADER_SIZE);
+    }
+
+    for (size_t length; result == STATUS_SUCCESS && (length = fread(block, sizeof(unsigned char), sizeof(block), input)) != 0;)
+    {
+        result = sink_write(&container, block, (unsigned int)length);
+    }
+
+    if (result == STATUS_SUCCESS && ferror(input))
+    {
+        result = FILE_ERROR;
+    }
+
+    if (result == STATUS_SUCCESS && (result = create_callback_sink(&decoded, DEFAULT_SINK_CHUNK, file_sink_write, output)) == STATUS_SUCCESS)
+    {
+        result = huffman_decompress_sink(context, container.buffer, container.length, &decoded);
+        *bytes_out = sink_total(&decoded);
+        clean_sink(&decoded);
+    }
+
+    *bytes_in = container.length;
+    clean_sink(&container);
+    return result == STATUS_SUCCESS && fflush(output) != 0 ? FILE_ERROR : result;
+}
+
+int pipeline_decompress(struct coding_context * context, FILE * input, FILE * output, const unsigned int coder_count,
+                        unsigned long long * bytes_in, unsigned long long * bytes_out)
+{
+    if (context == NULL || input == NULL || output == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct pipeline pipeline;
+    unsigned char header[STREAM_HEADER_SIZE];
+    unsigned char lanes[STREAM_LANES_SIZE];
+    unsigned long long consumed = 0;
+    unsigned long long written = 0;
+    int result = STATUS_SUCCESS;
+
+    memset(&pipeline, 0, sizeof(struct pipeline));
+    pipeline.input = input;
+    pipeline.output = output;
+    pipeline.coder_count = coder_count == 0 ? 1 : coder_count;
+    pipeline.compress = false;
+    atomic_init(&pipeline.abort, 0);
+
+    if (fread(header, sizeof(unsigned char), STREAM_HEADER_SIZE, input) != STREAM_HEADER_SIZE)
+    {
+        result = ferror(input) ? FILE_ERROR : CORRUPT_DATA;
+    }
+    else if (memcmp(header, STREAM_MAGIC, 3) == 0 && (header[3] == STREAM_VERSION || header[3] == STREAM_SOLO_VERSION))
+    {
+        /// A LANE IS DECODED IN ORDER BY ONE CODER, SO THERE ARE AS MANY CODERS AS LANES
+        if (header[3] == STREAM_VERSION)
+        {
+            pipeline.reuse_tables = true;
+            consumed = STREAM_LANES_SIZE;
+
+            if (fread(lanes, sizeof(unsigned char), STREAM_LANES_SIZE, input) != STREAM_LANES_SIZE
+                    || (pipeline.coder_count = load_u32(lanes)) == 0 || pipeline.coder_count > STREAM_MAX_LANES)
+            {
+                result = ferror(input) ? FILE_ERROR : CORRUPT_DATA;
+            }
+        }
+
+        if (result == STATUS_SUCCESS && (result = run_pipeline(context, &pipeline, &written)) == STATUS_SUCCESS && fflush(output) != 0)
+        {
+            result = FILE_ERROR;
+        }
+
+        consumed += STREAM_HEADER_SIZE + pipeline.bytes_in;
+    }
+    else if (memcmp(header, CONTAINER_MAGIC, 3) == 0)
+    {
+        result = decompress_container(context, header, input, output, &consumed, &written);
+    }
+    else
+    {
+        result = CORRUPT_DATA;
+    }
+
+    if (bytes_in != NULL)
+    {
+        *bytes_in = consumed;
+    }
+
+    if (bytes_out != NULL)
+    {
+        *bytes_out = written;
+    }
+
+    return result;
+}
@@ -0,0 +1,69 @@
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+#include <stdio.h>
+#include "context.h"
+
+/// "HUS" FOLLOWED BY THE VERSION AND THE NUMBER OF LANES (4), THEN FRAMES: SIZE (4) AND A CONTAINER
+/// OF ONE CHUNK, A SIZE OF 0 ENDS THE STREAM
+#define STREAM_MAGIC       "HUS"
+#define STREAM_VERSION     2
+#define STREAM_HEADER_SIZE 4
+#define STREAM_LANES_SIZE  4
+#define STREAM_MAX_LANES   256
+
+/// FRAME i BELONGS TO LANE i % lanes AND MAY BE CODED WITH THE TREE OF THE FRAME BEFORE IT IN ITS
+/// LANE (coding_context.reuse_tables); A VERSION 1 STREAM HAS NO LANES, EVERY FRAME STANDS ALONE
+#define STREAM_SOLO_VERSION 1
+
+#define DEFAULT_CHUNK_SIZE (1024 * 1024)
+
+/// CHUNKS EVERY RING OF A CODER HOLDS, THE MEMORY OF A PIPELINE STAYS BELOW
+/// (2 * PIPELINE_DEPTH + 2) * coder_count + 2 CHUNKS
+#define PIPELINE_DEPTH 4
+
+/**
+*   Compresses a stream (a regular file, stdin or a pipe) in chunks: a reader
+*   thread cuts the input, coder_count coder threads compress the chunks and
+*   the calling thread writes the frames in order, so the disk and the CPU
+*   work at the same time. The threads are connected by lock-free rings
+*   (ring.h) of at most PIPELINE_DEPTH chunks. The configuration of context
+*   (tables, seek index, table size) applies to every chunk. Every coder is a
+*   lane that reuses the tree of its previous chunk when a new one does not
+*   pay for itself.
+*
+*   @PARAMS
+*   context     - Configuration, receives the statistics of all coders
+*   input       - Read until its end
+*   output      - Receives the stream
+*   chunk_size  - Bytes of input per chunk, 0 for DEFAULT_CHUNK_SIZE
+*   coder_count - Coder threads, 0 counts as 1, at most STREAM_MAX_LANES
+*   bytes_in    - Receives the number of bytes read, may be NULL
+*   bytes_out   - Receives the number of bytes written, may be NULL
+*
+*   @RETURN
+*   NULL_ARGUMENT    - context, input or output is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the rings or a chunk
+*   FILE_ERROR       - Could not read or write
+*   STATUS_SUCCESS   - The whole input was compressed
+*   Any error of huffman_compress
+*/
+int pipeline_compress(struct coding_context * context, FILE * input, FILE * output, const unsigned int chunk_size, const unsigned int coder_count,
+                      unsigned long long * bytes_in, unsigned long long * bytes_out);
+
+/**
+*   Decompresses a stream written by pipeline_compress the same way, with one
+*   coder per lane of the stream (coder_count only applies to version 1
+*   streams). A single container (huffman_compress) is accepted too, it is
+*   decoded in one piece.
+*
+*   @RETURN
+*   NULL_ARGUMENT    - context, input or output is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the rings or a chunk
+*   CORRUPT_DATA     - Not a stream / container or truncated
+*   FILE_ERROR       - Could not read or write
+*   STATUS_SUCCESS   - The whole stream was decompressed
+*/
+int pipeline_decompress(struct coding_context * context, FILE * input, FILE * output, const unsigned int coder_count,
+                        unsigned long long * bytes_in, unsigned long long * bytes_out);
+
+#endif // _PIPELINE_H_
@@ -0,0 +1,99 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "ring.h"
+#include <sched.h>
+#include <string.h>
+
+int create_ring(struct spsc_ring * ring, const size_t capacity)
+{
+    if (ring == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    size_t size = 1;
+
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    if ((ring->slots = (void **)memory_calloc(size, sizeof(void *))) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+bool ring_try_push(struct spsc_ring * ring, void * item)
+{
+    const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) > ring->mask)
+    {
+        return false;
+    }
+
+    /// THE SLOT IS FILLED BEFORE THE CONSUMER CAN SEE THE NEW TAIL
+    ring->slots[tail & ring->mask] = item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool ring_try_pop(struct spsc_ring * ring, void ** item)
+{
+    const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+    {
+        return false;
+    }
+
+    /// THE SLOT IS READ BEFORE THE PRODUCER CAN REUSE IT
+    *item = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+void ring_push(struct spsc_ring * ring, void * item)
+{
+    for (unsigned int spins = 0; !ring_try_push(ring, item); ++spins)
+    {
+        if (spins >= RING_SPINS)
+        {
+            sched_yield();
+        }
+    }
+}
+
+void * ring_pop(struct spsc_ring * ring)
+{
+    void * item;
+
+    for (unsigned int spins = 0; !ring_try_pop(ring, &item); ++spins)
+    {
+        if (spins >= RING_SPINS)
+        {
+            sched_yield();
+        }
+    }
+
+    return item;
+}
+
+int clean_ring(struct spsc_ring * ring)
+{
+    if (ring == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memory_free(ring->slots);
+    memset(ring, 0, sizeof(struct spsc_ring));
+    return STATUS_SUCCESS;
+}
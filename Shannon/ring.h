@@ -0,0 +1,57 @@
+#ifndef _RING_H_
+#define _RING_H_
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// TRIES BEFORE A BLOCKED PUSH / POP GIVES ITS TIME SLICE AWAY
+#define RING_SPINS 64
+
+/// BOUNDED LOCK-FREE QUEUE OF POINTERS, ONE PRODUCER THREAD AND ONE CONSUMER THREAD
+struct spsc_ring
+{
+    void ** slots;
+    size_t mask;
+
+    /// WRITTEN BY THE PRODUCER / THE CONSUMER ONLY, ON SEPARATE CACHE LINES
+    _Alignas(64) atomic_size_t tail;
+    _Alignas(64) atomic_size_t head;
+};
+
+/**
+*   @PARAMS
+*   ring     - Memory address of the ring
+*   capacity - Most pointers the ring holds, rounded up to a power of 2
+*
+*   @RETURN
+*   NULL_ARGUMENT    - ring is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the slots
+*   STATUS_SUCCESS   - Ring is empty and ready
+*/
+int create_ring(struct spsc_ring * ring, const size_t capacity);
+
+/**
+*   Producer side.
+*
+*   @RETURN
+*   false - The ring is full
+*   true  - item was queued
+*/
+bool ring_try_push(struct spsc_ring * ring, void * item);
+
+/**
+*   Consumer side.
+*
+*   @RETURN
+*   false - The ring is empty
+*   true  - The oldest item was moved to item
+*/
+bool ring_try_pop(struct spsc_ring * ring, void ** item);
+
+/// WAIT (SPIN, THEN YIELD) UNTIL THERE IS ROOM / AN ITEM
+void ring_push(struct spsc_ring * ring, void * item);
+void * ring_pop(struct spsc_ring * ring);
+
+int clean_ring(struct spsc_ring * ring);
+
+#endif // _RING_H_
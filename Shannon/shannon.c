@@ -1,26 +1,152 @@
 #include "hash_table.h"
 #include "utilities.h"
+#include "allocator.h"
+#include "context.h"
+#include "shannon.h"
+#include "counts.h"
+#include "fixed_table.h"
+#include "stats.h"
+#include "kernels.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
+#include <stdint.h>
 
-struct hash_table * frequency_hash_table(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier))
+/// SEQUENCES OF 2 BYTES ARE COUNTED IN A FLAT ARRAY INDEXED BY THEIR VALUE
+#define PAIR_COUNT 65536
+
+/// SEQUENCES OF 3 TO 8 BYTES ARE PACKED IN AN INTEGER KEY (fixed_table.h), A 32-BIT ONE UP TO 4 BYTES
+#define KEY32_SIZE 4
+#define KEY64_SIZE 8
+DEFINE_FIXED_TABLE(key32, uint32_t)
+DEFINE_FIXED_TABLE(key64, uint64_t)
+
+/// THE SEQUENCES START EVERY step BYTES, THE DISTINCT ONES GO TO table ONCE (HASHED WITH hash_fun)
+static int count_pairs(struct hash_table * table, const unsigned char * const data, const unsigned int length, const unsigned int step,
+                       int (*hash_fun)(const void * const, unsigned int))
 {
-    struct hash_table * table = (struct hash_table *)malloc(sizeof(struct hash_table));
+    unsigned int * counts = (unsigned int *)memory_calloc(PAIR_COUNT, sizeof(unsigned int));
 
-    if (create_table(table, table_size) != STATUS_SUCCESS)
+    if (counts == NULL)
     {
-        return NULL;
+        return BAD_MEMORY_ALLOC;
     }
 
-    if (parse_data(table, data, length, specifier) != STATUS_SUCCESS)
+    for (unsigned int i = 0; i < length - 1; i += step)
     {
+        ++counts[data[i] | data[i + 1] << 8];
+    }
+
+    int result = STATUS_SUCCESS;
+
+    for (unsigned int value = 0; value < PAIR_COUNT && result == STATUS_SUCCESS; ++value)
+    {
+        const unsigned char key[2] = { (unsigned char)(value & 0xFF), (unsigned char)(value >> 8) };
+
+        if (counts[value] != 0)
+        {
+            result = add_counted_element(table, key, 2, counts[value], hash_fun, seq_cmp);
+        }
+    }
+
+    memory_free(counts);
+    return result;
+}
+
+/// COUNTS THE SEQUENCES IN THE FIXED TABLE OF THEIR WIDTH, THEY START EVERY step BYTES AND THE DISTINCT ONES GO
+/// TO table ONCE (HASHED WITH hash_fun)
+#define DEFINE_FIXED_PARSER(NAME, KEY_TYPE)                                                                         \
+static int count_##NAME##_sequences(struct hash_table * table, const unsigned char * const data,                    \
+                                    const unsigned int length, const unsigned int specifier,                        \
+                                    const unsigned int step, int (*hash_fun)(const void * const, unsigned int))     \
+{                                                                                                                   \
+    struct NAME##_table fixed;                                                                                      \
+    int result = NAME##_create(&fixed);                                                                             \
+                                                                                                                    \
+    if (step == 1)                                                                                                  \
+    {                                                                                                               \
+        /* THE KEY OF THE NEXT WINDOW DROPS THE FIRST BYTE AND TAKES THE ONE AFTER THE LAST */                      \
+        const unsigned int shift = 8 * (specifier - 1);                                                             \
+        KEY_TYPE key = NAME##_pack(data, specifier);                                                                \
+                                                                                                                    \
+        for (unsigned int i = 0; result == STATUS_SUCCESS; ++i)                                                     \
+        {                                                                                                           \
+            result = NAME##_add(&fixed, key, 1);                                                                    \
+                                                                                                                    \
+            if (i + specifier >= length)                                                                            \
+            {                                                                                                       \
+                break;                                                                                              \
+            }                                                                                                       \
+            key = key >> 8 | (KEY_TYPE)data[i + specifier] << shift;                                                \
+        }                                                                                                           \
+    }                                                                                                               \
+    else                                                                                                            \
+    {                                                                                                               \
+        for (unsigned int i = 0; i < length - specifier + 1 && result == STATUS_SUCCESS; i += step)                \
+        {                                                                                                           \
+            result = NAME##_add(&fixed, NAME##_pack(data + i, specifier), 1);                                       \
+        }                                                                                                           \
+    }                                                                                                               \
+                                                                                                                    \
+    if (result == STATUS_SUCCESS)                                                                                   \
+    {                                                                                                               \
+        result = NAME##_export(&fixed, table, specifier, hash_fun);                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    NAME##_clean(&fixed);                                                                                           \
+    return result;                                                                                                  \
+}
+
+DEFINE_FIXED_PARSER(key32, uint32_t)
+DEFINE_FIXED_PARSER(key64, uint64_t)
+
+/// THE NARROWEST FIXED TABLE THE SEQUENCES FIT IN
+static int count_packed(struct hash_table * table, const unsigned char * const data, const unsigned int length, const unsigned int specifier,
+                        const unsigned int step, int (*hash_fun)(const void * const, unsigned int))
+{
+    if (specifier <= KEY32_SIZE)
+    {
+        return count_key32_sequences(table, data, length, specifier, step, hash_fun);
+    }
+    return count_key64_sequences(table, data, length, specifier, step, hash_fun);
+}
+
+static struct hash_table * bounded_hash_table(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size, const unsigned int capacity, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier))
+{
+    const int previous_stage = set_memory_stage(STATS_FREQUENCY_TABLE);
+    struct hash_table * table = (struct hash_table *)memory_alloc(sizeof(struct hash_table));
+    int result = create_bounded_table(table, table_size, capacity);
+
+    if (result == STATUS_SUCCESS)
+    {
+        STATS_START(clock);
+        result = parse_data(table, data, length, specifier);
+        STATS_STOP(STATS_FREQUENCY_TABLE, clock);
+    }
+
+    set_memory_stage(previous_stage);
+
+    if (result != STATUS_SUCCESS)
+    {
+        /// A TABLE THE PARSER GAVE UP ON IS RELEASED WITH WHAT IT HOLDS
+        if (table != NULL)
+        {
+            clean_table(table);
+            memory_free(table);
+        }
         return NULL;
     }
 
     return table;
 }
 
+struct hash_table * frequency_hash_table(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier))
+{
+    return bounded_hash_table(data, length, specifier, table_size, 0, parse_data);
+}
+
 double node_entropy(const struct node * const node, const unsigned int total)
 {
     if (node == NULL)
@@ -65,7 +191,7 @@ double hash_table_entropy(const struct hash_table* const table, const unsigned i
     return 0;
 }
 
-double shannon_entropy(const char * const filePath, const unsigned int specifier, double (*event)(const void * const data, const unsigned int length, const unsigned int specifier))
+double shannon_entropy(struct coding_context * context, const char * const filePath, double (*event)(struct coding_context * context, const void * const data, const unsigned int length))
 {
     unsigned int length;
     void * buffer;
@@ -75,8 +201,135 @@ double shannon_entropy(const char * const filePath, const unsigned int specifier
         return FILE_ERROR;
     }
 
-    double entropy = event(buffer, length, specifier);
-    free((void *)buffer);
+    double entropy = event(context, buffer, length);
+    memory_free((void *)buffer);
+    return entropy;
+}
+
+/// COPIES THE top_count LARGEST ELEMENTS OF THE TABLE TO THE CONTEXT
+static int keep_top(struct coding_context * context, const struct hash_table * const table)
+{
+    clean_top(context);
+
+    const unsigned int k = context->top_count < table->element_count ? context->top_count : table->element_count;
+
+    if (k == 0)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    const struct node ** ranked = (const struct node **)memory_alloc(k * sizeof(struct node *));
+
+    if (ranked == NULL || (context->top = (struct weight_data *)memory_calloc(k, sizeof(struct weight_data))) == NULL)
+    {
+        memory_free(ranked);
+        return BAD_MEMORY_ALLOC;
+    }
+
+    int result = top_k(table, k, ranked);
+
+    for (int i = 0; i < result; ++i)
+    {
+        struct weight_data * const entry = context->top + i;
+
+        if ((entry->sequence = memory_alloc(ranked[i]->info.length)) == NULL)
+        {
+            result = BAD_MEMORY_ALLOC;
+            break;
+        }
+
+        memcpy(entry->sequence, ranked[i]->info.sequence, ranked[i]->info.length);
+        entry->length = ranked[i]->info.length;
+        entry->total = ranked[i]->info.total;
+        ++context->top_found;
+    }
+
+    memory_free(ranked);
+    return result < 0 ? result : STATUS_SUCCESS;
+}
+
+/// - p * log2(p) OF count OCCURRENCES OUT OF total
+static double count_entropy(const double count, const unsigned int total)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    double probability = count / total;
+    return - probability * log(probability) / log(2.0);
+}
+
+/// nodes_entropy WITH shift OCCURRENCES ADDED TO EVERY TOTAL
+static double shifted_entropy(const struct node * const node, const unsigned int shift, const unsigned int total)
+{
+    if (node != NULL)
+    {
+        return count_entropy((double)node->info.total + shift, total) +
+               shifted_entropy(node->left_child, shift, total) +
+               shifted_entropy(node->right_child, shift, total);
+    }
+    return 0;
+}
+
+/// THE BOUNDED MODE ONLY KNOWS THE TOTALS UP TO error_bound: EVERY SURVIVOR GETS ITS SHARE OF deducted_count BACK
+/// (AT MOST error_bound), THE REST IS SPLIT IN PIECES OF error_bound, THE MOST A PRUNED WORD CAN HAVE. THE RESULT
+/// IS THE LEAST ENTROPY OF THE DATA THE SUMMARY CAN COME FROM, NOT THE ONE OF A SINGLE "OTHER" WORD
+static double bounded_entropy(const struct hash_table * const table)
+{
+    unsigned int shift = table->element_count == 0 ? 0 : table->deducted_count / table->element_count;
+
+    if (shift > table->error_bound)
+    {
+        shift = table->error_bound;
+    }
+
+    double entropy = 0.0;
+    for (unsigned int i = 0; i < table->table_size; ++i)
+    {
+        entropy += shifted_entropy((table->trees + i)->root, shift, table->sample_count);
+    }
+
+    const unsigned long long rest = (unsigned long long)table->other_count + table->deducted_count - (unsigned long long)shift * table->element_count;
+    const unsigned long long piece = table->error_bound == 0 ? rest : table->error_bound;
+
+    if (rest != 0)
+    {
+        entropy += (rest / piece) * count_entropy((double)piece, table->sample_count) + count_entropy((double)(rest % piece), table->sample_count);
+    }
+
+    return entropy;
+}
+
+static double table_entropy(struct coding_context * context, struct hash_table * table)
+{
+    if (table == NULL)
+    {
+        return 0;
+    }
+
+    if (trim_table(table) != STATUS_SUCCESS || keep_top(context, table) != STATUS_SUCCESS)
+    {
+        clean_table(table);
+        memory_free(table);
+        return BAD_MEMORY_ALLOC;
+    }
+
+    /// OCCURRENCES OF THE WORDS PRUNED BY THE BOUNDED MODE
+    context->other_count = table->other_count;
+
+    double entropy = table->other_count + table->deducted_count != 0 ? bounded_entropy(table) : hash_table_entropy(table, table->sample_count);
+
+    context->sample_count = table->sample_count;
+    context->distinct_count = table->element_count;
+
+    if (context->print_flag)
+    {
+        print_table(table, print_node);
+    }
+
+    clean_table(table);
+    memory_free(table);
+
     return entropy;
 }
 
@@ -88,6 +341,40 @@ int parse_sequences(struct hash_table * table, const void * const data, const un
     }
 
     int result;
+
+    if (specifier == 1)
+    {
+        /// SINGLE BYTES ARE COUNTED BY THE HISTOGRAM OF THE CPU, EVERY VALUE GOES TO THE TABLE ONCE
+        unsigned int counts[256] = { 0 };
+        cpu_kernels()->histogram((const unsigned char *)data, length, counts);
+
+        for (unsigned int value = 0; value < 256; ++value)
+        {
+            const unsigned char key = (unsigned char)value;
+
+            if (counts[value] != 0 && (result = add_counted_element(table, &key, 1, counts[value], hash_code, seq_cmp)) != STATUS_SUCCESS)
+            {
+                return result;
+            }
+        }
+        return STATUS_SUCCESS;
+    }
+
+    if (specifier == 0 || length < specifier)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    /// ONLY SEQUENCES LONGER THAN AN INTEGER KEY GO THROUGH THE GENERIC TABLE
+    if (specifier == 2)
+    {
+        return count_pairs(table, (const unsigned char *)data, length, specifier, hash_code);
+    }
+    else if (specifier <= KEY64_SIZE)
+    {
+        return count_packed(table, (const unsigned char *)data, length, specifier, specifier, hash_code);
+    }
+
     for (unsigned int i = 0; i < length - specifier + 1; i += specifier)
     {
         result = add_element(table, (unsigned char *)data + i, specifier, hash_code, seq_cmp);
@@ -99,41 +386,96 @@ int parse_sequences(struct hash_table * table, const void * const data, const un
     return STATUS_SUCCESS;
 }
 
-double sequence_entropy(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size)
+double sequence_entropy(struct coding_context * context, const void * const data, const unsigned int length)
 {
-    double entropy = 0.0;
-    struct hash_table * table = frequency_hash_table(data, length, specifier, table_size, &parse_sequences);
-
-    entropy = hash_table_entropy(table, length / specifier);
-
-    print_table(table, print_node);
+    if (context == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
 
-    clean_table(table);
-    free(table);
+    STATS_BIND(&context->stats);
+    STATS_ADD(bytes_in, length);
+    double entropy = table_entropy(context, frequency_hash_table(data, length, context->specifier, context->table_size, &parse_sequences));
+    STATS_UNBIND();
 
     return entropy;
 }
 
-int total_word_count = 0;
-
-int parse_words(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier)
+int parse_sliding_sequences(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier)
 {
     if (table == NULL || data == NULL)
     {
         return NULL_ARGUMENT;
     }
 
-    total_word_count = 0;
+    if (specifier == 0 || length < specifier)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    struct rolling_hash rolling;
+    const unsigned char * bytes = (const unsigned char *)data;
+
+    /// SHORT WINDOWS ARE COUNTED LIKE parse_sequences DOES, ONE STEP A BYTE, AND KEYED WITH window_hash_code
+    if (specifier == 2)
+    {
+        return count_pairs(table, bytes, length, 1, window_hash_code);
+    }
+    else if (specifier > 2 && specifier <= KEY64_SIZE)
+    {
+        return count_packed(table, bytes, length, specifier, 1, window_hash_code);
+    }
+
+    rolling_hash_init(&rolling, bytes, specifier);
+
+    int result;
+    for (unsigned int i = 0; i < length - specifier + 1; ++i)
+    {
+        /// THE BUCKET IS PICKED BY THE ROLLING HASH, THE KEY IS VERIFIED BY seq_cmp
+        result = add_hashed_element(table, bytes + i, specifier, rolling_hash_code(&rolling), seq_cmp);
+        if (result != STATUS_SUCCESS)
+        {
+            return result;
+        }
+
+        if (i + specifier < length)
+        {
+            rolling_hash_roll(&rolling, bytes[i], bytes[i + specifier]);
+        }
+    }
+    return STATUS_SUCCESS;
+}
+
+double sliding_sequence_entropy(struct coding_context * context, const void * const data, const unsigned int length)
+{
+    if (context == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (context->specifier == 0 || length < context->specifier)
+    {
+        return 0;
+    }
+
+    STATS_BIND(&context->stats);
+    STATS_ADD(bytes_in, length);
+    double entropy = table_entropy(context, frequency_hash_table(data, length, context->specifier, context->table_size, &parse_sliding_sequences));
+    STATS_UNBIND();
+
+    return entropy;
+}
+
+static int count_words(struct hash_table * table, const void * const data, const unsigned int length, unsigned int * word_count)
+{
+    const struct cpu_kernels * kernels = cpu_kernels();
 
     for (unsigned int i = 0; i < length; ++i)
     {
         if (*((unsigned char *)data + i) != ' ')
         {
-            unsigned int j = i + 1;
-            while (j < length && *((unsigned char *)data + j) != ' ')
-            {
-                ++j;
-            }
+            /// THE END OF THE WORD IS FOUND BY THE DELIMITER SCAN OF THE CPU
+            unsigned int j = i + 1 + (unsigned int)kernels->find_byte((unsigned char *)data + i + 1, length - i - 1, ' ');
 
             int result = add_element(table, (unsigned char *)data + i, j - i, hash_code, seq_cmp);
 
@@ -142,7 +484,7 @@ int parse_words(struct hash_table * table, const void * const data, const unsign
                 return result;
             }
 
-            ++total_word_count;
+            ++*word_count;
             i = j;
         }
     }
@@ -150,17 +492,185 @@ int parse_words(struct hash_table * table, const void * const data, const unsign
     return STATUS_SUCCESS;
 }
 
-double words_entropy(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size)
+int parse_words(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier)
 {
-    double entropy = 0.0;
-    struct hash_table * table = frequency_hash_table(data, length, specifier, table_size, &parse_words);
+    if (table == NULL || data == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
 
-    print_table(table, print_node);
+    unsigned int word_count = 0;
+    return count_words(table, data, length, &word_count);
+}
 
-    entropy = hash_table_entropy(table, total_word_count);
+struct word_shard
+{
+    /// SLICE OF THE BUFFER, CUT AT SPACES
+    const unsigned char * data;
+    unsigned int length;
 
-    clean_table(table);
-    free(table);
+    /// PRIVATE TABLE OF THE THREAD
+    struct hash_table table;
+    unsigned int word_count;
+    int result;
+
+    /// COUNTERS OF THE THREAD, ADDED TO THOSE OF THE CALLER AFTER THE JOIN
+    struct coding_stats stats;
+};
+
+static void * count_shard(void * argument)
+{
+    struct word_shard * shard = (struct word_shard *)argument;
+    STATS_BIND(&shard->stats);
+    set_memory_stage(STATS_FREQUENCY_TABLE);
+    shard->result = count_words(&shard->table, shard->data, shard->length, &shard->word_count);
+    STATS_UNBIND();
+    return NULL;
+}
+
+struct hash_table * parallel_word_table(const void * const data, const unsigned int length, const unsigned int table_size, const unsigned int capacity, const unsigned int thread_count, unsigned int * word_count)
+{
+    if (data == NULL || word_count == NULL || thread_count == 0)
+    {
+        return NULL;
+    }
+
+    struct word_shard * shards = (struct word_shard *)memory_calloc(thread_count, sizeof(struct word_shard));
+    pthread_t * threads = (pthread_t *)memory_alloc(thread_count * sizeof(pthread_t));
+    struct hash_table * table = NULL;
+    unsigned int started = 0;
+    const int previous_stage = set_memory_stage(STATS_FREQUENCY_TABLE);
+    STATS_START(clock);
+
+    if (shards == NULL || threads == NULL)
+    {
+        goto exit;
+    }
+
+    /// SPLIT THE BUFFER IN EQUAL SLICES, MOVING EVERY CUT FORWARD TO THE NEXT SPACE
+    {
+        unsigned int begin = 0;
+        for (unsigned int i = 0; i < thread_count; ++i)
+        {
+            unsigned int end = i == thread_count - 1 ? length : (unsigned int)((unsigned long long)length * (i + 1) / thread_count);
+
+            if (end < begin)
+            {
+                end = begin;
+            }
+
+            while (end < length && *((const unsigned char *)data + end) != ' ')
+            {
+                ++end;
+            }
+
+            shards[i].data = (const unsigned char *)data + begin;
+            shards[i].length = end - begin;
+            begin = end;
+        }
+    }
+
+    for (; started < thread_count; ++started)
+    {
+        if (create_bounded_table(&shards[started].table, table_size, capacity) != STATUS_SUCCESS)
+        {
+            goto exit;
+        }
+
+        if (pthread_create(threads + started, NULL, count_shard, shards + started) != 0)
+        {
+            clean_table(&shards[started].table);
+            goto exit;
+        }
+    }
+
+exit:
+    for (unsigned int i = 0; i < started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+        STATS_MERGE(&shards[i].stats);
+    }
+
+    if (shards != NULL && started == thread_count)
+    {
+        int result = STATUS_SUCCESS;
+
+        for (unsigned int i = 0; i < thread_count && result == STATUS_SUCCESS; ++i)
+        {
+            result = shards[i].result;
+        }
+
+        /// THE FIRST SHARD'S TABLE BECOMES THE MERGED VIEW
+        if (result == STATUS_SUCCESS && (table = (struct hash_table *)memory_alloc(sizeof(struct hash_table))) != NULL)
+        {
+            *table = shards[0].table;
+            shards[0].table.trees = NULL;
+            *word_count = shards[0].word_count;
+
+            for (unsigned int i = 1; i < thread_count; ++i)
+            {
+                if (merge_table(table, &shards[i].table, hash_code, seq_cmp) != STATUS_SUCCESS)
+                {
+                    clean_table(table);
+                    memory_free(table);
+                    table = NULL;
+                    break;
+                }
+                *word_count += shards[i].word_count;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < started; ++i)
+    {
+        clean_table(&shards[i].table);
+    }
+
+    memory_free(threads);
+    memory_free(shards);
+
+    /// THE STAGE TIME IS THE WALL TIME, NOT THE SUM OF THE THREADS
+    STATS_STOP(STATS_FREQUENCY_TABLE, clock);
+    set_memory_stage(previous_stage);
+    return table;
+}
+
+double words_entropy(struct coding_context * context, const void * const data, const unsigned int length)
+{
+    if (context == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    double entropy;
+    STATS_BIND(&context->stats);
+    STATS_ADD(bytes_in, length);
+
+    if (context->thread_count > 1)
+    {
+        unsigned int word_count;
+        entropy = table_entropy(context, parallel_word_table(data, length, context->table_size, context->word_capacity, context->thread_count, &word_count));
+    }
+    else
+    {
+        entropy = table_entropy(context, bounded_hash_table(data, length, context->specifier, context->table_size, context->word_capacity, &parse_words));
+    }
+
+    STATS_UNBIND();
+    return entropy;
+}
+
+double counts_entropy(struct coding_context * context, const void * const data, const unsigned int length)
+{
+    if (context == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    STATS_BIND(&context->stats);
+    STATS_ADD(bytes_in, length);
+    double entropy = table_entropy(context, frequency_hash_table(data, length, context->specifier, context->table_size, &parse_frequency_data));
+    STATS_UNBIND();
 
     return entropy;
 }
@@ -1,53 +1,175 @@
 #ifndef _SHANNON_H_
 #define _SHANNON_H_
 #include "hash_table.h"
+#include "context.h"
 
 /**
 *   @PARAMS
-*   filePath  - Path to the file containing the data
-*   specifier - The length of the sequences that are to be counted
-*   event - Pointer to a function that calculates the entropy of the data
+*   context  - Configuration of the analysis, receives the counts
+*   filePath - Path to the file containing the data
+*   event    - Pointer to a function that calculates the entropy of the data
 *
 *   @RETURN
 *   FILE_ERROR - sequence_one or sequence_two is NULL
 *   entropy    - Shannon Information
 */
-double shannon_entropy(const char * filePath, const unsigned int specifier, double (*event)(const void * const data, const unsigned int length, const unsigned int specifier));
+double shannon_entropy(struct coding_context * context, const char * filePath, double (*event)(struct coding_context * context, const void * const data, const unsigned int length));
 
 /**
+*   Sequences of context->specifier bytes, counted in a table of
+*   context->table_size trees.
+*
 *   @PARAMS
-*   data       - Memory address of data
-*   length     - In bytes
-*   specifier  - The length of the sequences that are to be counted
-*   table_size - Size of the hash-table
+*   context - Configuration of the analysis, receives the counts
+*   data    - Memory address of data
+*   length  - In bytes
 *
 *   @RETURN
-*   entropy    - Shannon Information
+*   NULL_ARGUMENT - context is NULL
+*   entropy       - Shannon Information
 */
-double sequence_entropy(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size);
+double sequence_entropy(struct coding_context * context, const void * const data, const unsigned int length);
 
 /**
+*   Block entropy of all the overlapping sequences (n-grams) of
+*   context->specifier bytes.
+*
 *   @PARAMS
-*   data       - Memory address of data
-*   length     - In bytes
-*   specifier  - The length of the sequences that are to be counted
-*   table_size - Size of the hash-table
+*   context - Configuration of the analysis, receives the counts
+*   data    - Memory address of data
+*   length  - In bytes
 *
 *   @RETURN
-*   entropy    - Shannon Information
+*   NULL_ARGUMENT - context is NULL
+*   entropy       - Shannon Information
 */
-double words_entropy(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size);
+double sliding_sequence_entropy(struct coding_context * context, const void * const data, const unsigned int length);
 
-struct hash_table * weight_seq_table(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size);
+/**
+*   Words are counted by context->thread_count threads (see parallel_word_table).
+*   With context->word_capacity the table is bounded (create_bounded_table):
+*   the frequent words are kept, the occurrences of the pruned ones are
+*   reported in context->other_count and make pieces of error_bound each,
+*   the most a pruned word can have, so the entropy is the least one of the
+*   data the summary can come from. At most word_capacity words are left
+*   (trim_table).
+*
+*   @PARAMS
+*   context - Configuration of the analysis, receives the counts
+*   data    - Memory address of data
+*   length  - In bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT - context is NULL
+*   entropy       - Shannon Information
+*/
+double words_entropy(struct coding_context * context, const void * const data, const unsigned int length);
 
-int parse_words(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier);
+/**
+*   Entropy of the counts image of a table (counts.h), e.g. the merge of the
+*   counts of many shards, without the data they were counted from.
+*
+*   @PARAMS
+*   context - Configuration of the analysis, receives the counts
+*   data    - Counts image
+*   length  - In bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT - context is NULL
+*   entropy       - Shannon Information
+*/
+double counts_entropy(struct coding_context * context, const void * const data, const unsigned int length);
+
+struct hash_table * weight_seq_table(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size);
 
+/**
+*   Counts the sequences of specifier bytes that follow each other. Single
+*   bytes are counted by the histogram of the CPU, sequences of 2 bytes in a
+*   flat array of 65536 counters and those of 3 to 8 bytes in a table of
+*   integer keys (fixed_table.h); every distinct sequence is then added to
+*   table once. Only longer sequences are counted in table directly.
+*
+*   @PARAMS
+*   table     - The hash-table in which the sequences are counted
+*   data      - Memory address of data
+*   length    - In bytes
+*   specifier - The length of the sequences that are to be counted
+*
+*   @RETURN
+*   NULL_ARGUMENT    - table or data is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate memory for a counter or a sequence
+*   STATUS_SUCCESS   - The sequences were counted
+*/
 int parse_sequences(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier);
 
+/**
+*   Counts every overlapping sequence of specifier bytes (a window sliding one
+*   byte at a time). Windows of 2 bytes are counted in a flat array and those
+*   of 3 to 8 bytes in a table of integer keys (fixed_table.h), longer ones
+*   are hashed in O(1) with a rolling hash; either way the keys are added with
+*   window_hash_code, so the table must be queried with it.
+*
+*   @PARAMS
+*   table     - The hash-table in which the sequences are counted
+*   data      - Memory address of data
+*   length    - In bytes
+*   specifier - The length of the sequences that are to be counted
+*
+*   @RETURN
+*   NULL_ARGUMENT    - table or data is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate memory for a new sequence
+*   STATUS_SUCCESS   - The sequences were counted
+*/
+int parse_sliding_sequences(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier);
+
+/**
+*   Counts the words of the data, the bytes between spaces. specifier is not
+*   used, it makes the signature the one of the other parsers.
+*
+*   @PARAMS
+*   table     - The hash-table in which the words are counted
+*   data      - Memory address of data
+*   length    - In bytes
+*   specifier - Not used
+*
+*   @RETURN
+*   NULL_ARGUMENT    - table or data is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate memory for a new word
+*   STATUS_SUCCESS   - The words were counted
+*/
 int parse_words(struct hash_table * table, const void * const data, const unsigned int length, const unsigned int specifier);
 
 struct hash_table * frequency_hash_table(const void * const data, const unsigned int length, const unsigned int specifier, const unsigned int table_size, int (*parse_data)(struct hash_table*, const void * const data, const unsigned int length, const unsigned int specifier));
 
+/**
+*   Counts the words of the buffer with thread_count threads. The buffer is cut
+*   at spaces, every thread fills a private table and the tables are merged.
+*
+*   @PARAMS
+*   data         - Memory address of data
+*   length       - In bytes
+*   table_size   - Size of every hash-table
+*   capacity     - Words tracked by every table (create_bounded_table), 0 for all
+*   thread_count - Number of threads
+*   word_count   - Receives the total number of words
+*
+*   @RETURN
+*    NULL - Invalid arguments or could not allocate / start the threads
+*   !NULL - Merged table, same content as frequency_hash_table with parse_words
+*           (the same summary guarantees when bounded)
+*/
+struct hash_table * parallel_word_table(const void * const data, const unsigned int length, const unsigned int table_size, const unsigned int capacity, const unsigned int thread_count, unsigned int * word_count);
+
+/**
+*   @PARAMS
+*   table - Frequency table
+*   total - Number of counted sequences / words (table->sample_count)
+*
+*   @RETURN
+*   entropy    - Shannon Information of the table
+*/
+double hash_table_entropy(const struct hash_table* const table, const unsigned int total);
+
 double huffman_entropy(struct node * huffman_node, const unsigned int level, const unsigned int length);
 
 #endif // _SHANNON_H_
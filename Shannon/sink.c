@@ -0,0 +1,185 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "sink.h"
+#include <string.h>
+#include <stdio.h>
+
+int create_buffer_sink(struct output_sink * sink, const unsigned int capacity)
+{
+    if (sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memset(sink, 0, sizeof(struct output_sink));
+    sink->capacity = capacity == 0 ? 1 : capacity;
+
+    if ((sink->buffer = (unsigned char *)memory_alloc(sink->capacity)) == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int create_callback_sink(struct output_sink * sink, const unsigned int chunk_size, int (*write)(void * state, const void * chunk, const unsigned int length), void * state)
+{
+    if (sink == NULL || write == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    int result = create_buffer_sink(sink, chunk_size == 0 ? DEFAULT_SINK_CHUNK : chunk_size);
+
+    sink->write = write;
+    sink->state = state;
+
+    return result;
+}
+
+int sink_drain(struct output_sink * sink)
+{
+    if (sink->write != NULL)
+    {
+        int result = sink->length == 0 ? STATUS_SUCCESS : sink->write(sink->state, sink->buffer, sink->length);
+
+        sink->flushed += sink->length;
+        sink->length = 0;
+        return result;
+    }
+
+    if (sink->length == sink->capacity)
+    {
+        unsigned int capacity = sink->capacity == 0 ? DEFAULT_SINK_CHUNK : sink->capacity > 0x7FFFFFFFU ? 0xFFFFFFFFU : sink->capacity << 1;
+        unsigned char * buffer = capacity == sink->capacity ? NULL : (unsigned char *)memory_realloc(sink->buffer, capacity);
+
+        if (buffer == NULL)
+        {
+            return BAD_MEMORY_ALLOC;
+        }
+
+        sink->buffer = buffer;
+        sink->capacity = capacity;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int sink_write(struct output_sink * sink, const void * data, const unsigned int length)
+{
+    if (sink == NULL || data == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    for (unsigned int offset = 0; offset < length;)
+    {
+        if (sink->length == sink->capacity)
+        {
+            int result = sink_drain(sink);
+
+            if (result != STATUS_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        unsigned int room = sink->capacity - sink->length;
+        unsigned int count = length - offset < room ? length - offset : room;
+
+        memcpy(sink->buffer + sink->length, (const unsigned char *)data + offset, count);
+        sink->length += count;
+        offset += count;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int sink_fill(struct output_sink * sink, const unsigned char value, const unsigned int count)
+{
+    if (sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    for (unsigned int offset = 0; offset < count;)
+    {
+        if (sink->length == sink->capacity)
+        {
+            int result = sink_drain(sink);
+
+            if (result != STATUS_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        unsigned int room = sink->capacity - sink->length;
+        unsigned int length = count - offset < room ? count - offset : room;
+
+        memset(sink->buffer + sink->length, value, length);
+        sink->length += length;
+        offset += length;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int sink_finish(struct output_sink * sink)
+{
+    if (sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    return sink->write == NULL ? STATUS_SUCCESS : sink_drain(sink);
+}
+
+unsigned long long sink_total(const struct output_sink * const sink)
+{
+    return sink == NULL ? 0 : sink->flushed + sink->length;
+}
+
+int sink_release(struct output_sink * sink, void ** data, unsigned int * length)
+{
+    if (sink == NULL || data == NULL || length == NULL || sink->write != NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned char * buffer = (unsigned char *)memory_realloc(sink->buffer, sink->length == 0 ? 1 : sink->length);
+
+    if (buffer == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    *data = buffer;
+    *length = sink->length;
+
+    sink->buffer = NULL;
+    sink->length = 0;
+    sink->capacity = 0;
+
+    return STATUS_SUCCESS;
+}
+
+int clean_sink(struct output_sink * sink)
+{
+    if (sink == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memory_free(sink->buffer);
+    sink->buffer = NULL;
+    sink->length = 0;
+    sink->capacity = 0;
+
+    return STATUS_SUCCESS;
+}
+
+int file_sink_write(void * state, const void * chunk, const unsigned int length)
+{
+    return fwrite(chunk, sizeof(unsigned char), length, (FILE *)state) == length ? STATUS_SUCCESS : FILE_ERROR;
+}
@@ -0,0 +1,118 @@
+#ifndef _SINK_H_
+#define _SINK_H_
+
+#define DEFAULT_SINK_CHUNK (64 * 1024)
+
+struct output_sink
+{
+    /// CALLED WITH EVERY FILLED CHUNK, NULL KEEPS THE WHOLE OUTPUT IN buffer
+    int (*write)(void * state, const void * chunk, const unsigned int length);
+    void * state;
+
+    /// BYTES WAITING IN buffer, capacity IS THE CHUNK SIZE OF A CALLBACK SINK
+    unsigned char * buffer;
+    unsigned int length;
+    unsigned int capacity;
+
+    /// BYTES ALREADY GIVEN TO write
+    unsigned long long flushed;
+};
+
+/**
+*   @PARAMS
+*   sink     - Memory address of the sink
+*   capacity - First size of the buffer, it doubles when full
+*
+*   @RETURN
+*   NULL_ARGUMENT    - sink is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the buffer
+*   STATUS_SUCCESS   - Sink collects the output in memory
+*/
+int create_buffer_sink(struct output_sink * sink, const unsigned int capacity);
+
+/**
+*   @PARAMS
+*   sink       - Memory address of the sink
+*   chunk_size - Bytes gathered before every call of write
+*   write      - Receives the chunks, a result other than STATUS_SUCCESS stops the coder
+*   state      - Passed to write untouched
+*
+*   @RETURN
+*   NULL_ARGUMENT    - sink or write is NULL
+*   BAD_MEMORY_ALLOC - Could not allocate the chunk
+*   STATUS_SUCCESS   - Sink hands the output to write
+*/
+int create_callback_sink(struct output_sink * sink, const unsigned int chunk_size, int (*write)(void * state, const void * chunk, const unsigned int length), void * state);
+
+/**
+*   Makes room in a full sink: a buffer sink grows, a callback sink hands its
+*   chunk to write. The coders only call it when length == capacity.
+*
+*   @RETURN
+*   BAD_MEMORY_ALLOC - A buffer sink could not grow
+*   STATUS_SUCCESS   - There is room for at least one byte
+*   Any error of write
+*/
+int sink_drain(struct output_sink * sink);
+
+/**
+*   @RETURN
+*   NULL_ARGUMENT  - sink or data is NULL
+*   STATUS_SUCCESS - All bytes were taken
+*   Any error of sink_drain
+*/
+int sink_write(struct output_sink * sink, const void * data, const unsigned int length);
+
+/**
+*   Writes count copies of value, a chunk at a time with memset.
+*
+*   @RETURN
+*   NULL_ARGUMENT  - sink is NULL
+*   STATUS_SUCCESS - All bytes were taken
+*   Any error of sink_drain
+*/
+int sink_fill(struct output_sink * sink, const unsigned char value, const unsigned int count);
+
+/**
+*   Hands the bytes left in a callback sink to write, a buffer sink keeps them.
+*
+*   @RETURN
+*   NULL_ARGUMENT  - sink is NULL
+*   STATUS_SUCCESS - Nothing is waiting in a callback sink anymore
+*   Any error of write
+*/
+int sink_finish(struct output_sink * sink);
+
+/**
+*   @RETURN
+*   Bytes given to the sink so far
+*/
+unsigned long long sink_total(const struct output_sink * const sink);
+
+/**
+*   Moves the output of a buffer sink to the caller, the sink is left empty.
+*
+*   @PARAMS
+*   sink   - Buffer sink
+*   data   - Receives the output (allocated, at least 1 byte)
+*   length - Receives the length of the output in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL or sink is a callback sink
+*   BAD_MEMORY_ALLOC - Could not shrink the buffer
+*   STATUS_SUCCESS   - Output was moved
+*/
+int sink_release(struct output_sink * sink, void ** data, unsigned int * length);
+
+int clean_sink(struct output_sink * sink);
+
+/**
+*   Callback of a sink that writes to a file, state is the FILE *.
+*
+*   @RETURN
+*   FILE_ERROR     - Not every byte could be written
+*   STATUS_SUCCESS - Chunk was written
+*/
+int file_sink_write(void * state, const void * chunk, const unsigned int length);
+
+#endif // _SINK_H_
@@ -0,0 +1,477 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "sketch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define FNV_PRIME 0x100000001B3ULL
+#define SKETCH_CHUNK_SIZE 65536
+
+static unsigned long long hash_step(unsigned long long hash, const unsigned char byte)
+{
+    return (hash ^ byte) * FNV_PRIME;
+}
+
+static unsigned long long hash_final(unsigned long long hash)
+{
+    /// FNV-1a HAS WEAK HIGH BITS, MIX THEM BEFORE SPLITTING THE HASH
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static unsigned long long word_hash(const void * const word, const unsigned int length)
+{
+    unsigned long long hash = SKETCH_HASH_SEED;
+
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        hash = hash_step(hash, *((const unsigned char *)word + i));
+    }
+
+    return hash_final(hash);
+}
+
+static unsigned long long * counter_of(const struct word_sketch * const sketch, const unsigned long long hash, const unsigned int row)
+{
+    /// DOUBLE HASHING: ROW i USES h1 + i * h2
+    unsigned int first  = (unsigned int)hash;
+    unsigned int second = (unsigned int)(hash >> 32) | 1;
+    return sketch->counters + row * sketch->width + (first + row * second) % sketch->width;
+}
+
+int create_sketch(struct word_sketch * sketch, const unsigned int precision, const unsigned int width, const unsigned int depth, const unsigned int heavy_capacity)
+{
+    if (sketch == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (precision < 4 || precision > 18 || width == 0 || depth == 0)
+    {
+        return INVALID_FORMAT;
+    }
+
+    memset(sketch, 0, sizeof(struct word_sketch));
+
+    sketch->precision = precision;
+    sketch->width = width;
+    sketch->depth = depth;
+    sketch->heavy_capacity = heavy_capacity;
+    sketch->word_hash = SKETCH_HASH_SEED;
+
+    sketch->registers = (unsigned char *)memory_calloc(1u << precision, sizeof(unsigned char));
+    sketch->counters = (unsigned long long *)memory_calloc(width * depth, sizeof(unsigned long long));
+    sketch->heavy = (struct sketch_entry *)memory_calloc(heavy_capacity + 1, sizeof(struct sketch_entry));
+
+    /// AT MOST HALF OF THE SLOTS OF THE INDEX ARE TAKEN
+    while ((1u << sketch->index_bits) < 2 * heavy_capacity)
+    {
+        ++sketch->index_bits;
+    }
+    sketch->heavy_index = (unsigned int *)memory_calloc(1u << sketch->index_bits, sizeof(unsigned int));
+
+    if (sketch->registers == NULL || sketch->counters == NULL || sketch->heavy == NULL || sketch->heavy_index == NULL)
+    {
+        clean_sketch(sketch);
+        return BAD_MEMORY_ALLOC;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+unsigned int sketch_memory(const struct word_sketch * const sketch)
+{
+    if (sketch == NULL)
+    {
+        return 0;
+    }
+
+    return sizeof(struct word_sketch)
+           + (1u << sketch->precision) * sizeof(unsigned char)
+           + sketch->width * sketch->depth * sizeof(unsigned long long)
+           + (sketch->heavy_capacity + 1) * sizeof(struct sketch_entry)
+           + (1u << sketch->index_bits) * sizeof(unsigned int);
+}
+
+/// SLOT OF THE INDEX THAT HOLDS hash, OR THE FREE ONE WHERE IT GOES
+static unsigned int * index_slot(const struct word_sketch * const sketch, const unsigned long long hash)
+{
+    const unsigned int mask = (1u << sketch->index_bits) - 1;
+    unsigned int slot = (unsigned int)hash & mask;
+
+    while (sketch->heavy_index[slot] != 0 && sketch->heavy[sketch->heavy_index[slot] - 1].hash != hash)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return sketch->heavy_index + slot;
+}
+
+/// FREES THE SLOT OF hash AND MOVES BACK THE WORDS AFTER IT THAT WOULD NOT BE FOUND ANY MORE (NO TOMBSTONES)
+static void remove_index(struct word_sketch * sketch, const unsigned long long hash)
+{
+    const unsigned int mask = (1u << sketch->index_bits) - 1;
+    unsigned int hole = (unsigned int)(index_slot(sketch, hash) - sketch->heavy_index);
+
+    sketch->heavy_index[hole] = 0;
+
+    for (unsigned int slot = (hole + 1) & mask; sketch->heavy_index[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const unsigned int home = (unsigned int)sketch->heavy[sketch->heavy_index[slot] - 1].hash & mask;
+
+        if (((slot - home) & mask) >= ((slot - hole) & mask))
+        {
+            sketch->heavy_index[hole] = sketch->heavy_index[slot];
+            sketch->heavy_index[slot] = 0;
+            hole = slot;
+        }
+    }
+}
+
+static void swap_heavy(struct word_sketch * sketch, const unsigned int first, const unsigned int second)
+{
+    /// THE SLOTS ARE FOUND BEFORE THE SWAP, index_slot COMPARES THE HASHES AT THE POSITIONS THEY HOLD
+    unsigned int * first_slot = index_slot(sketch, sketch->heavy[first].hash);
+    unsigned int * second_slot = index_slot(sketch, sketch->heavy[second].hash);
+    struct sketch_entry entry = sketch->heavy[first];
+
+    sketch->heavy[first] = sketch->heavy[second];
+    sketch->heavy[second] = entry;
+    *first_slot = second + 1;
+    *second_slot = first + 1;
+}
+
+static void sift_up(struct word_sketch * sketch, unsigned int position)
+{
+    while (position > 0 && sketch->heavy[position].total < sketch->heavy[(position - 1) / 2].total)
+    {
+        swap_heavy(sketch, position, (position - 1) / 2);
+        position = (position - 1) / 2;
+    }
+}
+
+static void sift_down(struct word_sketch * sketch, unsigned int position)
+{
+    for (;;)
+    {
+        unsigned int smallest = position;
+        const unsigned int left = 2 * position + 1;
+
+        if (left < sketch->heavy_count && sketch->heavy[left].total < sketch->heavy[smallest].total)
+        {
+            smallest = left;
+        }
+
+        if (left + 1 < sketch->heavy_count && sketch->heavy[left + 1].total < sketch->heavy[smallest].total)
+        {
+            smallest = left + 1;
+        }
+
+        if (smallest == position)
+        {
+            return;
+        }
+
+        swap_heavy(sketch, position, smallest);
+        position = smallest;
+    }
+}
+
+static void add_hash(struct word_sketch * sketch, const unsigned long long hash)
+{
+    ++sketch->total;
+
+    /// HYPERLOGLOG: FIRST precision BITS PICK THE REGISTER, THE REST GIVE THE RANK
+    {
+        unsigned int index = (unsigned int)(hash >> (64 - sketch->precision));
+        unsigned long long rest = hash << sketch->precision;
+        unsigned char rank = rest == 0 ? (unsigned char)(64 - sketch->precision + 1) : (unsigned char)(__builtin_clzll(rest) + 1);
+
+        if (rank > sketch->registers[index])
+        {
+            sketch->registers[index] = rank;
+        }
+    }
+
+    /// COUNT-MIN WITH CONSERVATIVE UPDATE: ONLY RAISE THE COUNTERS THAT ARE AT THE MINIMUM
+    unsigned long long estimate = ~0ULL;
+    for (unsigned int row = 0; row < sketch->depth; ++row)
+    {
+        unsigned long long counter = *counter_of(sketch, hash, row);
+        estimate = counter < estimate ? counter : estimate;
+    }
+
+    ++estimate;
+    for (unsigned int row = 0; row < sketch->depth; ++row)
+    {
+        unsigned long long * counter = counter_of(sketch, hash, row);
+
+        if (*counter < estimate)
+        {
+            *counter = estimate;
+        }
+    }
+
+    /// KEEP THE heavy_capacity WORDS WITH THE HIGHEST ESTIMATES
+    if (sketch->heavy_capacity == 0)
+    {
+        return;
+    }
+
+    unsigned int * slot = index_slot(sketch, hash);
+
+    /// AN ESTIMATE NEVER DECREASES, A TRACKED WORD CAN ONLY MOVE DOWN THE HEAP
+    if (*slot != 0)
+    {
+        sketch->heavy[*slot - 1].total = estimate;
+        sift_down(sketch, *slot - 1);
+    }
+    else if (sketch->heavy_count < sketch->heavy_capacity)
+    {
+        sketch->heavy[sketch->heavy_count].hash = hash;
+        sketch->heavy[sketch->heavy_count].total = estimate;
+        *slot = ++sketch->heavy_count;
+        sift_up(sketch, sketch->heavy_count - 1);
+    }
+    else if (sketch->heavy[0].total < estimate)
+    {
+        remove_index(sketch, sketch->heavy[0].hash);
+        sketch->heavy[0].hash = hash;
+        sketch->heavy[0].total = estimate;
+        *index_slot(sketch, hash) = 1;
+        sift_down(sketch, 0);
+    }
+}
+
+int sketch_add(struct word_sketch * sketch, const void * const word, const unsigned int length)
+{
+    if (sketch == NULL || word == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    add_hash(sketch, word_hash(word, length));
+    return STATUS_SUCCESS;
+}
+
+int sketch_feed(struct word_sketch * sketch, const void * const data, const unsigned int length)
+{
+    if (sketch == NULL || data == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        unsigned char byte = *((const unsigned char *)data + i);
+
+        if (byte != ' ')
+        {
+            sketch->word_hash = hash_step(sketch->word_hash, byte);
+            sketch->in_word = 1;
+        }
+        else if (sketch->in_word)
+        {
+            add_hash(sketch, hash_final(sketch->word_hash));
+            sketch->word_hash = SKETCH_HASH_SEED;
+            sketch->in_word = 0;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int sketch_finish(struct word_sketch * sketch)
+{
+    if (sketch == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (sketch->in_word)
+    {
+        add_hash(sketch, hash_final(sketch->word_hash));
+        sketch->word_hash = SKETCH_HASH_SEED;
+        sketch->in_word = 0;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int sketch_stream(struct word_sketch * sketch, FILE * stream)
+{
+    if (sketch == NULL || stream == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned char chunk[SKETCH_CHUNK_SIZE];
+    size_t read;
+
+    while ((read = fread(chunk, sizeof(unsigned char), SKETCH_CHUNK_SIZE, stream)) > 0)
+    {
+        sketch_feed(sketch, chunk, (unsigned int)read);
+    }
+
+    if (ferror(stream))
+    {
+        return FILE_ERROR;
+    }
+
+    return sketch_finish(sketch);
+}
+
+double sketch_distinct_words(const struct word_sketch * const sketch)
+{
+    if (sketch == NULL || sketch->registers == NULL)
+    {
+        return 0;
+    }
+
+    const unsigned int registers = 1u << sketch->precision;
+    unsigned int zeros = 0;
+    double sum = 0.0;
+
+    for (unsigned int i = 0; i < registers; ++i)
+    {
+        sum += ldexp(1.0, -sketch->registers[i]);
+        zeros += sketch->registers[i] == 0;
+    }
+
+    double alpha;
+    switch (registers)
+    {
+    case 16:
+        alpha = 0.673;
+        break;
+    case 32:
+        alpha = 0.697;
+        break;
+    case 64:
+        alpha = 0.709;
+        break;
+    default:
+        alpha = 0.7213 / (1.0 + 1.079 / registers);
+        break;
+    }
+
+    double estimate = alpha * registers * registers / sum;
+
+    /// SMALL RANGE CORRECTION: LINEAR COUNTING
+    if (estimate <= 2.5 * registers && zeros != 0)
+    {
+        estimate = registers * log(registers / (double)zeros);
+    }
+
+    return estimate;
+}
+
+unsigned long long sketch_word_count(const struct word_sketch * const sketch, const void * const word, const unsigned int length)
+{
+    if (sketch == NULL || word == NULL || sketch->counters == NULL)
+    {
+        return 0;
+    }
+
+    unsigned long long hash = word_hash(word, length);
+    unsigned long long estimate = ~0ULL;
+
+    for (unsigned int row = 0; row < sketch->depth; ++row)
+    {
+        unsigned long long counter = *counter_of(sketch, hash, row);
+        estimate = counter < estimate ? counter : estimate;
+    }
+
+    return estimate;
+}
+
+double sketch_entropy(const struct word_sketch * const sketch)
+{
+    if (sketch == NULL || sketch->total == 0)
+    {
+        return 0;
+    }
+
+    const double total = (double)sketch->total;
+    double entropy = 0.0;
+    double remaining = total;
+
+    for (unsigned int i = 0; i < sketch->heavy_count; ++i)
+    {
+        double frequency = (double)sketch->heavy[i].total;
+
+        /// OVERESTIMATED COUNTERS CAN NOT TAKE MORE THAN WHAT IS LEFT
+        if (frequency > remaining)
+        {
+            frequency = remaining;
+        }
+
+        if (frequency > 0)
+        {
+            double probability = frequency / total;
+            entropy -= probability * log(probability) / log(2.0);
+            remaining -= frequency;
+        }
+    }
+
+    if (remaining > 0)
+    {
+        double others = sketch_distinct_words(sketch) - sketch->heavy_count;
+
+        if (others < 1.0)
+        {
+            others = 1.0;
+        }
+
+        if (others > remaining)
+        {
+            others = remaining;
+        }
+
+        double probability = remaining / total;
+        entropy -= probability * log(probability / others) / log(2.0);
+    }
+
+    return entropy;
+}
+
+int sketch_error_bounds(const struct word_sketch * const sketch, struct sketch_bounds * bounds)
+{
+    if (sketch == NULL || bounds == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    /// HLL: 1.04 / sqrt(m), COUNT-MIN: e * N / width WITH PROBABILITY 1 - e ^ -depth
+    bounds->distinct_error = 1.04 / sqrt((double)(1u << sketch->precision));
+    bounds->frequency_error = exp(1.0) * (double)sketch->total / sketch->width;
+    bounds->frequency_confidence = 1.0 - exp(-(double)sketch->depth);
+
+    return STATUS_SUCCESS;
+}
+
+int clean_sketch(struct word_sketch * sketch)
+{
+    if (sketch == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memory_free(sketch->registers);
+    memory_free(sketch->counters);
+    memory_free(sketch->heavy);
+    memory_free(sketch->heavy_index);
+
+    sketch->registers = NULL;
+    sketch->counters = NULL;
+    sketch->heavy = NULL;
+    sketch->heavy_index = NULL;
+    sketch->heavy_count = 0;
+    sketch->total = 0;
+
+    return STATUS_SUCCESS;
+}
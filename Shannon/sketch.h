@@ -0,0 +1,175 @@
+#ifndef _SKETCH_H_
+#define _SKETCH_H_
+#include <stdio.h>
+
+#define SKETCH_HASH_SEED 0xCBF29CE484222325ULL
+
+struct sketch_entry
+{
+    /// HASH OF THE WORD AND ITS ESTIMATED FREQUENCY
+    unsigned long long hash;
+    unsigned long long total;
+};
+
+struct sketch_bounds
+{
+    /// STANDARD RELATIVE ERROR OF THE DISTINCT WORD COUNT
+    double distinct_error;
+
+    /// A FREQUENCY IS OVERESTIMATED BY AT MOST frequency_error WORDS...
+    double frequency_error;
+
+    /// ...WITH THIS PROBABILITY
+    double frequency_confidence;
+};
+
+struct word_sketch
+{
+    /// HYPERLOGLOG REGISTERS (2 ^ precision OF THEM)
+    unsigned char * registers;
+    unsigned int precision;
+
+    /// COUNT-MIN SKETCH (depth ROWS OF width COUNTERS), 64 BITS SO A COUNTER NEVER WRAPS AROUND
+    unsigned long long * counters;
+    unsigned int width;
+    unsigned int depth;
+
+    /// MOST FREQUENT WORDS SEEN SO FAR, USED BY THE ENTROPY ESTIMATE: A MIN-HEAP ON THE TOTALS, SO THE WORD
+    /// THAT A NEW ONE REPLACES IS THE FIRST
+    struct sketch_entry * heavy;
+    unsigned int heavy_capacity;
+    unsigned int heavy_count;
+
+    /// OPEN-ADDRESSING INDEX OF THE HEAP BY HASH (2 ^ index_bits SLOTS): POSITION + 1 OF THE WORD, 0 IF FREE
+    unsigned int * heavy_index;
+    unsigned int index_bits;
+
+    /// NUMBER OF WORDS SEEN
+    unsigned long long total;
+
+    /// STATE OF A WORD SPLIT BETWEEN TWO CHUNKS OF THE STREAM
+    unsigned long long word_hash;
+    unsigned char in_word;
+};
+
+/**
+*   @PARAMS
+*   sketch         - Memory address of the sketch
+*   precision      - log2 of the number of HyperLogLog registers (4 - 18)
+*   width          - Counters in a row of the count-min sketch
+*   depth          - Rows of the count-min sketch
+*   heavy_capacity - How many frequent words are tracked for the entropy estimate
+*
+*   @RETURN
+*   NULL_ARGUMENT    - sketch is NULL
+*   INVALID_FORMAT   - precision is out of range or width / depth is 0
+*   BAD_MEMORY_ALLOC - Could not allocate the sketch
+*   STATUS_SUCCESS   - Sketch successfully created
+*/
+int create_sketch(struct word_sketch * sketch, const unsigned int precision, const unsigned int width, const unsigned int depth, const unsigned int heavy_capacity);
+
+/**
+*   @PARAMS
+*   sketch - Memory address of the sketch
+*
+*   @RETURN
+*   Bytes used by the sketch, independent of the length of the stream
+*/
+unsigned int sketch_memory(const struct word_sketch * const sketch);
+
+/**
+*   @PARAMS
+*   sketch - Memory address of the sketch
+*   word   - Memory address of the word
+*   length - In bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT  - sketch or word is NULL
+*   STATUS_SUCCESS - The word was counted
+*/
+int sketch_add(struct word_sketch * sketch, const void * const word, const unsigned int length);
+
+/**
+*   Splits the chunk into words the same way parse_words does. A word cut at the
+*   end of the chunk is continued by the next call, so the stream can be fed in
+*   arbitrary pieces. Call sketch_finish after the last chunk.
+*
+*   @PARAMS
+*   sketch - Memory address of the sketch
+*   data   - Memory address of the chunk
+*   length - In bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT  - sketch or data is NULL
+*   STATUS_SUCCESS - The chunk was counted
+*/
+int sketch_feed(struct word_sketch * sketch, const void * const data, const unsigned int length);
+
+/**
+*   @PARAMS
+*   sketch - Memory address of the sketch
+*
+*   @RETURN
+*   NULL_ARGUMENT  - sketch is NULL
+*   STATUS_SUCCESS - The pending word (if any) was counted
+*/
+int sketch_finish(struct word_sketch * sketch);
+
+/**
+*   Feeds the sketch from a stream until EOF, in chunks of constant size.
+*
+*   @PARAMS
+*   sketch - Memory address of the sketch
+*   stream - Opened stream (file, pipe, stdin)
+*
+*   @RETURN
+*   NULL_ARGUMENT  - sketch or stream is NULL
+*   FILE_ERROR     - Reading from the stream failed
+*   STATUS_SUCCESS - The whole stream was counted
+*/
+int sketch_stream(struct word_sketch * sketch, FILE * stream);
+
+/**
+*   @RETURN
+*   Estimated number of distinct words (HyperLogLog)
+*/
+double sketch_distinct_words(const struct word_sketch * const sketch);
+
+/**
+*   @RETURN
+*   Estimated frequency of the word, never smaller than the real one (count-min)
+*/
+unsigned long long sketch_word_count(const struct word_sketch * const sketch, const void * const word, const unsigned int length);
+
+/**
+*   Entropy estimate: the tracked frequent words contribute exactly their
+*   estimated probability, the remaining words are assumed to share the
+*   remaining mass uniformly over the remaining distinct words.
+*
+*   @RETURN
+*   entropy - Estimated Shannon Information of the words
+*/
+double sketch_entropy(const struct word_sketch * const sketch);
+
+/**
+*   @PARAMS
+*   sketch - Memory address of the sketch
+*   bounds - Receives the error bounds for the current stream
+*
+*   @RETURN
+*   NULL_ARGUMENT  - sketch or bounds is NULL
+*   STATUS_SUCCESS - Bounds were computed
+*/
+int sketch_error_bounds(const struct word_sketch * const sketch, struct sketch_bounds * bounds);
+
+/**
+*   @PARAMS
+*   sketch - Memory address of the sketch
+*
+*   @RETURN
+*   NULL_ARGUMENT  - sketch is NULL
+*   STATUS_SUCCESS - Sketch successfully cleaned
+*/
+int clean_sketch(struct word_sketch * sketch);
+
+#endif // _SKETCH_H_
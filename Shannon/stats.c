@@ -0,0 +1,83 @@
+#include "utilities.h"
+#include "stats.h"
+#include <string.h>
+#include <stdio.h>
+
+const char * const stats_stage_names[STATS_STAGE_COUNT] =
+{
+    "frequency_table", "table_to_heap", "huffman_tree", "code_table", "encode", "decode"
+};
+
+#ifdef SHANNON_STATS
+_Thread_local struct coding_stats * bound_stats = NULL;
+#endif
+
+int reset_stats(struct coding_stats * stats)
+{
+    if (stats == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memset(stats, 0, sizeof(struct coding_stats));
+    return STATUS_SUCCESS;
+}
+
+int add_stats(struct coding_stats * destination, const struct coding_stats * const source)
+{
+    if (destination == NULL || source == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    for (unsigned int stage = 0; stage < STATS_STAGE_COUNT; ++stage)
+    {
+        destination->stage_seconds[stage] += source->stage_seconds[stage];
+    }
+
+    destination->hash_lookups += source->hash_lookups;
+    destination->avl_compares += source->avl_compares;
+    destination->avl_rotations += source->avl_rotations;
+    destination->heap_pushes += source->heap_pushes;
+    destination->heap_pops += source->heap_pops;
+    destination->bytes_in += source->bytes_in;
+    destination->bytes_out += source->bytes_out;
+
+    return STATUS_SUCCESS;
+}
+
+struct coding_stats * bind_stats(struct coding_stats * stats)
+{
+#ifdef SHANNON_STATS
+    struct coding_stats * previous = bound_stats;
+    bound_stats = stats;
+    return previous;
+#else
+    return NULL;
+#endif
+}
+
+int print_stats(FILE * stream, const char * label, const struct coding_stats * const stats)
+{
+    if (stream == NULL || stats == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    char line[1024];
+    int used = snprintf(line, sizeof(line), "%s:", label == NULL ? "stats" : label);
+
+    for (unsigned int stage = 0; stage < STATS_STAGE_COUNT && used < (int)sizeof(line); ++stage)
+    {
+        used += snprintf(line + used, sizeof(line) - used, " %s=%.6fs", stats_stage_names[stage], stats->stage_seconds[stage]);
+    }
+
+    if (used < (int)sizeof(line))
+    {
+        snprintf(line + used, sizeof(line) - used,
+                 " hash_lookups=%llu avl_compares=%llu avl_rotations=%llu heap_pushes=%llu heap_pops=%llu bytes_in=%llu bytes_out=%llu\n",
+                 stats->hash_lookups, stats->avl_compares, stats->avl_rotations, stats->heap_pushes, stats->heap_pops, stats->bytes_in, stats->bytes_out);
+    }
+
+    return fputs(line, stream) == EOF ? FILE_ERROR : STATUS_SUCCESS;
+}
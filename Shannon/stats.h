@@ -0,0 +1,110 @@
+#ifndef _STATS_H_
+#define _STATS_H_
+#include <stdio.h>
+
+/// THE STATISTICS ARE ONLY COLLECTED WHEN BUILT WITH -DSHANNON_STATS, OTHERWISE EVERY MACRO BELOW IS EMPTY
+#ifdef SHANNON_STATS
+#define STATS_ENABLED 1
+#else
+#define STATS_ENABLED 0
+#endif
+
+enum stats_stage
+{
+    STATS_FREQUENCY_TABLE = 0,
+    STATS_TABLE_TO_HEAP   = 1,
+    STATS_HUFFMAN_TREE    = 2,
+    STATS_CODE_TABLE      = 3,
+    STATS_ENCODE          = 4,
+    STATS_DECODE          = 5,
+    STATS_STAGE_COUNT     = 6
+};
+
+struct coding_stats
+{
+    /// WALL TIME OF EVERY STAGE IN SECONDS
+    double stage_seconds[STATS_STAGE_COUNT];
+
+    /// OPERATION COUNTS
+    unsigned long long hash_lookups;
+    unsigned long long avl_compares;
+    unsigned long long avl_rotations;
+    unsigned long long heap_pushes;
+    unsigned long long heap_pops;
+
+    /// BYTES READ / WRITTEN BY THE ENCODE, DECODE AND ENTROPY CALLS
+    unsigned long long bytes_in;
+    unsigned long long bytes_out;
+};
+
+extern const char * const stats_stage_names[STATS_STAGE_COUNT];
+
+/**
+*   @PARAMS
+*   stats - Memory address of the statistics
+*
+*   @RETURN
+*   NULL_ARGUMENT  - stats is NULL
+*   STATUS_SUCCESS - Every counter was set to 0
+*/
+int reset_stats(struct coding_stats * stats);
+
+/**
+*   @PARAMS
+*   destination - Statistics that receive the sum
+*   source      - Statistics added to destination, e.g. those of a worker thread
+*
+*   @RETURN
+*   NULL_ARGUMENT  - destination or source is NULL
+*   STATUS_SUCCESS - source was added to destination
+*/
+int add_stats(struct coding_stats * destination, const struct coding_stats * const source);
+
+/**
+*   Makes the counters of this thread go to stats (NULL stops the collection).
+*   The encode, decode and entropy calls bind the stats of their context and
+*   restore the previous binding when they return.
+*
+*   @PARAMS
+*   stats - Memory address of the statistics, may be NULL
+*
+*   @RETURN
+*   The statistics bound before (always NULL when the collection is compiled out)
+*/
+struct coding_stats * bind_stats(struct coding_stats * stats);
+
+/**
+*   Prints the statistics on one line, with a single write so that the lines
+*   of several threads do not mix.
+*
+*   @PARAMS
+*   stream - Output stream
+*   label  - Printed first, e.g. the name of the file
+*   stats  - Memory address of the statistics
+*
+*   @RETURN
+*   NULL_ARGUMENT  - stream or stats is NULL
+*   FILE_ERROR     - Could not write to the stream
+*   STATUS_SUCCESS - Statistics were printed
+*/
+int print_stats(FILE * stream, const char * label, const struct coding_stats * const stats);
+
+#ifdef SHANNON_STATS
+extern _Thread_local struct coding_stats * bound_stats;
+
+#define STATS_BIND(stats)          struct coding_stats * const previous_stats = bind_stats(stats)
+#define STATS_UNBIND()             bind_stats(previous_stats)
+#define STATS_ADD(counter, amount) do { if (bound_stats != NULL) bound_stats->counter += (amount); } while (0)
+#define STATS_MERGE(stats)         do { if (bound_stats != NULL) add_stats(bound_stats, stats); } while (0)
+#define STATS_START(clock)         const double clock = monotonic_seconds()
+#define STATS_STOP(stage, clock)   do { if (bound_stats != NULL) bound_stats->stage_seconds[stage] += monotonic_seconds() - clock; } while (0)
+#else
+#define STATS_BIND(stats)
+#define STATS_UNBIND()             ((void)0)
+#define STATS_ADD(counter, amount) ((void)0)
+#define STATS_MERGE(stats)         ((void)0)
+#define STATS_START(clock)
+#define STATS_STOP(stage, clock)   ((void)0)
+#endif
+
+#endif // _STATS_H_
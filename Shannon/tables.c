@@ -0,0 +1,265 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "container.h"
+#include "huffman.h"
+#include "tables.h"
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static unsigned int align_offset(const unsigned int offset)
+{
+    return (offset + TABLES_ALIGNMENT - 1) / TABLES_ALIGNMENT * TABLES_ALIGNMENT;
+}
+
+int create_huffman_tables(const struct node * const huffman_root, struct huffman_tables * tables)
+{
+    if (huffman_root == NULL || tables == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memset(tables, 0, sizeof(struct huffman_tables));
+
+    struct hash_table * codes = huffman_code_table(huffman_root, DEFAULT_TABLE_SIZE, &huffman_hash);
+    struct tables_header header;
+    void * tree = NULL;
+    unsigned char * file = NULL;
+    int result = STATUS_SUCCESS;
+
+    memset(&header, 0, sizeof(struct tables_header));
+    memcpy(header.magic, TABLES_MAGIC, 3);
+    header.version = TABLES_VERSION;
+    header.byte_order = TABLES_BYTE_ORDER;
+    header.codebook_size = sizeof(struct huffman_codebook);
+    header.decode_size = sizeof(struct decode_table);
+    header.codebook_offset = align_offset(sizeof(struct tables_header));
+    header.decode_offset = align_offset(header.codebook_offset + header.codebook_size);
+    header.tree_offset = align_offset(header.decode_offset + header.decode_size);
+
+    if (codes == NULL)
+    {
+        return NULL_RESULT;
+    }
+
+    if ((result = serialize_huffman_tree(huffman_root, &tree, &header.tree_length)) == STATUS_SUCCESS
+            && (file = (unsigned char *)memory_calloc(header.tree_offset + header.tree_length, sizeof(unsigned char))) == NULL)
+    {
+        result = BAD_MEMORY_ALLOC;
+    }
+
+    /// THE STRUCTURES ARE BUILT IN PLACE, THE IMAGE IS WHAT save_huffman_tables WRITES
+    if (result == STATUS_SUCCESS
+            && (build_huffman_codebook(codes, (struct huffman_codebook *)(file + header.codebook_offset)) != STATUS_SUCCESS
+                || build_decode_table(huffman_root, (struct decode_table *)(file + header.decode_offset)) != STATUS_SUCCESS))
+    {
+        result = NULL_RESULT;
+    }
+
+    if (result == STATUS_SUCCESS)
+    {
+        memcpy(file, &header, sizeof(struct tables_header));
+        memcpy(file + header.tree_offset, tree, header.tree_length);
+
+        tables->codebook = (const struct huffman_codebook *)(file + header.codebook_offset);
+        tables->decode = (const struct decode_table *)(file + header.decode_offset);
+        tables->tree = file + header.tree_offset;
+        tables->tree_length = header.tree_length;
+        tables->file = file;
+        tables->file_length = header.tree_offset + header.tree_length;
+    }
+    else
+    {
+        memory_free(file);
+    }
+
+    memory_free(tree);
+    clean_huffman_table(codes);
+    memory_free(codes);
+    return result;
+}
+
+int save_huffman_tables(const struct node * const huffman_root, const char * file_name)
+{
+    if (huffman_root == NULL || file_name == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    struct huffman_tables tables;
+    int result = create_huffman_tables(huffman_root, &tables);
+
+    if (result == STATUS_SUCCESS)
+    {
+        size_t length = strlen(file_name);
+        char * temporary = (char *)memory_alloc(length + sizeof(".tmp"));
+
+        if (temporary == NULL)
+        {
+            result = BAD_MEMORY_ALLOC;
+        }
+        else
+        {
+            memcpy(temporary, file_name, length);
+            memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+
+            if ((result = write_data(temporary, tables.file, (unsigned int)tables.file_length)) == STATUS_SUCCESS
+                    && rename(temporary, file_name) != 0)
+            {
+                remove(temporary);
+                result = FILE_ERROR;
+            }
+
+            memory_free(temporary);
+        }
+
+        unmap_huffman_tables(&tables);
+    }
+
+    return result;
+}
+
+static bool valid_section(const size_t file_length, const unsigned int offset, const unsigned long long size)
+{
+    return offset % TABLES_ALIGNMENT == 0 && offset <= file_length && size <= file_length - offset;
+}
+
+static int validate_tables(const struct huffman_tables * tables)
+{
+    const struct tables_header * header = (const struct tables_header *)tables->file;
+
+    if (tables->file_length < sizeof(struct tables_header) || memcmp(header->magic, TABLES_MAGIC, 3) != 0
+            || header->version != TABLES_VERSION || header->byte_order != TABLES_BYTE_ORDER
+            || header->codebook_size != sizeof(struct huffman_codebook) || header->decode_size != sizeof(struct decode_table)
+            || !valid_section(tables->file_length, header->codebook_offset, header->codebook_size)
+            || !valid_section(tables->file_length, header->decode_offset, header->decode_size)
+            || !valid_section(tables->file_length, header->tree_offset, header->tree_length) || header->tree_length == 0)
+    {
+        return CORRUPT_DATA;
+    }
+
+    const struct huffman_codebook * book = (const struct huffman_codebook *)((const unsigned char *)tables->file + header->codebook_offset);
+    const struct decode_table * decode = (const struct decode_table *)((const unsigned char *)tables->file + header->decode_offset);
+
+    /// THE KERNELS TRUST THE TABLES, A DAMAGED FILE MUST NOT SEND THEM OUT OF BOUNDS
+    if (book->max_length > 56 || decode->node_count > DECODE_MAX_NODES)
+    {
+        return CORRUPT_DATA;
+    }
+
+    for (unsigned int value = 0; value < 256; ++value)
+    {
+        if (book->length[value] > book->max_length)
+        {
+            return CORRUPT_DATA;
+        }
+    }
+
+    for (unsigned int index = 0; index < (1U << DECODE_TABLE_BITS); ++index)
+    {
+        const struct decode_entry * entry = decode->entries + index;
+
+        if (entry->length > DECODE_TABLE_BITS || (entry->link != 0 && entry->value >= decode->node_count))
+        {
+            return CORRUPT_DATA;
+        }
+    }
+
+    for (unsigned int index = 0; index < decode->node_count; ++index)
+    {
+        for (unsigned int bit = 0; bit < 2; ++bit)
+        {
+            if ((decode->nodes[index][bit] & DECODE_LEAF) == 0 && decode->nodes[index][bit] >= decode->node_count)
+            {
+                return CORRUPT_DATA;
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+int map_huffman_tables(const char * file_name, struct huffman_tables * tables)
+{
+    if (file_name == NULL || tables == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    memset(tables, 0, sizeof(struct huffman_tables));
+
+#ifndef _WIN32
+    int descriptor = open(file_name, O_RDONLY);
+    struct stat status;
+
+    if (descriptor < 0)
+    {
+        return FILE_ERROR;
+    }
+
+    if (fstat(descriptor, &status) != 0 || status.st_size <= 0
+            || (tables->file = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, descriptor, 0)) == MAP_FAILED)
+    {
+        tables->file = NULL;
+        close(descriptor);
+        return FILE_ERROR;
+    }
+
+    /// THE MAPPING STAYS VALID AFTER THE DESCRIPTOR IS CLOSED
+    close(descriptor);
+    tables->file_length = (size_t)status.st_size;
+    tables->mapped = true;
+#else
+    unsigned int length;
+    int result = read_data(file_name, &tables->file, &length);
+
+    if (result != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    tables->file_length = length;
+#endif
+
+    if (validate_tables(tables) != STATUS_SUCCESS)
+    {
+        unmap_huffman_tables(tables);
+        return CORRUPT_DATA;
+    }
+
+    const struct tables_header * header = (const struct tables_header *)tables->file;
+    const unsigned char * file = (const unsigned char *)tables->file;
+
+    tables->codebook = (const struct huffman_codebook *)(file + header->codebook_offset);
+    tables->decode = (const struct decode_table *)(file + header->decode_offset);
+    tables->tree = file + header->tree_offset;
+    tables->tree_length = header->tree_length;
+    return STATUS_SUCCESS;
+}
+
+int unmap_huffman_tables(struct huffman_tables * tables)
+{
+    if (tables == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+#ifndef _WIN32
+    if (tables->mapped)
+    {
+        munmap(tables->file, tables->file_length);
+    }
+    else
+#endif
+    {
+        memory_free(tables->file);
+    }
+
+    memset(tables, 0, sizeof(struct huffman_tables));
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#ifndef _TABLES_H_
+#define _TABLES_H_
+#include <stdbool.h>
+#include <stddef.h>
+#include "avl_tree.h"
+#include "kernels.h"
+
+/// "HFT" FOLLOWED BY THE VERSION OF THE FORMAT
+#define TABLES_MAGIC   "HFT"
+#define TABLES_VERSION 1
+
+/// THE FILE IS WRITTEN IN THE BYTE ORDER OF THE MACHINE, ANOTHER ORDER IS REJECTED
+#define TABLES_BYTE_ORDER 0x01020304U
+
+/// EVERY SECTION STARTS ON A CACHE LINE
+#define TABLES_ALIGNMENT 64
+
+struct tables_header
+{
+    char magic[3];
+    unsigned char version;
+    unsigned int byte_order;
+
+    /// SIZES OF THE STRUCTURES THAT WROTE THE FILE, A BUILD WITH OTHER ONES REJECTS IT
+    unsigned int codebook_size;
+    unsigned int decode_size;
+
+    /// OFFSETS FROM THE START OF THE FILE
+    unsigned int codebook_offset;
+    unsigned int decode_offset;
+    unsigned int tree_offset;
+    unsigned int tree_length;
+};
+
+struct huffman_tables
+{
+    /// READY TO USE, NOTHING IS REBUILT
+    const struct huffman_codebook * codebook;
+    const struct decode_table * decode;
+
+    /// SERIALIZED TREE, THE BYTES huffman_compress WRITES TO A CONTAINER
+    const unsigned char * tree;
+    unsigned int tree_length;
+
+    /// THE WHOLE FILE, MAPPED READ-ONLY (OR READ WHERE THERE IS NO mmap / BUILT IN MEMORY)
+    void * file;
+    size_t file_length;
+    bool mapped;
+};
+
+/**
+*   Builds the codebook, the decode table and the serialized tree of a Huffman
+*   tree in memory, laid out like a tables file. unmap_huffman_tables frees them.
+*
+*   @PARAMS
+*   huffman_root - Huffman tree of 1 byte keys
+*   tables       - Receives the tables
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   NULL_RESULT      - The tables could not be built (a code longer than 56 bits
+*                      or too many nodes below the decode table)
+*   BAD_MEMORY_ALLOC - Could not allocate the tables
+*   STATUS_SUCCESS   - Tables are ready
+*/
+int create_huffman_tables(const struct node * const huffman_root, struct huffman_tables * tables);
+
+/**
+*   Writes the codebook, the decode table and the serialized tree of a Huffman
+*   tree to a file. The file is written under a temporary name and renamed, so
+*   processes that have the old one mapped keep reading a complete file.
+*
+*   @PARAMS
+*   huffman_root - Huffman tree of 1 byte keys
+*   file_name    - Path of the tables file
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   NULL_RESULT      - The tables could not be built (a code longer than 56 bits
+*                      or too many nodes below the decode table)
+*   BAD_MEMORY_ALLOC - Could not allocate the file
+*   FILE_ERROR       - Could not write the file
+*   STATUS_SUCCESS   - Tables were saved
+*/
+int save_huffman_tables(const struct node * const huffman_root, const char * file_name);
+
+/**
+*   Maps a file written by save_huffman_tables read-only. The tables are used
+*   where they lie, so every process that maps the file shares its pages.
+*
+*   @PARAMS
+*   file_name - Path of the tables file
+*   tables    - Receives the tables
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   FILE_ERROR     - Could not open or map the file
+*   CORRUPT_DATA   - Not a tables file of this version and build
+*   STATUS_SUCCESS - Tables are ready
+*/
+int map_huffman_tables(const char * file_name, struct huffman_tables * tables);
+
+int unmap_huffman_tables(struct huffman_tables * tables);
+
+#endif // _TABLES_H_
@@ -0,0 +1,772 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "transform.h"
+#include "stats.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+/// AN LMS POSITION IS AN S-TYPE SUFFIX WHOSE LEFT NEIGHBOUR IS L-TYPE
+#define IS_LMS(types, i) ((i) > 0 && (types)[i] && !(types)[(i) - 1])
+
+static void bucket_bounds(const int * s, const int n, const int k, int * bucket, const bool end)
+{
+    int sum = 0;
+
+    memset(bucket, 0, (k + 1) * sizeof(int));
+
+    for (int i = 0; i < n; ++i)
+    {
+        ++bucket[s[i]];
+    }
+
+    for (int i = 0; i <= k; ++i)
+    {
+        sum += bucket[i];
+        bucket[i] = end ? sum : sum - bucket[i];
+    }
+}
+
+static void induce_l(const unsigned char * types, int * sa, const int * s, int * bucket, const int n, const int k)
+{
+    bucket_bounds(s, n, k, bucket, false);
+
+    for (int i = 0; i < n; ++i)
+    {
+        if (sa[i] > 0 && !types[sa[i] - 1])
+        {
+            sa[bucket[s[sa[i] - 1]]++] = sa[i] - 1;
+        }
+    }
+}
+
+static void induce_s(const unsigned char * types, int * sa, const int * s, int * bucket, const int n, const int k)
+{
+    bucket_bounds(s, n, k, bucket, true);
+
+    for (int i = n - 1; i >= 0; --i)
+    {
+        if (sa[i] > 0 && types[sa[i] - 1])
+        {
+            sa[--bucket[s[sa[i] - 1]]] = sa[i] - 1;
+        }
+    }
+}
+
+/// SA-IS (NONG, ZHANG AND CHAN): s HOLDS n SYMBOLS FROM 0 TO k AND ENDS WITH A 0 THAT APPEARS NOWHERE ELSE
+static int suffix_array(const int * s, int * sa, const int n, const int k)
+{
+    unsigned char * types = (unsigned char *)memory_alloc(n);
+    int * bucket = (int *)memory_alloc((k + 1) * sizeof(int));
+    int result = STATUS_SUCCESS;
+
+    if (types == NULL || bucket == NULL)
+    {
+        memory_free(types);
+        memory_free(bucket);
+        return BAD_MEMORY_ALLOC;
+    }
+
+    /// S-TYPE (1) WHEN THE SUFFIX IS SMALLER THAN THE ONE AFTER IT, THE SENTINEL IS S-TYPE
+    types[n - 1] = 1;
+    types[n - 2] = 0;
+
+    for (int i = n - 3; i >= 0; --i)
+    {
+        types[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && types[i + 1]);
+    }
+
+    /// SORT THE LMS SUBSTRINGS BY INDUCING FROM THEIR BUCKETS
+    bucket_bounds(s, n, k, bucket, true);
+
+    for (int i = 0; i < n; ++i)
+    {
+        sa[i] = -1;
+    }
+
+    for (int i = 1; i < n; ++i)
+    {
+        if (IS_LMS(types, i))
+        {
+            sa[--bucket[s[i]]] = i;
+        }
+    }
+
+    induce_l(types, sa, s, bucket, n, k);
+    induce_s(types, sa, s, bucket, n, k);
+
+    /// NAME THE SORTED LMS SUBSTRINGS, EQUAL SUBSTRINGS GET THE SAME NAME
+    int lms_count = 0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        if (IS_LMS(types, sa[i]))
+        {
+            sa[lms_count++] = sa[i];
+        }
+    }
+
+    for (int i = lms_count; i < n; ++i)
+    {
+        sa[i] = -1;
+    }
+
+    int name = 0;
+    int previous = -1;
+
+    for (int i = 0; i < lms_count; ++i)
+    {
+        const int position = sa[i];
+        bool differ = false;
+
+        for (int d = 0; d < n; ++d)
+        {
+            if (previous == -1 || s[position + d] != s[previous + d] || types[position + d] != types[previous + d])
+            {
+                differ = true;
+                break;
+            }
+            else if (d > 0 && (IS_LMS(types, position + d) || IS_LMS(types, previous + d)))
+            {
+                break;
+            }
+        }
+
+        if (differ)
+        {
+            ++name;
+            previous = position;
+        }
+
+        sa[lms_count + position / 2] = name - 1;
+    }
+
+    for (int i = n - 1, j = n - 1; i >= lms_count; --i)
+    {
+        if (sa[i] >= 0)
+        {
+            sa[j--] = sa[i];
+        }
+    }
+
+    /// SORT THE STRING OF NAMES, RECURSING WHILE TWO LMS SUBSTRINGS SHARE A NAME
+    int * reduced_sa = sa;
+    int * reduced = sa + n - lms_count;
+
+    if (name < lms_count)
+    {
+        result = suffix_array(reduced, reduced_sa, lms_count, name - 1);
+    }
+    else
+    {
+        for (int i = 0; i < lms_count; ++i)
+        {
+            reduced_sa[reduced[i]] = i;
+        }
+    }
+
+    /// THE SORTED LMS SUFFIXES GO TO THE ENDS OF THEIR BUCKETS, THE OTHER SUFFIXES ARE INDUCED FROM THEM
+    if (result == STATUS_SUCCESS)
+    {
+        bucket_bounds(s, n, k, bucket, true);
+
+        for (int i = 1, j = 0; i < n; ++i)
+        {
+            if (IS_LMS(types, i))
+            {
+                reduced[j++] = i;
+            }
+        }
+
+        for (int i = 0; i < lms_count; ++i)
+        {
+            reduced_sa[i] = reduced[reduced_sa[i]];
+        }
+
+        for (int i = lms_count; i < n; ++i)
+        {
+            sa[i] = -1;
+        }
+
+        for (int i = lms_count - 1; i >= 0; --i)
+        {
+            const int position = sa[i];
+
+            sa[i] = -1;
+            sa[--bucket[s[position]]] = position;
+        }
+
+        induce_l(types, sa, s, bucket, n, k);
+        induce_s(types, sa, s, bucket, n, k);
+    }
+
+    memory_free(bucket);
+    memory_free(types);
+    return result;
+}
+
+int bwt_forward(const unsigned char * data, const unsigned int length, unsigned char * output, unsigned int * primary)
+{
+    if (data == NULL || output == NULL || primary == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (length == 0 || length > MAX_TRANSFORM_BLOCK)
+    {
+        return INVALID_FORMAT;
+    }
+
+    /// EVERY BYTE MOVES UP BY ONE, THE SENTINEL 0 ENDS THE STRING
+    const int n = (int)length + 1;
+    int * s = (int *)memory_alloc(n * sizeof(int));
+    int * sa = (int *)memory_alloc(n * sizeof(int));
+    int result = s == NULL || sa == NULL ? BAD_MEMORY_ALLOC : STATUS_SUCCESS;
+
+    if (result == STATUS_SUCCESS)
+    {
+        for (unsigned int i = 0; i < length; ++i)
+        {
+            s[i] = data[i] + 1;
+        }
+        s[length] = 0;
+
+        result = suffix_array(s, sa, n, 256);
+    }
+
+    /// THE ROW OF THE WHOLE DATA ENDS WITH THE SENTINEL, WHICH IS LEFT OUT
+    if (result == STATUS_SUCCESS)
+    {
+        for (int i = 0, j = 0; i < n; ++i)
+        {
+            if (sa[i] == 0)
+            {
+                *primary = (unsigned int)i;
+            }
+            else
+            {
+                output[j++] = data[sa[i] - 1];
+            }
+        }
+    }
+
+    memory_free(sa);
+    memory_free(s);
+    return result;
+}
+
+int bwt_inverse(const unsigned char * data, const unsigned int length, const unsigned int primary, unsigned char * output)
+{
+    if (data == NULL || output == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (primary == 0 || primary > length || length > MAX_TRANSFORM_BLOCK)
+    {
+        return CORRUPT_DATA;
+    }
+
+    unsigned int * next = (unsigned int *)memory_alloc(((size_t)length + 1) * sizeof(unsigned int));
+    unsigned int base[256];
+    unsigned int first = 1;
+
+    if (next == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    /// ROW 0 STARTS WITH THE SENTINEL, THE ROWS OF A BYTE FOLLOW THOSE OF THE SMALLER BYTES
+    memset(base, 0, sizeof(base));
+
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        ++base[data[i]];
+    }
+
+    for (unsigned int c = 0; c < 256; ++c)
+    {
+        const unsigned int count = base[c];
+
+        base[c] = first;
+        first += count;
+    }
+
+    /// LAST-TO-FIRST MAPPING NEXT TO THE LAST BYTE OF THE ROW, SO A STEP TAKES ONE LOAD;
+    /// THE ROW OF THE SENTINEL LEADS BACK TO ROW 0
+    for (unsigned int row = 0; row <= length; ++row)
+    {
+        if (row == primary)
+        {
+            next[row] = 0;
+        }
+        else
+        {
+            const unsigned char value = data[row < primary ? row : row - 1];
+            next[row] = base[value]++ << 8 | value;
+        }
+    }
+
+    /// ROW 0 ENDS WITH THE LAST BYTE, EVERY STEP GOES ONE BYTE BACK
+    unsigned int row = 0;
+    int result = STATUS_SUCCESS;
+
+    for (unsigned int i = length; i > 0; --i)
+    {
+        if (row == primary)
+        {
+            result = CORRUPT_DATA;
+            break;
+        }
+
+        output[i - 1] = (unsigned char)next[row];
+        row = next[row] >> 8;
+    }
+
+    memory_free(next);
+    return result;
+}
+
+static unsigned char * write_zero_run(unsigned char * output, unsigned int run)
+{
+    /// BIJECTIVE BASE 2, THE LOWEST DIGIT FIRST: 0 IS WORTH 1 AND 1 IS WORTH 2 TIMES ITS PLACE
+    while (run > 0)
+    {
+        --run;
+        *output++ = (unsigned char)(run & 1);
+        run >>= 1;
+    }
+    return output;
+}
+
+int mtf_encode(const unsigned char * data, const unsigned int length, unsigned char * output, unsigned int * output_length)
+{
+    if (data == NULL || output == NULL || output_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned char order[256];
+    unsigned char * end = output;
+    unsigned int run = 0;
+
+    for (unsigned int i = 0; i < 256; ++i)
+    {
+        order[i] = (unsigned char)i;
+    }
+
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        const unsigned char value = data[i];
+
+        if (order[0] == value)
+        {
+            ++run;
+            continue;
+        }
+
+        end = write_zero_run(end, run);
+        run = 0;
+
+        /// MOVE THE VALUE TO THE FRONT, SHIFTING THE ONES BEFORE IT
+        unsigned int rank = 1;
+        unsigned char previous = order[0];
+
+        order[0] = value;
+
+        while (order[rank] != value)
+        {
+            const unsigned char current = order[rank];
+
+            order[rank++] = previous;
+            previous = current;
+        }
+        order[rank] = previous;
+
+        if (rank < 254)
+        {
+            *end++ = (unsigned char)(rank + 1);
+        }
+        else
+        {
+            *end++ = 255;
+            *end++ = (unsigned char)(rank - 254);
+        }
+    }
+
+    end = write_zero_run(end, run);
+    *output_length = (unsigned int)(end - output);
+    return STATUS_SUCCESS;
+}
+
+int mtf_decode(const unsigned char * data, const unsigned int length, unsigned char * output, const unsigned int count)
+{
+    if (data == NULL || output == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned char order[256];
+    unsigned long long run = 0;
+    unsigned int place = 0;
+    unsigned int written = 0;
+
+    for (unsigned int i = 0; i < 256; ++i)
+    {
+        order[i] = (unsigned char)i;
+    }
+
+    for (unsigned int i = 0; i <= length; ++i)
+    {
+        /// A DIGIT OF A RUN OF THE FRONT VALUE
+        if (i < length && data[i] <= 1)
+        {
+            if (place >= 32)
+            {
+                return CORRUPT_DATA;
+            }
+
+            run += (unsigned long long)(data[i] + 1) << place++;
+            continue;
+        }
+
+        if (run > count - written)
+        {
+            return CORRUPT_DATA;
+        }
+
+        memset(output + written, order[0], (size_t)run);
+        written += (unsigned int)run;
+        run = 0;
+        place = 0;
+
+        if (i == length)
+        {
+            break;
+        }
+
+        unsigned int rank = data[i] - 1;
+
+        if (data[i] == 255)
+        {
+            if (++i == length || data[i] > 1)
+            {
+                return CORRUPT_DATA;
+            }
+
+            rank = 254 + data[i];
+        }
+
+        const unsigned char value = order[rank];
+
+        if (written == count)
+        {
+            return CORRUPT_DATA;
+        }
+
+        memmove(order + 1, order, rank);
+        order[0] = value;
+        output[written++] = value;
+    }
+
+    return written == count ? STATUS_SUCCESS : CORRUPT_DATA;
+}
+
+struct transform_block
+{
+    /// THE BYTES OF THE BLOCK AND THEIR ROW OF THE SENTINEL
+    unsigned char * data;
+    unsigned int length;
+    unsigned int primary;
+
+    /// THE MOVE-TO-FRONT / ZERO-RUN CODED TRANSFORM
+    unsigned char * coded;
+    unsigned int coded_length;
+
+    int result;
+};
+
+struct block_worker
+{
+    /// THE WORKER TAKES BLOCKS first, first + step, first + 2 * step...
+    struct transform_block * blocks;
+    unsigned int count;
+    unsigned int first;
+    unsigned int step;
+
+    /// STAGE THE ALLOCATIONS OF THE THREAD ARE CHARGED TO
+    int stage;
+};
+
+static void * transform_blocks(void * argument)
+{
+    struct block_worker * worker = (struct block_worker *)argument;
+    const int previous_stage = set_memory_stage(worker->stage);
+    unsigned char * sorted = NULL;
+    unsigned int sorted_size = 0;
+
+    for (unsigned int i = worker->first; i < worker->count; i += worker->step)
+    {
+        struct transform_block * block = worker->blocks + i;
+
+        /// THE TRANSFORM OF EVERY BLOCK OF THE WORKER GOES THROUGH THE SAME BUFFER
+        if (sorted_size < block->length)
+        {
+            memory_free(sorted);
+            sorted_size = (sorted = (unsigned char *)memory_alloc(block->length)) == NULL ? 0 : block->length;
+        }
+
+        if (sorted == NULL || (block->coded = (unsigned char *)memory_alloc((size_t)TRANSFORM_CODED_BOUND(block->length))) == NULL)
+        {
+            block->result = BAD_MEMORY_ALLOC;
+        }
+        else if ((block->result = bwt_forward(block->data, block->length, sorted, &block->primary)) == STATUS_SUCCESS)
+        {
+            block->result = mtf_encode(sorted, block->length, block->coded, &block->coded_length);
+        }
+    }
+
+    memory_free(sorted);
+    set_memory_stage(previous_stage);
+    return NULL;
+}
+
+static void * restore_blocks(void * argument)
+{
+    struct block_worker * worker = (struct block_worker *)argument;
+    const int previous_stage = set_memory_stage(worker->stage);
+    unsigned char * sorted = NULL;
+    unsigned int sorted_size = 0;
+
+    for (unsigned int i = worker->first; i < worker->count; i += worker->step)
+    {
+        struct transform_block * block = worker->blocks + i;
+
+        if (sorted_size < block->length)
+        {
+            memory_free(sorted);
+            sorted_size = (sorted = (unsigned char *)memory_alloc(block->length)) == NULL ? 0 : block->length;
+        }
+
+        if (sorted == NULL)
+        {
+            block->result = BAD_MEMORY_ALLOC;
+        }
+        else if ((block->result = mtf_decode(block->coded, block->coded_length, sorted, block->length)) == STATUS_SUCCESS)
+        {
+            block->result = bwt_inverse(sorted, block->length, block->primary, block->data);
+        }
+    }
+
+    memory_free(sorted);
+    set_memory_stage(previous_stage);
+    return NULL;
+}
+
+static int run_blocks(struct transform_block * blocks, const unsigned int count, const unsigned int thread_count, const int stage, void * (*work)(void *))
+{
+    const unsigned int workers_count = thread_count == 0 ? 1 : thread_count < count ? thread_count : count;
+    struct block_worker * workers = (struct block_worker *)memory_calloc(workers_count, sizeof(struct block_worker));
+    pthread_t * threads = (pthread_t *)memory_alloc(workers_count * sizeof(pthread_t));
+    unsigned int started = 1;
+    int result = STATUS_SUCCESS;
+
+    if (workers == NULL || threads == NULL)
+    {
+        memory_free(workers);
+        memory_free(threads);
+        return BAD_MEMORY_ALLOC;
+    }
+
+    for (unsigned int i = 0; i < workers_count; ++i)
+    {
+        workers[i].blocks = blocks;
+        workers[i].count = count;
+        workers[i].first = i;
+        workers[i].step = workers_count;
+        workers[i].stage = stage;
+    }
+
+    while (started < workers_count && pthread_create(threads + started, NULL, work, workers + started) == 0)
+    {
+        ++started;
+    }
+
+    /// THE CALLING THREAD IS THE FIRST WORKER AND TAKES OVER THE WORKERS THAT COULD NOT BE STARTED
+    work(workers);
+
+    for (unsigned int i = started; i < workers_count; ++i)
+    {
+        work(workers + i);
+    }
+
+    for (unsigned int i = 1; i < started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (unsigned int i = 0; i < count && result == STATUS_SUCCESS; ++i)
+    {
+        result = blocks[i].result;
+    }
+
+    memory_free(threads);
+    memory_free(workers);
+    return result;
+}
+
+int block_transform(const void * data, const unsigned int length, const unsigned int block_size, const unsigned int thread_count, void ** image, unsigned int * image_length)
+{
+    if (data == NULL || image == NULL || image_length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (length == 0)
+    {
+        return INVALID_FORMAT;
+    }
+
+    const unsigned int size = block_size == 0 ? DEFAULT_TRANSFORM_BLOCK : block_size < MAX_TRANSFORM_BLOCK ? block_size : MAX_TRANSFORM_BLOCK;
+    const unsigned int count = (length - 1) / size + 1;
+    struct transform_block * blocks = (struct transform_block *)memory_calloc(count, sizeof(struct transform_block));
+
+    if (blocks == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const unsigned int offset = i * size;
+
+        blocks[i].data = (unsigned char *)data + offset;
+        blocks[i].length = length - offset < size ? length - offset : size;
+    }
+
+    int result = run_blocks(blocks, count, thread_count, STATS_ENCODE, transform_blocks);
+
+    if (result == STATUS_SUCCESS)
+    {
+        unsigned long long total = TRANSFORM_TABLE_SIZE(count);
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            total += blocks[i].coded_length;
+        }
+
+        if (total > 0xFFFFFFFFULL || (*image = (void *)memory_alloc((size_t)total)) == NULL)
+        {
+            result = BAD_MEMORY_ALLOC;
+        }
+        else
+        {
+            unsigned char * table = (unsigned char *)*image;
+            unsigned char * coded = table + TRANSFORM_TABLE_SIZE(count);
+
+            store_u32(table, count);
+
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                store_u32(table + 4 + 12 * i, blocks[i].length);
+                store_u32(table + 8 + 12 * i, blocks[i].primary);
+                store_u32(table + 12 + 12 * i, blocks[i].coded_length);
+                memcpy(coded, blocks[i].coded, blocks[i].coded_length);
+                coded += blocks[i].coded_length;
+            }
+
+            *image_length = (unsigned int)total;
+        }
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        memory_free(blocks[i].coded);
+    }
+
+    memory_free(blocks);
+    return result;
+}
+
+int block_table_length(const void * table, const unsigned int table_length, const unsigned int coded_length, unsigned int * length)
+{
+    if (table == NULL || length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    const unsigned char * input = (const unsigned char *)table;
+
+    if (table_length < 4 || load_u32(input) == 0 || TRANSFORM_TABLE_SIZE(load_u32(input)) != table_length)
+    {
+        return CORRUPT_DATA;
+    }
+
+    unsigned long long total = 0;
+    unsigned long long coded = 0;
+
+    for (unsigned int i = 0; i < load_u32(input); ++i)
+    {
+        const unsigned int block_length = load_u32(input + 4 + 12 * i);
+        const unsigned int primary = load_u32(input + 8 + 12 * i);
+
+        if (block_length == 0 || block_length > MAX_TRANSFORM_BLOCK || primary == 0 || primary > block_length)
+        {
+            return CORRUPT_DATA;
+        }
+
+        total += block_length;
+        coded += load_u32(input + 12 + 12 * i);
+    }
+
+    if (total > 0xFFFFFFFFULL || coded != coded_length)
+    {
+        return CORRUPT_DATA;
+    }
+
+    *length = (unsigned int)total;
+    return STATUS_SUCCESS;
+}
+
+int block_restore(const void * table, const unsigned int table_length, const void * coded, const unsigned int coded_length, const unsigned int thread_count, void * output)
+{
+    if (table == NULL || coded == NULL || output == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    unsigned int length;
+    int result;
+
+    if ((result = block_table_length(table, table_length, coded_length, &length)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    const unsigned char * input = (const unsigned char *)table;
+    const unsigned int count = load_u32(input);
+    struct transform_block * blocks = (struct transform_block *)memory_calloc(count, sizeof(struct transform_block));
+    unsigned char * data = (unsigned char *)output;
+    unsigned char * bytes = (unsigned char *)coded;
+
+    if (blocks == NULL)
+    {
+        return BAD_MEMORY_ALLOC;
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        blocks[i].data = data;
+        blocks[i].length = load_u32(input + 4 + 12 * i);
+        blocks[i].primary = load_u32(input + 8 + 12 * i);
+        blocks[i].coded = bytes;
+        blocks[i].coded_length = load_u32(input + 12 + 12 * i);
+
+        data += blocks[i].length;
+        bytes += blocks[i].coded_length;
+    }
+
+    result = run_blocks(blocks, count, thread_count, STATS_DECODE, restore_blocks);
+    memory_free(blocks);
+    return result;
+}
@@ -0,0 +1,140 @@
+#ifndef _TRANSFORM_H_
+#define _TRANSFORM_H_
+
+/// BYTES OF A BLOCK OF block_transform WHEN NONE IS GIVEN (THE LARGEST BLOCK OF bzip2)
+#define DEFAULT_TRANSFORM_BLOCK (900 * 1024)
+
+/// THE INVERSE PACKS THE NEXT ROW (24 BITS) AND THE BYTE OF A ROW IN 32 BITS
+#define MAX_TRANSFORM_BLOCK 0xFFFFFFU
+
+/// THE BLOCK TABLE IS THE NUMBER OF BLOCKS (4), THEN FOR EVERY BLOCK ITS LENGTH (4), THE ROW OF
+/// ITS PRIMARY INDEX (4) AND THE LENGTH OF ITS CODED BYTES (4); THE CODED BYTES FOLLOW IN ORDER
+#define TRANSFORM_TABLE_SIZE(count) (4 + 12 * (unsigned long long)(count))
+
+/// THE CODED BYTES OF A BLOCK NEVER TAKE MORE THAN TWICE ITS LENGTH
+#define TRANSFORM_CODED_BOUND(length) (2 * (unsigned long long)(length))
+
+/**
+*   Burrows-Wheeler transform of data: the last column of the sorted
+*   rotations of data followed by a sentinel smaller than any byte, the
+*   sentinel left out. The suffix array is built in linear time (SA-IS).
+*
+*   @PARAMS
+*   data    - Memory address of data
+*   length  - In bytes, at most MAX_TRANSFORM_BLOCK
+*   output  - Receives length bytes
+*   primary - Receives the row of the sentinel (1 to length), the inverse needs it
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   INVALID_FORMAT   - length is 0 or above MAX_TRANSFORM_BLOCK
+*   BAD_MEMORY_ALLOC - Could not allocate the suffix array
+*   STATUS_SUCCESS   - output holds the transform
+*/
+int bwt_forward(const unsigned char * data, const unsigned int length, unsigned char * output, unsigned int * primary);
+
+/**
+*   @PARAMS
+*   data    - Transform written by bwt_forward
+*   length  - In bytes
+*   primary - Row of the sentinel given by bwt_forward
+*   output  - Receives the length bytes of the original data
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   CORRUPT_DATA     - primary is not a row of the transform
+*   BAD_MEMORY_ALLOC - Could not allocate the mapping of the rows
+*   STATUS_SUCCESS   - output holds the original data
+*/
+int bwt_inverse(const unsigned char * data, const unsigned int length, const unsigned int primary, unsigned char * output);
+
+/**
+*   Move-to-front of the bytes, then zero-run coding of the ranks the way
+*   bzip2 does: a run of r zeros is the bijective base 2 digits of r (bytes
+*   0 and 1), a rank v from 1 to 253 is the byte v + 1 and ranks 254 / 255
+*   are the byte 255 followed by v - 254.
+*
+*   @PARAMS
+*   data           - Memory address of data (e.g. the output of bwt_forward)
+*   length         - In bytes
+*   output         - Receives the coded bytes, room for TRANSFORM_CODED_BOUND(length)
+*   output_length  - Receives the number of coded bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   STATUS_SUCCESS - output holds the coded bytes
+*/
+int mtf_encode(const unsigned char * data, const unsigned int length, unsigned char * output, unsigned int * output_length);
+
+/**
+*   @PARAMS
+*   data   - Bytes written by mtf_encode
+*   length - In bytes
+*   output - Receives the decoded bytes
+*   count  - Number of bytes the data decodes to
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   CORRUPT_DATA   - The data does not decode to exactly count bytes
+*   STATUS_SUCCESS - output holds the decoded bytes
+*/
+int mtf_decode(const unsigned char * data, const unsigned int length, unsigned char * output, const unsigned int count);
+
+/**
+*   Cuts data in blocks of block_size bytes and runs bwt_forward and
+*   mtf_encode on each of them, thread_count blocks at a time. The image is
+*   the block table followed by the coded bytes of every block, see
+*   TRANSFORM_TABLE_SIZE.
+*
+*   @PARAMS
+*   data         - Memory address of data
+*   length       - In bytes, not 0
+*   block_size   - Bytes per block, 0 for DEFAULT_TRANSFORM_BLOCK, at most MAX_TRANSFORM_BLOCK
+*   thread_count - Threads transforming blocks, 0 counts as 1
+*   image        - Receives the block table and the coded bytes (allocated)
+*   image_length - Receives the size of the image in bytes
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   INVALID_FORMAT   - length is 0
+*   BAD_MEMORY_ALLOC - Could not allocate the image or the buffers of a block
+*   STATUS_SUCCESS   - image holds the transformed blocks
+*/
+int block_transform(const void * data, const unsigned int length, const unsigned int block_size, const unsigned int thread_count, void ** image, unsigned int * image_length);
+
+/**
+*   Checks a block table and gives the number of bytes the blocks add up to.
+*
+*   @PARAMS
+*   table        - Block table written by block_transform
+*   table_length - In bytes
+*   coded_length - Number of coded bytes that follow the table
+*   length       - Receives the length of the original data
+*
+*   @RETURN
+*   NULL_ARGUMENT  - One of the arguments is NULL
+*   CORRUPT_DATA   - The table is truncated or does not match coded_length
+*   STATUS_SUCCESS - length holds the size of the data
+*/
+int block_table_length(const void * table, const unsigned int table_length, const unsigned int coded_length, unsigned int * length);
+
+/**
+*   Inverse of block_transform, thread_count blocks at a time.
+*
+*   @PARAMS
+*   table        - Block table written by block_transform
+*   table_length - In bytes
+*   coded        - The coded bytes of the blocks
+*   coded_length - In bytes
+*   thread_count - Threads restoring blocks, 0 counts as 1
+*   output       - Receives the original data, the size given by block_table_length
+*
+*   @RETURN
+*   NULL_ARGUMENT    - One of the arguments is NULL
+*   CORRUPT_DATA     - The table or the coded bytes of a block are not valid
+*   BAD_MEMORY_ALLOC - Could not allocate the buffers of a block
+*   STATUS_SUCCESS   - output holds the original data
+*/
+int block_restore(const void * table, const unsigned int table_length, const void * coded, const unsigned int coded_length, const unsigned int thread_count, void * output);
+
+#endif // _TRANSFORM_H_
@@ -0,0 +1,410 @@
+#include "utilities.h"
+#include "allocator.h"
+#include "uring.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef URING_AVAILABLE
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+/// THE RING IS DRIVEN WITH THE SYSTEM CALLS, THE PROGRAM DOES NOT DEPEND ON liburing
+struct uring
+{
+    int descriptor;
+
+    /// SUBMISSION QUEUE: THE KERNEL MOVES head, THE PROGRAM MOVES tail
+    unsigned int * sq_head;
+    unsigned int * sq_tail;
+    unsigned int * sq_array;
+    unsigned int sq_mask;
+    struct io_uring_sqe * sqes;
+
+    /// ENTRIES WRITTEN BUT NOT GIVEN TO THE KERNEL YET
+    unsigned int queued;
+
+    /// COMPLETION QUEUE: THE KERNEL MOVES tail, THE PROGRAM MOVES head
+    unsigned int * cq_head;
+    unsigned int * cq_tail;
+    unsigned int cq_mask;
+    struct io_uring_cqe * cqes;
+
+    void * sq_map;
+    void * cq_map;
+    size_t sq_map_size;
+    size_t cq_map_size;
+    size_t sqes_size;
+};
+
+struct uring_request
+{
+    /// PART OF THE BUFFER THAT IS STILL TO BE TRANSFERRED
+    unsigned long long offset;
+    unsigned int length;
+    bool busy;
+};
+
+static bool uring_usable = false;
+static pthread_once_t probe = PTHREAD_ONCE_INIT;
+
+static void * map_ring(const int descriptor, const size_t size, const off_t offset)
+{
+    void * map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, offset);
+
+    return map == MAP_FAILED ? NULL : map;
+}
+
+static void clean_uring(struct uring * ring)
+{
+    if (ring->sqes != NULL)
+    {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+
+    if (ring->cq_map != NULL && ring->cq_map != ring->sq_map)
+    {
+        munmap(ring->cq_map, ring->cq_map_size);
+    }
+
+    if (ring->sq_map != NULL)
+    {
+        munmap(ring->sq_map, ring->sq_map_size);
+    }
+
+    close(ring->descriptor);
+    memset(ring, 0, sizeof(struct uring));
+}
+
+static int create_uring(struct uring * ring, const unsigned int entries)
+{
+    struct io_uring_params params;
+
+    memset(ring, 0, sizeof(struct uring));
+    memset(&params, 0, sizeof(struct io_uring_params));
+
+    if ((ring->descriptor = (int)syscall(__NR_io_uring_setup, entries, &params)) < 0)
+    {
+        return NULL_RESULT;
+    }
+
+    ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    /// BOTH QUEUES SHARE ONE MAPPING SINCE LINUX 5.4
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring->sq_map_size = ring->sq_map_size > ring->cq_map_size ? ring->sq_map_size : ring->cq_map_size;
+        ring->cq_map_size = ring->sq_map_size;
+    }
+
+    ring->sq_map = map_ring(ring->descriptor, ring->sq_map_size, IORING_OFF_SQ_RING);
+    ring->cq_map = params.features & IORING_FEAT_SINGLE_MMAP ? ring->sq_map : map_ring(ring->descriptor, ring->cq_map_size, IORING_OFF_CQ_RING);
+    ring->sqes = (struct io_uring_sqe *)map_ring(ring->descriptor, ring->sqes_size, IORING_OFF_SQES);
+
+    /// IORING_OP_READ / IORING_OP_WRITE CAME WITH LINUX 5.6, LIKE IORING_FEAT_RW_CUR_POS
+    if (ring->sq_map == NULL || ring->cq_map == NULL || ring->sqes == NULL || (params.features & IORING_FEAT_RW_CUR_POS) == 0)
+    {
+        clean_uring(ring);
+        return NULL_RESULT;
+    }
+
+    unsigned char * sq = (unsigned char *)ring->sq_map;
+    unsigned char * cq = (unsigned char *)ring->cq_map;
+
+    ring->sq_head = (unsigned int *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+    ring->sq_array = (unsigned int *)(sq + params.sq_off.array);
+    ring->sq_mask = *(unsigned int *)(sq + params.sq_off.ring_mask);
+    ring->cq_head = (unsigned int *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+    ring->cq_mask = *(unsigned int *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return STATUS_SUCCESS;
+}
+
+static void queue_request(struct uring * ring, const int file, unsigned char * buffer, const bool write, const bool fixed,
+                          const unsigned int slot, const struct uring_request * request)
+{
+    const unsigned int tail = *ring->sq_tail;
+    const unsigned int index = tail & ring->sq_mask;
+    struct io_uring_sqe * entry = ring->sqes + index;
+
+    memset(entry, 0, sizeof(struct io_uring_sqe));
+    entry->opcode = fixed ? (write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED) : (write ? IORING_OP_WRITE : IORING_OP_READ);
+    entry->fd = file;
+    entry->off = request->offset;
+    entry->addr = (unsigned long long)(uintptr_t)(buffer + request->offset);
+    entry->len = request->length;
+    entry->buf_index = 0;
+    entry->user_data = slot;
+    ring->sq_array[index] = index;
+
+    /// THE ENTRY IS COMPLETE BEFORE THE KERNEL CAN SEE THE NEW TAIL
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++ring->queued;
+}
+
+static int submit_and_wait(struct uring * ring)
+{
+    for (;;)
+    {
+        long submitted = syscall(__NR_io_uring_enter, ring->descriptor, ring->queued, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+
+        if (submitted >= 0)
+        {
+            ring->queued -= (unsigned int)submitted;
+            return STATUS_SUCCESS;
+        }
+
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        {
+            return FILE_ERROR;
+        }
+    }
+}
+
+/// THE RING CANNOT BE ENTERED ANY MORE: THE ENTRIES THE KERNEL DID NOT TAKE NEVER START, THE OTHERS STILL POST THEIR
+/// COMPLETIONS WITHOUT io_uring_enter AND ARE WAITED FOR, SO NO REQUEST USES THE BUFFER ONCE THIS RETURNS
+static void drain_uring(struct uring * ring, unsigned int in_flight)
+{
+    const unsigned int untaken = *ring->sq_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    const struct timespec pause = { 0, URING_DRAIN_PAUSE };
+    unsigned int head = *ring->cq_head;
+
+    in_flight = in_flight > untaken ? in_flight - untaken : 0;
+
+    while (in_flight != 0)
+    {
+        const unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        const unsigned int posted = tail - head;
+
+        in_flight = posted < in_flight ? in_flight - posted : 0;
+        head = tail;
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+        if (in_flight != 0)
+        {
+            nanosleep(&pause, NULL);
+        }
+    }
+}
+
+static int uring_transfer(const int file, unsigned char * buffer, const unsigned long long length, const bool write)
+{
+    struct uring ring;
+    struct uring_request requests[URING_QUEUE_DEPTH];
+    unsigned long long next = 0;
+    unsigned int in_flight = 0;
+    unsigned int failures = 0;
+    int result;
+
+    if ((result = create_uring(&ring, URING_QUEUE_DEPTH)) != STATUS_SUCCESS)
+    {
+        return result;
+    }
+
+    /// A REGISTERED BUFFER IS PINNED ONCE INSTEAD OF FOR EVERY REQUEST, WITHOUT ONE (MEMLOCK LIMIT) PLAIN REQUESTS ARE USED
+    struct iovec vector = { buffer, (size_t)length };
+    const bool fixed = syscall(__NR_io_uring_register, ring.descriptor, IORING_REGISTER_BUFFERS, &vector, 1) == 0;
+
+    memset(requests, 0, sizeof(requests));
+
+    /// AFTER AN ERROR NOTHING NEW IS QUEUED, BUT THE REQUESTS IN FLIGHT ARE WAITED FOR: THEY STILL USE THE BUFFER
+    while (in_flight != 0 || (result == STATUS_SUCCESS && next < length))
+    {
+        for (unsigned int slot = 0; slot < URING_QUEUE_DEPTH && result == STATUS_SUCCESS && next < length; ++slot)
+        {
+            if (!requests[slot].busy)
+            {
+                requests[slot].offset = next;
+                requests[slot].length = length - next < URING_BLOCK_SIZE ? (unsigned int)(length - next) : URING_BLOCK_SIZE;
+                requests[slot].busy = true;
+                next += requests[slot].length;
+                ++in_flight;
+                queue_request(&ring, file, buffer, write, fixed, slot, requests + slot);
+            }
+        }
+
+        /// THE COMPLETIONS ARE STILL REAPED WHEN THE RING CANNOT BE ENTERED, THE KERNEL POSTS THEM ANYWAY
+        if (submit_and_wait(&ring) != STATUS_SUCCESS)
+        {
+            result = FILE_ERROR;
+
+            /// CLOSING THE RING WOULD NOT STOP THE REQUESTS IN FLIGHT, THEY ARE WAITED FOR WITHOUT IT
+            if (++failures == URING_ENTER_ATTEMPTS)
+            {
+                drain_uring(&ring, in_flight);
+                break;
+            }
+        }
+        else
+        {
+            failures = 0;
+        }
+
+        unsigned int head = *ring.cq_head;
+        const unsigned int tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; ++head)
+        {
+            const struct io_uring_cqe * completion = ring.cqes + (head & ring.cq_mask);
+            struct uring_request * request = requests + completion->user_data;
+
+            if (completion->res > 0 && result == STATUS_SUCCESS)
+            {
+                request->offset += (unsigned int)completion->res;
+                request->length -= (unsigned int)completion->res;
+            }
+            else if (completion->res != -EINTR && completion->res != -EAGAIN)
+            {
+                /// AN ERROR, OR A FILE THAT GOT SHORTER WHILE IT WAS READ
+                result = result == STATUS_SUCCESS ? FILE_ERROR : result;
+            }
+
+            /// A SHORT TRANSFER CONTINUES WHERE IT STOPPED
+            if (result == STATUS_SUCCESS && request->length != 0)
+            {
+                queue_request(&ring, file, buffer, write, fixed, (unsigned int)completion->user_data, request);
+            }
+            else
+            {
+                request->busy = false;
+                --in_flight;
+            }
+        }
+
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    clean_uring(&ring);
+    return result;
+}
+
+static void probe_uring(void)
+{
+    const char * forced = getenv("SHANNON_IO");
+    struct uring ring;
+
+    if (forced != NULL && strcmp(forced, "stdio") == 0)
+    {
+        return;
+    }
+
+    /// SECCOMP PROFILES OF CONTAINERS OFTEN FORBID io_uring, ONLY A RING THAT CAN BE CREATED COUNTS
+    if (create_uring(&ring, URING_QUEUE_DEPTH) == STATUS_SUCCESS)
+    {
+        uring_usable = true;
+        clean_uring(&ring);
+    }
+}
+
+bool uring_enabled(void)
+{
+    pthread_once(&probe, probe_uring);
+    return uring_usable;
+}
+
+int uring_read_file(const char * const filePath, void ** buffer, unsigned int * length)
+{
+    if (filePath == NULL || buffer == NULL || length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (!uring_enabled())
+    {
+        return NULL_RESULT;
+    }
+
+    int file = open(filePath, O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    int result;
+
+    if (file < 0)
+    {
+        return FILE_ERROR;
+    }
+
+    /// PIPES, DEVICES AND SMALL FILES ARE LEFT TO STDIO
+    if (fstat(file, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size < URING_MIN_SIZE || status.st_size >= 0xFFFFFFFFLL)
+    {
+        close(file);
+        return NULL_RESULT;
+    }
+
+    if ((*buffer = memory_alloc((size_t)status.st_size + 1)) == NULL)
+    {
+        close(file);
+        return BAD_MEMORY_ALLOC;
+    }
+
+    if ((result = uring_transfer(file, (unsigned char *)*buffer, (unsigned long long)status.st_size, false)) == STATUS_SUCCESS)
+    {
+        *length = (unsigned int)status.st_size;
+        *((unsigned char *)*buffer + *length) = 0;
+    }
+    else
+    {
+        memory_free(*buffer);
+        *buffer = NULL;
+    }
+
+    close(file);
+    return result;
+}
+
+int uring_write_file(const char * const filePath, const void * buffer, const unsigned int length)
+{
+    if (filePath == NULL || buffer == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    if (!uring_enabled() || length < URING_MIN_SIZE)
+    {
+        return NULL_RESULT;
+    }
+
+    int file = open(filePath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+
+    if (file < 0)
+    {
+        return FILE_ERROR;
+    }
+
+    /// THE KERNEL ONLY READS THE BUFFER, THE REGISTRATION NEEDS A WRITABLE POINTER
+    int result = uring_transfer(file, (unsigned char *)buffer, length, true);
+
+    if (close(file) != 0 && result == STATUS_SUCCESS)
+    {
+        result = FILE_ERROR;
+    }
+
+    return result;
+}
+#else
+bool uring_enabled(void)
+{
+    return false;
+}
+
+int uring_read_file(const char * const filePath, void ** buffer, unsigned int * length)
+{
+    return filePath == NULL || buffer == NULL || length == NULL ? NULL_ARGUMENT : NULL_RESULT;
+}
+
+int uring_write_file(const char * const filePath, const void * buffer, const unsigned int length)
+{
+    return filePath == NULL || buffer == NULL ? NULL_ARGUMENT : NULL_RESULT;
+}
+#endif
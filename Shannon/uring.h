@@ -0,0 +1,68 @@
+#ifndef _URING_H_
+#define _URING_H_
+#include <stdbool.h>
+
+/// THE BACKEND IS BUILT ON LINUX WHEN THE KERNEL HEADER IS THERE, ELSEWHERE THE FUNCTIONS ONLY REPORT NULL_RESULT
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define URING_AVAILABLE
+#endif
+#endif
+
+/// REQUESTS IN FLIGHT AND BYTES PER REQUEST
+#define URING_QUEUE_DEPTH 8
+#define URING_BLOCK_SIZE  (1024 * 1024)
+
+/// FAILED io_uring_enter CALLS IN A ROW AFTER WHICH THE RING COUNTS AS UNUSABLE, THE REQUESTS IN FLIGHT
+/// ARE THEN POLLED FOR EVERY URING_DRAIN_PAUSE NANOSECONDS
+#define URING_ENTER_ATTEMPTS 3
+#define URING_DRAIN_PAUSE    1000000
+
+/// SMALLER FILES GO THROUGH STDIO, SETTING UP A RING COSTS MORE THAN IT SAVES
+#define URING_MIN_SIZE (256 * 1024)
+
+/**
+*   Whether the files are read and written through io_uring. Decided once by
+*   creating a ring; the environment variable SHANNON_IO=stdio turns it off.
+*
+*   @RETURN
+*   false - Kernel without io_uring, io_uring forbidden (seccomp) or turned off
+*   true  - uring_read_file / uring_write_file do the I/O
+*/
+bool uring_enabled(void);
+
+/**
+*   Reads the whole file with up to URING_QUEUE_DEPTH reads of URING_BLOCK_SIZE
+*   bytes in flight, straight into the buffer it returns (registered with the
+*   ring when the kernel allows it). Like fetch_data the data is followed by a
+*   0 byte that is not counted in length.
+*
+*   @PARAMS
+*   filePath - Path to the file containing the data
+*   buffer   - Receives the data (allocated)
+*   length   - Receives the size of the file in bytes
+*
+*   @RETURN
+*   NULL_RESULT      - io_uring is not used for this file (disabled, not a regular
+*                      file or smaller than URING_MIN_SIZE), nothing was read
+*   FILE_ERROR       - Could not open / read the file (when the ring fails, the
+*                      reads in flight are waited for before the buffer is freed)
+*   BAD_MEMORY_ALLOC - Could not allocate the buffer
+*   STATUS_SUCCESS   - File was read
+*/
+int uring_read_file(const char * const filePath, void ** buffer, unsigned int * length);
+
+/**
+*   Writes buffer as the whole file, the same way as uring_read_file reads.
+*   When the ring fails, the writes in flight are waited for before
+*   FILE_ERROR is returned, so the caller can free buffer right away; the
+*   file is not valid then.
+*
+*   @RETURN
+*   NULL_RESULT    - io_uring is not used for this data, nothing was written
+*   FILE_ERROR     - Could not create / write the file
+*   STATUS_SUCCESS - File was written
+*/
+int uring_write_file(const char * const filePath, const void * buffer, const unsigned int length);
+
+#endif // _URING_H_
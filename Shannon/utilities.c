@@ -1,6 +1,9 @@
 #include "utilities.h"
+#include "allocator.h"
+#include "uring.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <time.h>
 
 int fetch_data(const char * const filePath, void ** buffer, unsigned int * length, const char * read_format)
 {
@@ -9,6 +12,14 @@ int fetch_data(const char * const filePath, void ** buffer, unsigned int * lengt
         return NULL_ARGUMENT;
     }
 
+    /// io_uring ONLY EXISTS ON LINUX, WHERE TEXT MODE READS THE BYTES AS THEY ARE
+    int result = uring_read_file(filePath, buffer, length);
+
+    if (result != NULL_RESULT)
+    {
+        return result;
+    }
+
     FILE* file = fopen(filePath, read_format);
 
     if (file == NULL)
@@ -17,18 +28,64 @@ int fetch_data(const char * const filePath, void ** buffer, unsigned int * lengt
     }
 
     fseek(file, 0, SEEK_END);
-    *length = ftell(file) + 1;
+    long size = ftell(file);
     fseek(file, 0, SEEK_SET);
 
-    *buffer = (void *)malloc(sizeof(unsigned char) * (*length));
+    /// THE 0 AFTER THE DATA IS NOT PART OF IT, IT ONLY TERMINATES TEXT
+    if (size < 0 || (*buffer = (void *)memory_alloc(sizeof(unsigned char) * ((unsigned long)size + 1))) == NULL)
+    {
+        fclose(file);
+        return size < 0 ? FILE_ERROR : BAD_MEMORY_ALLOC;
+    }
+
+    /// IN TEXT MODE FEWER BYTES THAN THE SIZE OF THE FILE MAY BE READ
+    *length = (unsigned int)fread(*buffer, sizeof(unsigned char), (size_t)size, file);
+    *((unsigned char *)*buffer + *length) = 0;
+
+    fclose(file);
+    return STATUS_SUCCESS;
+}
+
+int read_data(const char * const filePath, void ** buffer, unsigned int * length)
+{
+    if (filePath == NULL || buffer == NULL || length == NULL)
+    {
+        return NULL_ARGUMENT;
+    }
+
+    /// LARGE REGULAR FILES ARE READ WITH SEVERAL REQUESTS IN FLIGHT, THE REST BELOW
+    int result = uring_read_file(filePath, buffer, length);
+
+    if (result != NULL_RESULT)
+    {
+        return result;
+    }
+
+    FILE * file = fopen(filePath, "rb");
+
+    if (file == NULL)
+    {
+        return FILE_ERROR;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
 
-    if (*buffer == NULL)
+    /// ONE EXTRA BYTE SO THAT EMPTY FILES STILL GET A BUFFER
+    if ((*buffer = (void *)memory_alloc(*length + 1)) == NULL)
     {
+        fclose(file);
         return BAD_MEMORY_ALLOC;
     }
 
-    fread(*buffer, sizeof(unsigned char), *length - 1, file);
-    *((unsigned char *)*buffer + *length - 1) = NULL;
+    if (fread(*buffer, sizeof(unsigned char), *length, file) != *length)
+    {
+        memory_free(*buffer);
+        *buffer = NULL;
+        fclose(file);
+        return FILE_ERROR;
+    }
 
     fclose(file);
     return STATUS_SUCCESS;
@@ -41,6 +98,13 @@ int write_data(const char * const filePath, const void * buffer, const unsigned
         return NULL_ARGUMENT;
     }
 
+    int result = uring_write_file(filePath, buffer, length);
+
+    if (result != NULL_RESULT)
+    {
+        return result;
+    }
+
     FILE * file = fopen(filePath, "wb");
 
     if (file == NULL)
@@ -48,9 +112,13 @@ int write_data(const char * const filePath, const void * buffer, const unsigned
         return FILE_ERROR;
     }
 
-    fwrite(buffer, sizeof(unsigned char), length, file);
-    fclose(file);
-    return STATUS_SUCCESS;
+    if (fwrite(buffer, sizeof(unsigned char), length, file) != length)
+    {
+        fclose(file);
+        return FILE_ERROR;
+    }
+
+    return fclose(file) == 0 ? STATUS_SUCCESS : FILE_ERROR;
 }
 
 int print_bits(const void * const data, const unsigned int size, const unsigned int format, const bool little_endian)
@@ -69,22 +137,18 @@ int print_bits(const void * const data, const unsigned int size, const unsigned
     {
         if (format == FORMAT_BITS)
         {
-            if (little_endian)
-            {
-                for (unsigned char bit = 128; bit > 0; bit >>= 1)
-                {
-                    printf("%d", (*((const char *)data + index) & bit) != 0);
-                }
-            }
-            else
+            /// THE BYTE IS RENDERED FIRST AND WRITTEN AT ONCE
+            char text[10];
+            const unsigned char byte = *((const unsigned char *)data + index);
+
+            for (unsigned int bit = 0; bit < 8; ++bit)
             {
-                for (unsigned char bit = 1; bit != 0; bit <<= 1)
-                {
-                    printf("%d", (*((const char *)data + index) & bit) != 0);
-                }
+                text[bit] = (byte >> (little_endian ? 7 - bit : bit) & 1) + '0';
             }
 
-            printf(" ");
+            text[8] = ' ';
+            text[9] = '\0';
+            fputs(text, stdout);
         }
         else if (format == FORMAT_ASCII)
         {
@@ -115,3 +179,36 @@ int print_bits(const void * const data, const unsigned int size, const unsigned
 
     return 0;
 }
+
+double monotonic_seconds(void)
+{
+    struct timespec now;
+
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+    timespec_get(&now, TIME_UTC);
+#endif
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+void store_u32(void * const buffer, const unsigned int value)
+{
+    unsigned char * bytes = (unsigned char *)buffer;
+
+    bytes[0] = (unsigned char)value;
+    bytes[1] = (unsigned char)(value >> 8);
+    bytes[2] = (unsigned char)(value >> 16);
+    bytes[3] = (unsigned char)(value >> 24);
+}
+
+unsigned int load_u32(const void * const buffer)
+{
+    const unsigned char * bytes = (const unsigned char *)buffer;
+
+    return (unsigned int)bytes[0]
+           | (unsigned int)bytes[1] << 8
+           | (unsigned int)bytes[2] << 16
+           | (unsigned int)bytes[3] << 24;
+}
@@ -4,6 +4,7 @@
 
 enum error_codes
 {
+    CORRUPT_DATA        = -106,
     NULL_RESULT         = -105,
     INVALID_TYPE        = -104,
     FILE_ERROR          = -103,
@@ -21,6 +22,8 @@ enum data_format
 };
 
 /**
+*   The data is followed by a 0 byte that is not counted in length.
+*
 *   @PARAMS
 *   filePath - Path to the file containing the data
 *   data     - Double pointer to create buffer and export it ouside
@@ -33,6 +36,23 @@ enum data_format
 */
 int fetch_data(const char * const filePath, void ** buffer, unsigned int * length, const char * read_format);
 
+/**
+*   Reads the whole file as it is (binary, nothing appended). Large regular
+*   files go through io_uring where it is available (uring.h), like the files
+*   of fetch_data and write_data.
+*
+*   @PARAMS
+*   filePath - Path to the file containing the data
+*   buffer   - Receives the data (allocated)
+*   length   - Receives the size of the file in bytes
+*
+*   @RETURN
+*   FILE_ERROR       - Could not open / read the file
+*   BAD_MEMORY_ALLOC - Could not allocate the buffer
+*   STATUS_SUCCESS   - File was read
+*/
+int read_data(const char * const filePath, void ** buffer, unsigned int * length);
+
 int write_data(const char * const filePath, const void * buffer, const unsigned int length);
 
 /**
@@ -48,4 +68,28 @@ int write_data(const char * const filePath, const void * buffer, const unsigned
 */
 int print_bits(const void * const data, const unsigned int sz, const unsigned int format, const bool little_endian);
 
+/**
+*   @RETURN
+*   Seconds elapsed since an arbitrary moment, from a monotonic clock
+*/
+double monotonic_seconds(void);
+
+/**
+*   Little-endian integers of the binary formats, independent of the host.
+*
+*   @PARAMS
+*   buffer - Memory address of at least 4 bytes
+*   value  - Value to be stored
+*/
+void store_u32(void * const buffer, const unsigned int value);
+
+/**
+*   @PARAMS
+*   buffer - Memory address of at least 4 bytes
+*
+*   @RETURN
+*   The value stored by store_u32
+*/
+unsigned int load_u32(const void * const buffer);
+
 #endif // _UTILITIES_H_